@@ -60,8 +60,9 @@
   /* USER CODE BEGIN 1 */
 /* Define size for the receive and transmit buffer over CDC */
 /* It's up to user to redefine and/or remove those define */
-#define APP_RX_DATA_SIZE  512
-#define APP_TX_DATA_SIZE  512
+/* L1 has only the Full Speed device, one packet is never longer than 64 bytes */
+#define APP_RX_DATA_SIZE  CDC_DATA_FS_OUT_PACKET_SIZE
+#define APP_TX_DATA_SIZE  CDC_DATA_FS_IN_PACKET_SIZE
   /* USER CODE END 1 */  
 /**
   * @}
@@ -83,10 +84,11 @@
 /* Create buffer for reception and transmission           */
 /* It's up to user to redefine and/or remove those define */
 /* Received Data over USB are stored in this buffer       */
-uint8_t UserRxBufferFS[APP_RX_DATA_SIZE];
+/* Buffers are always written before use - they are not zeroed at startup */
+uint8_t UserRxBufferFS[APP_RX_DATA_SIZE] __attribute__ ((section(".noinit")));
 
 /* Send Data over USB CDC are stored in this buffer       */
-uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
+uint8_t UserTxBufferFS[APP_TX_DATA_SIZE] __attribute__ ((section(".noinit")));
 
   /* USER CODE END 3 */
 
@@ -37,6 +37,9 @@
 #include "stm32l1xx_hal.h"
 #include "usbd_def.h"
 #include "usbd_core.h"
+#include "usbd_cdc.h"
+#include "power.h"
+#include "rcc.h"
 
 #pragma GCC diagnostic ignored "-fpermissive"
 /* Private typedef -----------------------------------------------------------*/
@@ -47,6 +50,8 @@ PCD_HandleTypeDef hpcd_USB_FS;
 
 /* USER CODE BEGIN 0 */
 __IO uint32_t remotewakeupon=0;
+/* No-stop and clock floor locks are held while the bus is active - USB needs PLL clock */
+static bool usbStopLocked=false;
 /* USER CODE END 0 */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -164,6 +169,13 @@ void HAL_PCD_ResetCallback(PCD_HandleTypeDef *hpcd)
   
   /*Reset Device*/
   USBD_LL_Reset(hpcd->pData);
+
+  if (usbStopLocked == false)
+  {
+    powerLockStop();
+    rccLockClockFloor(RCC_CLOCK_PLL32);
+    usbStopLocked = true;
+  }
 }
 
 /**
@@ -174,6 +186,14 @@ void HAL_PCD_ResetCallback(PCD_HandleTypeDef *hpcd)
 void HAL_PCD_SuspendCallback(PCD_HandleTypeDef *hpcd)
 {
   USBD_LL_Suspend(hpcd->pData);
+
+  /* Bus is idle (suspended by host or cable removed) - allow STOP mode and clocks without PLL */
+  if (usbStopLocked == true)
+  {
+    powerUnlockStop();
+    rccUnlockClockFloor(RCC_CLOCK_PLL32);
+    usbStopLocked = false;
+  }
   /*Enter in STOP mode */
   /* USER CODE BEGIN 2 */
   if (hpcd->Init.low_power_enable)
@@ -201,6 +221,13 @@ void HAL_PCD_ResumeCallback(PCD_HandleTypeDef *hpcd)
   remotewakeupon=0;
   /* USER CODE END 3 */
   USBD_LL_Resume(hpcd->pData);
+
+  if (usbStopLocked == false)
+  {
+    powerLockStop();
+    rccLockClockFloor(RCC_CLOCK_PLL32);
+    usbStopLocked = true;
+  }
   
 }
 
@@ -70,7 +70,7 @@
 /*---------- -----------*/
 #define USBD_CDC_INTERVAL     1000
 /*---------- -----------*/
-#define MAX_STATIC_ALLOC_SIZE     1000
+#define MAX_STATIC_ALLOC_SIZE     ((sizeof(USBD_CDC_HandleTypeDef) + 3) / 4)	/* only the CDC class allocates */
 /****************************************/
 /* #define for FS and HS identification */
 #define DEVICE_FS 		0
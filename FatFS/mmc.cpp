@@ -18,6 +18,7 @@
 
 #include "config.h"
 #include "bsp.h"
+#include "wallclock.h"
 
 #include "gpio.h"
 #include "spi.h"
@@ -110,6 +111,11 @@ static portBASE_TYPE prvIsDiskInserted( void );
 /* Bitwise status for STA_NODISK and STA_NOINIT status of the card. */
 static volatile DSTATUS xDiskStatus = STA_NOINIT;
 
+/* The SPI bus is locked while the card is selected, so transfers of other
+slaves are not interleaved with a command and its data.  Select and deselect
+are not always paired, so the lock is taken only once. */
+static bool xBusLocked = false;
+
 /* Stores the card type discovered during the initialisation process. */
 static BYTE ucInsertedCardType = 0U;
 
@@ -130,8 +136,8 @@ const portTickType xTimeOut = 1000UL / portTICK_RATE_MS;
 
 	if (initialized == false)
 	{
-		gpioConfigurePin(SD_CS_GPIO, SD_CS_PIN, GPIO_OUT_PP_2MHz);
-		SD_CS_bb = SD_CS_DEASSERTED;
+		SD_CS_Pin::configure(GPIO_OUT_PP_2MHz);
+		SD_CS_Pin::write(SD_CS_DEASSERTED);
 
 		spiInitialize();
 
@@ -716,8 +722,14 @@ static void prvDeselectCard( void )
 {
 	uint8_t cDummy;
 
-	SD_CS_bb = SD_CS_DEASSERTED;
+	SD_CS_Pin::write(SD_CS_DEASSERTED);
 	spiRead(&cDummy, sizeof(cDummy));
+
+	if( xBusLocked == true )
+	{
+		xBusLocked = false;
+		spiUnlock();
+	}
 }
 /*-----------------------------------------------------------*/
 
@@ -725,7 +737,13 @@ static bool prvSelectCard( void )
 {
 bool xReturn = true;
 
-	SD_CS_bb = SD_CS_ASSERTED;
+	if( xBusLocked == false )
+	{
+		spiLock();
+		xBusLocked = true;
+	}
+
+	SD_CS_Pin::write(SD_CS_ASSERTED);
 	if( prvWaitForCardReady() != 0xFF )
 	{
 		prvDeselectCard();
@@ -844,5 +862,5 @@ volatile bool bReturn = false;
 
 DWORD get_fattime(void)
 {
-	return 0;								// no time is implemented
+	return wallclockGetFatTime();			// cached time, no I2C transaction
 }
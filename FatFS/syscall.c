@@ -10,6 +10,9 @@
 
 
 #if _FS_REENTRANT
+
+static xStaticQueue SyncObjectBuffers[_VOLUMES];	/* FreeRTOS, storage of mutexes, reused by next f_mount */
+
 /*------------------------------------------------------------------------*/
 /* Create a Synchronization Object                                        */
 /*------------------------------------------------------------------------*/
@@ -23,8 +26,6 @@ int ff_cre_syncobj (	/* TRUE:Function succeeded, FALSE:Could not create due to a
 	_SYNC_t *sobj		/* Pointer to return the created sync object */
 )
 {
-	(void)vol;								// suppress warning
-
 	int ret;
 
 //	*sobj = CreateMutex(NULL, FALSE, NULL);	/* Win32 */
@@ -36,7 +37,7 @@ int ff_cre_syncobj (	/* TRUE:Function succeeded, FALSE:Could not create due to a
 //	*sobj = OSMutexCreate(0, &err);			/* uC/OS-II */
 //	ret = (err == OS_NO_ERR);
 
-	*sobj = xSemaphoreCreateMutex();		/* FreeRTOS */
+	*sobj = xSemaphoreCreateMutexStatic(&SyncObjectBuffers[vol]);	/* FreeRTOS */
 	ret = (*sobj != NULL);
 
 	return ret;
@@ -456,6 +456,24 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define traceTASK_INCREMENT_TICK( xTickCount )
 #endif
 
+#ifndef traceTASK_NOTIFY_GIVE
+	#define traceTASK_NOTIFY_GIVE( pxTCB )
+#endif
+
+#ifndef traceTASK_NOTIFY_GIVE_FROM_ISR
+	#define traceTASK_NOTIFY_GIVE_FROM_ISR( pxTCB )
+#endif
+
+#ifndef traceTASK_NOTIFY_TAKE_BLOCK
+	/* Called when ulTaskNotifyTake() finds no notification and the calling
+	task is about to block. */
+	#define traceTASK_NOTIFY_TAKE_BLOCK()
+#endif
+
+#ifndef traceTASK_NOTIFY_TAKE
+	#define traceTASK_NOTIFY_TAKE()
+#endif
+
 #ifndef traceTIMER_CREATE
 	#define traceTIMER_CREATE( pxNewTimer )
 #endif
@@ -502,6 +520,38 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define configUSE_MALLOC_FAILED_HOOK 0
 #endif
 
+#ifndef configUSE_TICKLESS_IDLE
+	#define configUSE_TICKLESS_IDLE 0
+#endif
+
+#ifndef configEXPECTED_IDLE_TIME_BEFORE_SLEEP
+	#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP 2
+#endif
+
+#if configEXPECTED_IDLE_TIME_BEFORE_SLEEP < 2
+	#error configEXPECTED_IDLE_TIME_BEFORE_SLEEP must not be less than 2
+#endif
+
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	#ifndef portSUPPRESS_TICKS_AND_SLEEP
+		#error If configUSE_TICKLESS_IDLE is not 0 then portSUPPRESS_TICKS_AND_SLEEP must also be defined.  portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) should stop the tick interrupt, sleep for at most xExpectedIdleTime ticks and report the time slept with vTaskStepTick().
+	#endif /* portSUPPRESS_TICKS_AND_SLEEP */
+
+#endif /* configUSE_TICKLESS_IDLE */
+
+#ifndef configHEAP_CALL_SITE_STATS
+	#define configHEAP_CALL_SITE_STATS 0
+#endif
+
+#ifndef configSUPPORT_STATIC_ALLOCATION
+	#define configSUPPORT_STATIC_ALLOCATION 0
+#endif
+
+#ifndef configUSE_TASK_NOTIFICATIONS
+	#define configUSE_TASK_NOTIFICATIONS 0
+#endif
+
 #ifndef portPRIVILEGE_BIT
 	#define portPRIVILEGE_BIT ( ( unsigned portBASE_TYPE ) 0x00 )
 #endif
@@ -518,5 +568,100 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define vPortFreeAligned( pvBlockToFree ) vPortFree( pvBlockToFree )
 #endif
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	/*
+	 * Storage for kernel objects created with the ...Static() API functions.
+	 * The structures have the same size and alignment as the private
+	 * structures of the kernel, but their members must not be accessed - they
+	 * exist only so the application can allocate the objects at compile time.
+	 * tasks.c, queue.c and timers.c check that the sizes match.
+	 */
+	typedef struct xSTATIC_LIST_ITEM
+	{
+		portTickType xDummy1;
+		void *pvDummy2[ 4 ];
+	} xStaticListItem;
+
+	typedef struct xSTATIC_MINI_LIST_ITEM
+	{
+		portTickType xDummy1;
+		void *pvDummy2[ 2 ];
+	} xStaticMiniListItem;
+
+	typedef struct xSTATIC_LIST
+	{
+		unsigned portBASE_TYPE uxDummy1;
+		void *pvDummy2;
+		xStaticMiniListItem xDummy3;
+	} xStaticList;
+
+	/* Storage of a task control block, see xTaskCreateStatic(). */
+	typedef struct xSTATIC_TCB
+	{
+		void *pxDummy1;
+		#if ( portUSING_MPU_WRAPPERS == 1 )
+			xMPU_SETTINGS xDummy2;
+		#endif
+		xStaticListItem xDummy3[ 2 ];
+		unsigned portBASE_TYPE uxDummy4;
+		void *pxDummy5;
+		signed char ucDummy6[ configMAX_TASK_NAME_LEN ];
+		#if ( portSTACK_GROWTH > 0 )
+			void *pxDummy7;
+		#endif
+		#if ( portCRITICAL_NESTING_IN_TCB == 1 )
+			unsigned portBASE_TYPE uxDummy8;
+		#endif
+		#if ( configUSE_TRACE_FACILITY == 1 )
+			unsigned portBASE_TYPE uxDummy9[ 2 ];
+		#endif
+		#if ( configUSE_MUTEXES == 1 )
+			unsigned portBASE_TYPE uxDummy10;
+		#endif
+		#if ( configUSE_APPLICATION_TASK_TAG == 1 )
+			void *pxDummy11;
+		#endif
+		#if ( configGENERATE_RUN_TIME_STATS == 1 )
+			unsigned long ulDummy12;
+		#endif
+		#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+			unsigned long ulDummy13;
+		#endif
+		#if ( INCLUDE_uxTaskGetStackHighWaterMark == 1 )
+			unsigned short usDummy14;
+		#endif
+		#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+			unsigned char ucDummy15;
+		#endif
+		unsigned char ucDummy16;
+	} xStaticTask;
+
+	/* Storage of a queue, semaphore or mutex, see xQueueCreateStatic(). */
+	typedef struct xSTATIC_QUEUE
+	{
+		void *pvDummy1[ 4 ];
+		xStaticList xDummy2[ 2 ];
+		unsigned portBASE_TYPE uxDummy3[ 3 ];
+		signed portBASE_TYPE xDummy4[ 2 ];
+		#if ( configUSE_TRACE_FACILITY == 1 )
+			unsigned char ucDummy5[ 2 ];
+		#endif
+		unsigned char ucDummy6;
+	} xStaticQueue;
+
+	/* Storage of a software timer, see xTimerCreateStatic(). */
+	typedef struct xSTATIC_TIMER
+	{
+		const void *pvDummy1;
+		xStaticListItem xDummy2;
+		portTickType xDummy3;
+		unsigned portBASE_TYPE uxDummy4;
+		void *pvDummy5[ 2 ];
+		unsigned char ucDummy6;
+	} xStaticTimer;
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+
 #endif /* INC_FREERTOS_H */
 
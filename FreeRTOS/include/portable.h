@@ -370,6 +370,43 @@ void vPortFree( void *pv ) PRIVILEGED_FUNCTION;
 void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Statistics of the heap, filled by vPortGetHeapStats().  Only heap_tlsf.c
+ * provides vPortGetHeapStats(), xPortGetMinimumEverFreeHeapSize() and
+ * xPortGetBlockSize().
+ */
+typedef struct xHEAP_STATS
+{
+	size_t xAvailableHeapSpaceInBytes;		/*<< Total free bytes. */
+	size_t xSizeOfLargestFreeBlockInBytes;	/*<< Largest free block. */
+	size_t xMinimumEverFreeBytesRemaining;	/*<< Lowest number of free bytes since the start. */
+	size_t xNumberOfSuccessfulAllocations;	/*<< Number of calls to pvPortMalloc() which returned a block. */
+	size_t xNumberOfSuccessfulFrees;		/*<< Number of calls to vPortFree() which freed a block. */
+	size_t xNumberOfFailedAllocations;		/*<< Number of calls to pvPortMalloc() which returned NULL. */
+} xHeapStats;
+
+void vPortGetHeapStats( xHeapStats *pxHeapStats ) PRIVILEGED_FUNCTION;
+size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
+size_t xPortGetBlockSize( void *pv ) PRIVILEGED_FUNCTION;
+
+#if ( configHEAP_CALL_SITE_STATS == 1 )
+
+	/*
+	 * Live allocations of one call site of pvPortMalloc(), filled by
+	 * uxPortGetHeapCallSites().
+	 */
+	typedef struct xHEAP_CALL_SITE
+	{
+		void *pvSite;							/*<< Return address of pvPortMalloc(). */
+		unsigned portBASE_TYPE uxLiveBlocks;	/*<< Number of blocks not freed yet. */
+		size_t xLiveBytes;						/*<< Bytes of blocks not freed yet. */
+		size_t xPeakBytes;						/*<< Highest value of xLiveBytes. */
+	} xHeapCallSite;
+
+	unsigned portBASE_TYPE uxPortGetHeapCallSites( xHeapCallSite *pxCallSites, unsigned portBASE_TYPE uxMaxCount ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
@@ -156,6 +156,56 @@ typedef void * xQueueHandle;
  */
 #define xQueueCreate( uxQueueLength, uxItemSize ) xQueueGenericCreate( uxQueueLength, uxItemSize, queueQUEUE_TYPE_BASE )
 
+/**
+ * queue. h
+ * <pre>
+ xQueueHandle xQueueCreateStatic(
+							  unsigned portBASE_TYPE uxQueueLength,
+							  unsigned portBASE_TYPE uxItemSize,
+							  unsigned char *pucQueueStorage,
+							  xStaticQueue *pxStaticQueue
+						  );
+ * </pre>
+ *
+ * Creates a new queue instance in memory provided by the application, so the
+ * queue never fails to be created and its RAM is known at link time.  Only
+ * available if configSUPPORT_STATIC_ALLOCATION is set to 1.  The memory is
+ * not freed when the queue is deleted.
+ *
+ * @param uxQueueLength The maximum number of items that the queue can contain.
+ *
+ * @param uxItemSize The number of bytes each item in the queue will require.
+ *
+ * @param pucQueueStorage Storage of the items, it must be at least
+ * queueSTATIC_STORAGE_SIZE( uxQueueLength, uxItemSize ) bytes long.
+ *
+ * @param pxStaticQueue Storage of the queue structure.
+ *
+ * @return Handle to the created queue.
+ *
+ * Example usage:
+   <pre>
+ static unsigned char ucQueueStorage[ queueSTATIC_STORAGE_SIZE( 10, sizeof( unsigned long ) ) ];
+ static xStaticQueue xQueueBuffer;
+
+ void vATask( void *pvParameters )
+ {
+ xQueueHandle xQueue1;
+
+	// Create a queue capable of containing 10 unsigned long values.
+	xQueue1 = xQueueCreateStatic( 10, sizeof( unsigned long ), ucQueueStorage, &xQueueBuffer );
+
+	// ... Rest of task code.
+ }
+ </pre>
+ * \defgroup xQueueCreateStatic xQueueCreateStatic
+ * \ingroup QueueManagement
+ */
+#define xQueueCreateStatic( uxQueueLength, uxItemSize, pucQueueStorage, pxStaticQueue ) xQueueGenericCreateStatic( ( uxQueueLength ), ( uxItemSize ), ( pucQueueStorage ), ( pxStaticQueue ), queueQUEUE_TYPE_BASE )
+
+/* Size of storage of items of a queue created with xQueueCreateStatic(). */
+#define queueSTATIC_STORAGE_SIZE( uxQueueLength, uxItemSize ) ( ( ( uxQueueLength ) * ( uxItemSize ) ) + 1 )
+
 /**
  * queue. h
  * <pre>
@@ -1241,6 +1291,9 @@ signed portBASE_TYPE xQueueCRReceive( xQueueHandle pxQueue, void *pvBuffer, port
 xQueueHandle xQueueCreateMutex( unsigned char ucQueueType );
 xQueueHandle xQueueCreateCountingSemaphore( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount );
 void* xQueueGetMutexHolder( xQueueHandle xSemaphore );
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xQueueHandle xQueueCreateMutexStatic( unsigned char ucQueueType, xStaticQueue *pxStaticQueue );
+#endif
 
 /*
  * For internal use only.  Use xSemaphoreTakeMutexRecursive() or
@@ -1287,6 +1340,14 @@ portBASE_TYPE xQueueGiveMutexRecursive( xQueueHandle pxMutex );
  */
 xQueueHandle xQueueGenericCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char ucQueueType );
 
+/*
+ * Generic version of the static queue creation function, which is in turn
+ * called by xQueueCreateStatic() and the static semaphore macros.
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xQueueHandle xQueueGenericCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueue *pxStaticQueue, unsigned char ucQueueType );
+#endif
+
 /* Not public API functions. */
 void vQueueWaitForMessageRestricted( xQueueHandle pxQueue, portTickType xTicksToWait );
 portBASE_TYPE xQueueGenericReset( xQueueHandle pxQueue, portBASE_TYPE xNewQueue );
@@ -127,6 +127,27 @@ typedef xQueueHandle xSemaphoreHandle;
 		}																																		\
 	}
 
+/**
+ * semphr. h
+ * <pre>vSemaphoreCreateBinaryStatic( xSemaphoreHandle xSemaphore, xStaticQueue *pxSemaphoreBuffer )</pre>
+ *
+ * Same as vSemaphoreCreateBinary(), but the semaphore is created in memory
+ * provided by the application, so it can't fail.  Only available if
+ * configSUPPORT_STATIC_ALLOCATION is set to 1.
+ *
+ * @param xSemaphore Handle to the created semaphore.  Should be of type xSemaphoreHandle.
+ *
+ * @param pxSemaphoreBuffer Storage of the semaphore.
+ *
+ * \defgroup vSemaphoreCreateBinaryStatic vSemaphoreCreateBinaryStatic
+ * \ingroup Semaphores
+ */
+#define vSemaphoreCreateBinaryStatic( xSemaphore, pxSemaphoreBuffer )																			\
+	{																																			\
+		( xSemaphore ) = xQueueGenericCreateStatic( ( unsigned portBASE_TYPE ) 1, semSEMAPHORE_QUEUE_ITEM_LENGTH, NULL, ( pxSemaphoreBuffer ), queueQUEUE_TYPE_BINARY_SEMAPHORE );	\
+		xSemaphoreGive( ( xSemaphore ) );																										\
+	}
+
 /**
  * semphr. h
  * <pre>xSemaphoreTake( 
@@ -635,6 +656,23 @@ typedef xQueueHandle xSemaphoreHandle;
  */
 #define xSemaphoreCreateMutex() xQueueCreateMutex( queueQUEUE_TYPE_MUTEX )
 
+/**
+ * semphr. h
+ * <pre>xSemaphoreHandle xSemaphoreCreateMutexStatic( xStaticQueue *pxMutexBuffer )</pre>
+ *
+ * Same as xSemaphoreCreateMutex(), but the mutex is created in memory
+ * provided by the application, so it can't fail.  Only available if
+ * configSUPPORT_STATIC_ALLOCATION is set to 1.
+ *
+ * @param pxMutexBuffer Storage of the mutex.
+ *
+ * @return xSemaphore Handle to the created mutex semaphore.
+ *
+ * \defgroup xSemaphoreCreateMutexStatic xSemaphoreCreateMutexStatic
+ * \ingroup Semaphores
+ */
+#define xSemaphoreCreateMutexStatic( pxMutexBuffer ) xQueueCreateMutexStatic( queueQUEUE_TYPE_MUTEX, ( pxMutexBuffer ) )
+
 
 /**
  * semphr. h
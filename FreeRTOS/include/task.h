@@ -98,6 +98,15 @@ extern "C" {
  */
 typedef void * xTaskHandle;
 
+/*
+ * Possible return values for eTaskConfirmSleepModeStatus().
+ */
+typedef enum
+{
+	eAbortSleep = 0,		/* A task has been made ready or a context switch pended since portSUPPRESS_TICKS_AND_SLEEP() was called - abort entering a sleep mode. */
+	eStandardSleep			/* Enter a sleep mode that will not last any longer than the expected idle time. */
+} eSleepModeStatus;
+
 /*
  * Used internally only.
  */
@@ -131,6 +140,19 @@ typedef struct xTASK_PARAMTERS
 	xMemoryRegion xRegions[ portNUM_CONFIGURABLE_REGIONS ];
 } xTaskParameters;
 
+/*
+ * Status of a task, filled by uxTaskGetSystemState().
+ */
+typedef struct xTASK_STATUS
+{
+	xTaskHandle xHandle;						/* The handle of the task. */
+	const signed char *pcTaskName;				/* The name of the task, valid only while the task exists. */
+	unsigned portBASE_TYPE xTaskNumber;			/* A number unique to the task. */
+	unsigned portBASE_TYPE uxCurrentPriority;	/* The priority of the task, including inherited one. */
+	unsigned long ulRunTimeCounter;				/* The total run time of the task, 0 if configGENERATE_RUN_TIME_STATS is not 1. */
+	unsigned short usStackDepth;				/* The size of the stack in words, 0 if INCLUDE_uxTaskGetStackHighWaterMark is not 1. */
+} xTaskStatusType;
+
 /*
  * Defines the priority used by the idle task.  This must not be modified.
  *
@@ -283,6 +305,50 @@ typedef struct xTASK_PARAMTERS
  */
 #define xTaskCreate( pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask ) xTaskGenericCreate( ( pvTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( uxPriority ), ( pxCreatedTask ), ( NULL ), ( NULL ) )
 
+/**
+ * task. h
+ *<pre>
+ portBASE_TYPE xTaskCreateStatic(
+							  pdTASK_CODE pvTaskCode,
+							  const char * const pcName,
+							  unsigned short usStackDepth,
+							  void *pvParameters,
+							  unsigned portBASE_TYPE uxPriority,
+							  xTaskHandle *pvCreatedTask,
+							  portSTACK_TYPE *puxStackBuffer,
+							  xStaticTask *pxTaskBuffer
+						  );</pre>
+ *
+ * Create a new task in memory provided by the application - both the stack and
+ * the TCB are static, so the task can't fail to be created for lack of heap
+ * and its RAM is known at link time.  Only available if
+ * configSUPPORT_STATIC_ALLOCATION is set to 1.  The memory is not freed when
+ * the task is deleted.
+ *
+ * @param puxStackBuffer Stack of the task, it must have usStackDepth
+ * elements.
+ *
+ * @param pxTaskBuffer Storage of the TCB of the task.
+ *
+ * The other parameters and the return value are the same as in xTaskCreate().
+ *
+ * Example usage:
+   <pre>
+ static portSTACK_TYPE xStack[ STACK_SIZE ];
+ static xStaticTask xTaskBuffer;
+
+ void vOtherFunction( void )
+ {
+	xTaskCreateStatic( vTaskCode, "NAME", STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL, xStack, &xTaskBuffer );
+ }
+   </pre>
+ * \defgroup xTaskCreateStatic xTaskCreateStatic
+ * \ingroup Tasks
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	signed portBASE_TYPE xTaskCreateStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, xStaticTask *pxTaskBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * task. h
  *<pre>
@@ -1105,6 +1171,81 @@ void vTaskGetRunTimeStats( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
  */
 unsigned portBASE_TYPE uxTaskGetStackHighWaterMark( xTaskHandle xTask ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <PRE>portBASE_TYPE xTaskNotifyGive( xTaskHandle xTaskToNotify );</PRE>
+ *
+ * configUSE_TASK_NOTIFICATIONS must be set to 1 in FreeRTOSConfig.h for the
+ * notification functions to be available.
+ *
+ * Each task has a notification count in its TCB, which can be used instead of
+ * a binary or counting semaphore when only one task waits for the event - the
+ * task is unblocked directly, without a queue between the two sides, so the
+ * signal costs no RAM besides the TCB and takes a shorter path than
+ * xSemaphoreGive() and xSemaphoreTake().
+ *
+ * xTaskNotifyGive() increments the notification count of xTaskToNotify and
+ * unblocks the task if it is waiting in ulTaskNotifyTake().  It must not be
+ * called from an interrupt, use vTaskNotifyGiveFromISR() there.
+ *
+ * @param xTaskToNotify Handle of the task being notified.
+ *
+ * @return pdPASS, always.
+ *
+ * \defgroup xTaskNotifyGive xTaskNotifyGive
+ * \ingroup TaskNotifications
+ */
+signed portBASE_TYPE xTaskNotifyGive( xTaskHandle xTaskToNotify ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, portBASE_TYPE *pxHigherPriorityTaskWoken );</PRE>
+ *
+ * Version of xTaskNotifyGive() that can be used from an interrupt.
+ *
+ * @param xTaskToNotify Handle of the task being notified.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if the notified task has a
+ * priority above the interrupted task, then a context switch should be
+ * requested before the interrupt exits.  May be NULL.
+ *
+ * Example usage:
+   <pre>
+ void vDMAHandler( void )
+ {
+ portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+
+	vTaskNotifyGiveFromISR( xTaskWaitingForDMA, &xHigherPriorityTaskWoken );
+	portEND_SWITCHING_ISR( xHigherPriorityTaskWoken );
+ }
+   </pre>
+ * \defgroup vTaskNotifyGiveFromISR vTaskNotifyGiveFromISR
+ * \ingroup TaskNotifications
+ */
+void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, signed portBASE_TYPE *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait );</PRE>
+ *
+ * Waits for the notification count of the calling task to be non-zero.  Only
+ * the task itself can wait for its notifications.
+ *
+ * @param xClearCountOnExit pdTRUE to clear the count before returning (use as
+ * a binary semaphore), pdFALSE to decrement it (use as a counting semaphore).
+ *
+ * @param xTicksToWait The maximum amount of time the task should block, 0 to
+ * return at once, portMAX_DELAY to wait indefinitely (if INCLUDE_vTaskSuspend
+ * is set to 1).
+ *
+ * @return The notification count before it was cleared or decremented - 0 if
+ * the time expired without a notification.
+ *
+ * \defgroup ulTaskNotifyTake ulTaskNotifyTake
+ * \ingroup TaskNotifications
+ */
+unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait ) PRIVILEGED_FUNCTION;
+
 /* When using trace macros it is sometimes necessary to include tasks.h before
 FreeRTOS.h.  When this is done pdTASK_HOOK_CODE will not yet have been defined,
 so the following two prototypes will cause a compilation error.  This can be
@@ -1154,6 +1295,46 @@ portBASE_TYPE xTaskCallApplicationTaskHook( xTaskHandle xTask, void *pvParameter
  */
 xTaskHandle xTaskGetIdleTaskHandle( void );
 
+/**
+ * task.h
+ * <PRE>unsigned long ulTaskGetRunTimeCounter( xTaskHandle xTask );</PRE>
+ *
+ * configGENERATE_RUN_TIME_STATS must be defined as 1 for this function to be
+ * available.
+ *
+ * Returns the total time the task xTask has spent in the Running state, in
+ * units of portGET_RUN_TIME_COUNTER_VALUE().  Passing xTask as NULL returns the
+ * counter of the calling task.  Sampling the counter of the idle task (see
+ * xTaskGetIdleTaskHandle()) twice gives the idle time of the period between
+ * the samples.
+ */
+unsigned long ulTaskGetRunTimeCounter( xTaskHandle xTask ) PRIVILEGED_FUNCTION;
+
+/**
+ * task.h
+ * <PRE>unsigned portBASE_TYPE uxTaskGetSystemState( xTaskStatusType *pxTaskStatusArray, unsigned portBASE_TYPE uxArraySize, unsigned long *pulTotalRunTime );</PRE>
+ *
+ * configUSE_TRACE_FACILITY must be defined as 1 for this function to be
+ * available.
+ *
+ * Fills pxTaskStatusArray with the status of each task in the system, with the
+ * scheduler suspended - all run time counters are sampled at the same moment.
+ * Unlike vTaskGetRunTimeStats() nothing is formatted, so it's cheap enough to
+ * be called periodically.  Stacks are not scanned - call
+ * uxTaskGetStackHighWaterMark() for the handles of interest.
+ *
+ * @param pxTaskStatusArray Array of at least uxTaskGetNumberOfTasks()
+ * elements.
+ *
+ * @param uxArraySize The number of elements in pxTaskStatusArray.
+ *
+ * @param pulTotalRunTime If not NULL, set to portGET_RUN_TIME_COUNTER_VALUE()
+ * sampled together with the counters of the tasks.
+ *
+ * @return The number of filled elements, 0 if the array is too small.
+ */
+unsigned portBASE_TYPE uxTaskGetSystemState( xTaskStatusType *pxTaskStatusArray, unsigned portBASE_TYPE uxArraySize, unsigned long *pulTotalRunTime ) PRIVILEGED_FUNCTION;
+
 /*-----------------------------------------------------------
  * SCHEDULER INTERNALS AVAILABLE FOR PORTING PURPOSES
  *----------------------------------------------------------*/
@@ -1170,6 +1351,32 @@ xTaskHandle xTaskGetIdleTaskHandle( void );
  */
 void vTaskIncrementTick( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Only available when configUSE_TICKLESS_IDLE is not 0.  Called from
+ * portSUPPRESS_TICKS_AND_SLEEP() after the tick interrupt was stopped, to
+ * move the tick count forward by the number of whole ticks the processor
+ * slept.  xTicksToJump must be lower than the expected idle time passed to
+ * portSUPPRESS_TICKS_AND_SLEEP().
+ */
+void vTaskStepTick( portTickType xTicksToJump ) PRIVILEGED_FUNCTION;
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Only available when configUSE_TICKLESS_IDLE is not 0.  Must be called with
+ * interrupts disabled, from portSUPPRESS_TICKS_AND_SLEEP(), just before the
+ * sleep mode is entered.  Returns eAbortSleep if an interrupt made a task
+ * ready or requested a context switch after the expected idle time was
+ * calculated.
+ */
+eSleepModeStatus eTaskConfirmSleepModeStatus( void ) PRIVILEGED_FUNCTION;
+
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
  * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
@@ -232,6 +232,27 @@ typedef void (*tmrTIMER_CALLBACK)( xTimerHandle xTimer );
  */
 xTimerHandle xTimerCreate( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void * pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction ) PRIVILEGED_FUNCTION;
 
+/**
+ * xTimerHandle xTimerCreateStatic( 	const signed char *pcTimerName,
+ * 									portTickType xTimerPeriodInTicks,
+ * 									unsigned portBASE_TYPE uxAutoReload,
+ * 									void * pvTimerID,
+ * 									tmrTIMER_CALLBACK pxCallbackFunction,
+ * 									xStaticTimer *pxTimerBuffer );
+ *
+ * Same as xTimerCreate(), but the timer is created in memory provided by the
+ * application, so it can't fail.  Only available if
+ * configSUPPORT_STATIC_ALLOCATION is set to 1.  The memory is not freed when
+ * the timer is deleted.
+ *
+ * @param pxTimerBuffer Storage of the timer.
+ *
+ * The other parameters and the return value are the same as in xTimerCreate().
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xTimerHandle xTimerCreateStatic( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void * pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction, xStaticTimer *pxTimerBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * void *pvTimerGetTimerID( xTimerHandle xTimer );
  *
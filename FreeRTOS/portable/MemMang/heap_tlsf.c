@@ -0,0 +1,609 @@
+/*
+ * Implementation of pvPortMalloc() and vPortFree() with a Two-Level Segregated
+ * Fit (TLSF) allocator.
+ *
+ * The heap is the region between configHEAP_START and configHEAP_END, by
+ * default defined in the linker script with symbols __heap_start and
+ * __heap_end.  Free blocks are kept in segregated lists indexed with two
+ * levels - the first level splits sizes into powers of two, the second level
+ * splits each power of two into configTLSF_SL_INDEX_COUNT ranges.  Two bitmaps
+ * tell which lists are not empty, so both allocation and free take constant
+ * time - one search with count leading/trailing zeros instructions, no list
+ * walks.  Adjacent free blocks are always coalesced.
+ *
+ * Every block has a header with the address of the physically previous block
+ * and the size of the block.  Allocation rounds the request up to the next
+ * list boundary (good fit), so internal fragmentation is limited to
+ * 1 / configTLSF_SL_INDEX_COUNT of the request.
+ *
+ * Statistics (free bytes, minimum ever free bytes, largest free block, numbers
+ * of allocations, frees and failures) are available with vPortGetHeapStats().
+ * With configHEAP_CALL_SITE_STATS set to 1 live allocations are also accounted
+ * per call site (return address of pvPortMalloc()), see
+ * uxPortGetHeapCallSites().
+ *
+ * See heap_1.c, heap_2.c and heap_3.c for alternative implementations, and the
+ * memory management pages of http://www.FreeRTOS.org for more information.
+ */
+
+#include <stdint.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+/*-----------------------------------------------------------*/
+
+#ifndef configHEAP_START
+	extern char __heap_start;	/* Imported from linker script. */
+	extern char __heap_end;		/* Imported from linker script. */
+	#define configHEAP_START	( &__heap_start )
+	#define configHEAP_END		( &__heap_end )
+#endif
+
+/* Log2 of the number of second level lists in each first level range. */
+#ifndef configTLSF_SL_INDEX_COUNT_LOG2
+	#define configTLSF_SL_INDEX_COUNT_LOG2	3
+#endif
+
+/* Log2 of the largest block, the heap must be smaller than
+2 ^ ( configTLSF_FL_INDEX_MAX + 1 ) bytes.  16kB of RAM needs 13. */
+#ifndef configTLSF_FL_INDEX_MAX
+	#define configTLSF_FL_INDEX_MAX			13
+#endif
+
+#ifndef configHEAP_CALL_SITE_STATS
+	#define configHEAP_CALL_SITE_STATS		0
+#endif
+
+#ifndef configHEAP_CALL_SITES
+	#define configHEAP_CALL_SITES			16
+#endif
+
+#define tlsfALIGN_SIZE_LOG2		3
+#define tlsfALIGN_SIZE			( ( size_t ) 1 << tlsfALIGN_SIZE_LOG2 )
+#define tlsfSL_INDEX_COUNT		( 1U << configTLSF_SL_INDEX_COUNT_LOG2 )
+#define tlsfFL_INDEX_SHIFT		( configTLSF_SL_INDEX_COUNT_LOG2 + tlsfALIGN_SIZE_LOG2 )
+#define tlsfFL_INDEX_COUNT		( configTLSF_FL_INDEX_MAX - tlsfFL_INDEX_SHIFT + 2 )
+#define tlsfSMALL_BLOCK_SIZE	( ( size_t ) 1 << tlsfFL_INDEX_SHIFT )
+
+/* Size of the block header - payload starts right after it. */
+#define tlsfHEADER_SIZE			( sizeof( xBlockHeader ) - 2 * sizeof( xBlockHeader * ) )
+
+/* Smallest payload - a free block keeps links of the free list there. */
+#define tlsfBLOCK_SIZE_MIN		( 2 * sizeof( xBlockHeader * ) )
+#define tlsfBLOCK_SIZE_MAX		( ( ( size_t ) 1 << ( configTLSF_FL_INDEX_MAX + 1 ) ) - tlsfALIGN_SIZE )
+
+/* Flags in the low bits of xSize, which are 0 in aligned sizes. */
+#define tlsfBLOCK_FREE			( ( size_t ) 1 )
+#define tlsfBLOCK_PREV_FREE		( ( size_t ) 2 )
+
+/* With call site statistics the index of the call site + 1 is kept in the
+highest byte of xSize of used blocks, so heap is limited to 16MB. */
+#define tlsfSITE_SHIFT			24
+#define tlsfSIZE_MASK			( ( ( ( size_t ) 1 << tlsfSITE_SHIFT ) - 1 ) & ~( tlsfALIGN_SIZE - 1 ) )
+
+#if ( portBYTE_ALIGNMENT > 8 )
+	#error heap_tlsf.c aligns blocks to 8 bytes
+#endif
+
+#if ( tlsfSL_INDEX_COUNT > 32 ) || ( tlsfFL_INDEX_COUNT > 32 )
+	#error Bitmaps of heap_tlsf.c have 32 bits
+#endif
+
+/*-----------------------------------------------------------*/
+
+typedef struct xBLOCK_HEADER
+{
+	struct xBLOCK_HEADER *pxPrevPhysBlock;	/*<< The block just before this one in memory. */
+	size_t xSize;							/*<< Size of the payload with tlsfBLOCK_... flags. */
+	struct xBLOCK_HEADER *pxNextFree;		/*<< Next block in the free list, only in free blocks. */
+	struct xBLOCK_HEADER *pxPrevFree;		/*<< Previous block in the free list, only in free blocks. */
+} xBlockHeader;
+
+typedef struct xHEAP_CONTROL
+{
+	unsigned long ulFLBitmap;									/*<< Bit per first level index with a free block. */
+	unsigned long ulSLBitmap[ tlsfFL_INDEX_COUNT ];				/*<< Bit per second level index with a free block. */
+	xBlockHeader *pxBlocks[ tlsfFL_INDEX_COUNT ][ tlsfSL_INDEX_COUNT ];	/*<< Heads of free lists. */
+} xHeapControl;
+
+/*-----------------------------------------------------------*/
+
+static xHeapControl xControl;
+
+static size_t xFreeBytesRemaining = 0;
+static size_t xMinimumEverFreeBytesRemaining = 0;
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
+static size_t xNumberOfFailedAllocations = 0;
+static portBASE_TYPE xHeapHasBeenInitialised = pdFALSE;
+
+#if ( configHEAP_CALL_SITE_STATS == 1 )
+
+	static xHeapCallSite xCallSites[ configHEAP_CALL_SITES ];
+
+#endif
+
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void );
+static void prvMappingInsert( size_t xSize, unsigned portBASE_TYPE *puxFL, unsigned portBASE_TYPE *puxSL );
+static xBlockHeader *prvFindFree( size_t xSize );
+static void prvInsertFree( xBlockHeader *pxBlock );
+static void prvRemoveFree( xBlockHeader *pxBlock );
+static xBlockHeader *prvNextPhysBlock( const xBlockHeader *pxBlock );
+
+#if ( configHEAP_CALL_SITE_STATS == 1 )
+
+	static size_t prvAccountCallSite( void *pvSite, size_t xSize );
+
+#endif
+
+/*-----------------------------------------------------------*/
+
+static inline size_t prvBlockSize( const xBlockHeader *pxBlock )
+{
+	return pxBlock->xSize & tlsfSIZE_MASK;
+}
+
+static inline unsigned portBASE_TYPE prvFLS( unsigned long ulValue )
+{
+	return 31 - __builtin_clz( ulValue );
+}
+
+static inline unsigned portBASE_TYPE prvFFS( unsigned long ulValue )
+{
+	return __builtin_ctz( ulValue );
+}
+
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+void *pvReturn = NULL;
+xBlockHeader *pxBlock;
+size_t xSize;
+
+	#if ( configHEAP_CALL_SITE_STATS == 1 )
+		void *pvSite = __builtin_return_address( 0 );
+	#endif
+
+	vTaskSuspendAll();
+	{
+		if( xHeapHasBeenInitialised == pdFALSE )
+		{
+			prvHeapInit();
+		}
+
+		if( ( xWantedSize > 0 ) && ( xWantedSize <= tlsfBLOCK_SIZE_MAX ) )
+		{
+			xSize = ( xWantedSize + tlsfALIGN_SIZE - 1 ) & ~( tlsfALIGN_SIZE - 1 );
+
+			if( xSize < tlsfBLOCK_SIZE_MIN )
+			{
+				xSize = tlsfBLOCK_SIZE_MIN;
+			}
+
+			pxBlock = prvFindFree( xSize );
+
+			if( pxBlock != NULL )
+			{
+			size_t xBlockSize = prvBlockSize( pxBlock );
+			xBlockHeader *pxNext;
+
+				prvRemoveFree( pxBlock );
+
+				if( xBlockSize >= xSize + tlsfHEADER_SIZE + tlsfBLOCK_SIZE_MIN )
+				{
+					/* Split - the remainder becomes a new free block, the block
+					after it still follows a free block. */
+					xBlockHeader *pxRemainder = ( xBlockHeader * ) ( ( char * ) pxBlock + tlsfHEADER_SIZE + xSize );
+
+					pxRemainder->xSize = xBlockSize - xSize - tlsfHEADER_SIZE;
+					pxRemainder->pxPrevPhysBlock = pxBlock;
+					prvNextPhysBlock( pxRemainder )->pxPrevPhysBlock = pxRemainder;
+					prvInsertFree( pxRemainder );
+					xFreeBytesRemaining -= xSize + tlsfHEADER_SIZE;
+					xBlockSize = xSize;
+				}
+				else
+				{
+					pxNext = prvNextPhysBlock( pxBlock );
+					pxNext->xSize &= ~tlsfBLOCK_PREV_FREE;
+					xFreeBytesRemaining -= xBlockSize;
+				}
+
+				pxBlock->xSize = xBlockSize | ( pxBlock->xSize & tlsfBLOCK_PREV_FREE );
+
+				#if ( configHEAP_CALL_SITE_STATS == 1 )
+				{
+					pxBlock->xSize |= prvAccountCallSite( pvSite, xBlockSize ) << tlsfSITE_SHIFT;
+				}
+				#endif
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+
+				xNumberOfSuccessfulAllocations++;
+				pvReturn = ( char * ) pxBlock + tlsfHEADER_SIZE;
+			}
+		}
+
+		if( pvReturn == NULL )
+		{
+			xNumberOfFailedAllocations++;
+		}
+	}
+	xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+	}
+	#endif
+
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+xBlockHeader *pxBlock, *pxNext, *pxPrev;
+
+	if( pv == NULL )
+	{
+		return;
+	}
+
+	pxBlock = ( xBlockHeader * ) ( ( char * ) pv - tlsfHEADER_SIZE );
+
+	vTaskSuspendAll();
+	{
+		configASSERT( ( pxBlock->xSize & tlsfBLOCK_FREE ) == 0 );
+
+		#if ( configHEAP_CALL_SITE_STATS == 1 )
+		{
+		size_t xSite = pxBlock->xSize >> tlsfSITE_SHIFT;
+
+			if( xSite != 0 )
+			{
+				xCallSites[ xSite - 1 ].uxLiveBlocks--;
+				xCallSites[ xSite - 1 ].xLiveBytes -= prvBlockSize( pxBlock );
+			}
+		}
+		#endif
+
+		pxBlock->xSize = prvBlockSize( pxBlock ) | ( pxBlock->xSize & tlsfBLOCK_PREV_FREE );
+		xFreeBytesRemaining += pxBlock->xSize & tlsfSIZE_MASK;
+		xNumberOfSuccessfulFrees++;
+
+		/* Merge with the previous block. */
+		if( ( pxBlock->xSize & tlsfBLOCK_PREV_FREE ) != 0 )
+		{
+			pxPrev = pxBlock->pxPrevPhysBlock;
+			prvRemoveFree( pxPrev );
+			pxPrev->xSize = ( prvBlockSize( pxPrev ) + tlsfHEADER_SIZE + prvBlockSize( pxBlock ) ) |
+					( pxPrev->xSize & tlsfBLOCK_PREV_FREE );
+			xFreeBytesRemaining += tlsfHEADER_SIZE;
+			pxBlock = pxPrev;
+		}
+
+		/* Merge with the next block. */
+		pxNext = prvNextPhysBlock( pxBlock );
+
+		if( ( pxNext->xSize & tlsfBLOCK_FREE ) != 0 )
+		{
+			prvRemoveFree( pxNext );
+			pxBlock->xSize = ( prvBlockSize( pxBlock ) + tlsfHEADER_SIZE + prvBlockSize( pxNext ) ) |
+					( pxBlock->xSize & tlsfBLOCK_PREV_FREE );
+			xFreeBytesRemaining += tlsfHEADER_SIZE;
+		}
+
+		pxNext = prvNextPhysBlock( pxBlock );
+		pxNext->pxPrevPhysBlock = pxBlock;
+		pxNext->xSize |= tlsfBLOCK_PREV_FREE;
+		prvInsertFree( pxBlock );
+	}
+	xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetBlockSize( void *pv )
+{
+	return prvBlockSize( ( xBlockHeader * ) ( ( char * ) pv - tlsfHEADER_SIZE ) );
+}
+/*-----------------------------------------------------------*/
+
+void vPortInitialiseBlocks( void )
+{
+	/* This just exists to keep the linker quiet. */
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetHeapStats( xHeapStats *pxHeapStats )
+{
+unsigned portBASE_TYPE uxFL, uxSL;
+size_t xLargest = 0;
+xBlockHeader *pxBlock;
+
+	vTaskSuspendAll();
+	{
+		if( xHeapHasBeenInitialised == pdFALSE )
+		{
+			prvHeapInit();
+		}
+
+		/* The largest block is in the highest non-empty list - only this one
+		list has to be walked. */
+		if( xControl.ulFLBitmap != 0 )
+		{
+			uxFL = prvFLS( xControl.ulFLBitmap );
+			uxSL = prvFLS( xControl.ulSLBitmap[ uxFL ] );
+
+			for( pxBlock = xControl.pxBlocks[ uxFL ][ uxSL ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFree )
+			{
+				if( prvBlockSize( pxBlock ) > xLargest )
+				{
+					xLargest = prvBlockSize( pxBlock );
+				}
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xSizeOfLargestFreeBlockInBytes = xLargest;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+		pxHeapStats->xNumberOfFailedAllocations = xNumberOfFailedAllocations;
+	}
+	xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_CALL_SITE_STATS == 1 )
+
+	unsigned portBASE_TYPE uxPortGetHeapCallSites( xHeapCallSite *pxCallSites, unsigned portBASE_TYPE uxMaxCount )
+	{
+	unsigned portBASE_TYPE uxCount = 0, ux;
+
+		vTaskSuspendAll();
+		{
+			for( ux = 0; ( ux < configHEAP_CALL_SITES ) && ( uxCount < uxMaxCount ); ux++ )
+			{
+				if( xCallSites[ ux ].pvSite != NULL )
+				{
+					pxCallSites[ uxCount++ ] = xCallSites[ ux ];
+				}
+			}
+		}
+		xTaskResumeAll();
+
+		return uxCount;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+static void prvHeapInit( void )
+{
+char *pcStart = ( char * ) ( ( ( size_t ) configHEAP_START + tlsfALIGN_SIZE - 1 ) & ~( tlsfALIGN_SIZE - 1 ) );
+char *pcEnd = ( char * ) ( ( size_t ) configHEAP_END & ~( tlsfALIGN_SIZE - 1 ) );
+size_t xSize;
+xBlockHeader *pxBlock, *pxSentinel;
+
+	/* One free block spans the heap, followed by a used block of size 0 which
+	ends the chain of physical blocks. */
+	xSize = ( size_t ) ( pcEnd - pcStart ) - 2 * tlsfHEADER_SIZE;
+
+	if( xSize > tlsfBLOCK_SIZE_MAX )
+	{
+		xSize = tlsfBLOCK_SIZE_MAX;
+	}
+
+	pxBlock = ( xBlockHeader * ) pcStart;
+	pxBlock->pxPrevPhysBlock = NULL;
+	pxBlock->xSize = xSize;
+
+	pxSentinel = prvNextPhysBlock( pxBlock );
+	pxSentinel->pxPrevPhysBlock = pxBlock;
+	pxSentinel->xSize = tlsfBLOCK_PREV_FREE;
+
+	prvInsertFree( pxBlock );
+
+	xFreeBytesRemaining = xSize;
+	xMinimumEverFreeBytesRemaining = xSize;
+	xHeapHasBeenInitialised = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMappingInsert( size_t xSize, unsigned portBASE_TYPE *puxFL, unsigned portBASE_TYPE *puxSL )
+{
+unsigned portBASE_TYPE uxFL;
+
+	if( xSize < tlsfSMALL_BLOCK_SIZE )
+	{
+		/* Small blocks are in the first list, split linearly. */
+		*puxFL = 0;
+		*puxSL = xSize / ( tlsfSMALL_BLOCK_SIZE / tlsfSL_INDEX_COUNT );
+	}
+	else
+	{
+		uxFL = prvFLS( xSize );
+		*puxSL = ( xSize >> ( uxFL - configTLSF_SL_INDEX_COUNT_LOG2 ) ) ^ tlsfSL_INDEX_COUNT;
+		*puxFL = uxFL - tlsfFL_INDEX_SHIFT + 1;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static xBlockHeader *prvFindFree( size_t xSize )
+{
+unsigned portBASE_TYPE uxFL, uxSL;
+unsigned long ulSLMap, ulFLMap;
+
+	/* Round the size up to the next list, so every block in the found list
+	is big enough (good fit). */
+	if( xSize >= tlsfSMALL_BLOCK_SIZE )
+	{
+		xSize += ( ( size_t ) 1 << ( prvFLS( xSize ) - configTLSF_SL_INDEX_COUNT_LOG2 ) ) - 1;
+	}
+
+	prvMappingInsert( xSize, &uxFL, &uxSL );
+
+	if( uxFL >= tlsfFL_INDEX_COUNT )
+	{
+		return NULL;
+	}
+
+	ulSLMap = xControl.ulSLBitmap[ uxFL ] & ( ~0UL << uxSL );
+
+	if( ulSLMap == 0 )
+	{
+		/* No block in this first level range - use the smallest bigger one. */
+		ulFLMap = ( uxFL + 1 < 32 ) ? ( xControl.ulFLBitmap & ( ~0UL << ( uxFL + 1 ) ) ) : 0;
+
+		if( ulFLMap == 0 )
+		{
+			return NULL;
+		}
+
+		uxFL = prvFFS( ulFLMap );
+		ulSLMap = xControl.ulSLBitmap[ uxFL ];
+	}
+
+	uxSL = prvFFS( ulSLMap );
+
+	return xControl.pxBlocks[ uxFL ][ uxSL ];
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFree( xBlockHeader *pxBlock )
+{
+unsigned portBASE_TYPE uxFL, uxSL;
+xBlockHeader *pxHead;
+
+	prvMappingInsert( prvBlockSize( pxBlock ), &uxFL, &uxSL );
+
+	pxHead = xControl.pxBlocks[ uxFL ][ uxSL ];
+	pxBlock->pxNextFree = pxHead;
+	pxBlock->pxPrevFree = NULL;
+
+	if( pxHead != NULL )
+	{
+		pxHead->pxPrevFree = pxBlock;
+	}
+
+	xControl.pxBlocks[ uxFL ][ uxSL ] = pxBlock;
+	xControl.ulFLBitmap |= 1UL << uxFL;
+	xControl.ulSLBitmap[ uxFL ] |= 1UL << uxSL;
+	pxBlock->xSize |= tlsfBLOCK_FREE;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFree( xBlockHeader *pxBlock )
+{
+unsigned portBASE_TYPE uxFL, uxSL;
+
+	prvMappingInsert( prvBlockSize( pxBlock ), &uxFL, &uxSL );
+
+	if( pxBlock->pxNextFree != NULL )
+	{
+		pxBlock->pxNextFree->pxPrevFree = pxBlock->pxPrevFree;
+	}
+
+	if( pxBlock->pxPrevFree != NULL )
+	{
+		pxBlock->pxPrevFree->pxNextFree = pxBlock->pxNextFree;
+	}
+	else
+	{
+		xControl.pxBlocks[ uxFL ][ uxSL ] = pxBlock->pxNextFree;
+
+		if( pxBlock->pxNextFree == NULL )
+		{
+			xControl.ulSLBitmap[ uxFL ] &= ~( 1UL << uxSL );
+
+			if( xControl.ulSLBitmap[ uxFL ] == 0 )
+			{
+				xControl.ulFLBitmap &= ~( 1UL << uxFL );
+			}
+		}
+	}
+
+	pxBlock->xSize &= ~tlsfBLOCK_FREE;
+}
+/*-----------------------------------------------------------*/
+
+static xBlockHeader *prvNextPhysBlock( const xBlockHeader *pxBlock )
+{
+	return ( xBlockHeader * ) ( ( char * ) pxBlock + tlsfHEADER_SIZE + prvBlockSize( pxBlock ) );
+}
+/*-----------------------------------------------------------*/
+
+#if ( configHEAP_CALL_SITE_STATS == 1 )
+
+	static size_t prvAccountCallSite( void *pvSite, size_t xSize )
+	{
+	size_t x, xFree = configHEAP_CALL_SITES;
+
+		for( x = 0; x < configHEAP_CALL_SITES; x++ )
+		{
+			if( xCallSites[ x ].pvSite == pvSite )
+			{
+				break;
+			}
+
+			if( ( xCallSites[ x ].pvSite == NULL ) && ( xFree == configHEAP_CALL_SITES ) )
+			{
+				xFree = x;
+			}
+		}
+
+		if( x == configHEAP_CALL_SITES )
+		{
+			if( xFree == configHEAP_CALL_SITES )
+			{
+				/* Table full - the block is not accounted. */
+				return 0;
+			}
+
+			x = xFree;
+			xCallSites[ x ].pvSite = pvSite;
+		}
+
+		xCallSites[ x ].uxLiveBlocks++;
+		xCallSites[ x ].xLiveBytes += xSize;
+
+		if( xCallSites[ x ].xLiveBytes > xCallSites[ x ].xPeakBytes )
+		{
+			xCallSites[ x ].xPeakBytes = xCallSites[ x ].xLiveBytes;
+		}
+
+		return x + 1;
+	}
+
+#endif
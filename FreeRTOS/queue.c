@@ -141,9 +141,20 @@ typedef struct QueueDefinition
 		unsigned char ucQueueType;
 	#endif
 
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char ucStaticallyAllocated;	/*< Set to pdTRUE if the memory of the queue must not be freed when the queue is deleted. */
+	#endif
+
 } xQUEUE;
 /*-----------------------------------------------------------*/
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	/* xStaticQueue in FreeRTOS.h must be kept in line with xQUEUE. */
+	typedef char prvStaticQueueSizeCheck[ ( sizeof( xStaticQueue ) == sizeof( xQUEUE ) ) ? 1 : -1 ];
+
+#endif
+
 /*
  * Inside this file xQueueHandle is a pointer to a xQUEUE structure.
  * To keep the definition private the API header file defines it as a
@@ -178,6 +189,10 @@ void vQueueSetQueueNumber( xQueueHandle pxQueue, unsigned char ucQueueNumber ) P
 unsigned char ucQueueGetQueueType( xQueueHandle pxQueue ) PRIVILEGED_FUNCTION;
 portBASE_TYPE xQueueGenericReset( xQueueHandle pxQueue, portBASE_TYPE xNewQueue ) PRIVILEGED_FUNCTION;
 xTaskHandle xQueueGetMutexHolder( xQueueHandle xSemaphore ) PRIVILEGED_FUNCTION;
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xQueueHandle xQueueGenericCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueue *pxStaticQueue, unsigned char ucQueueType ) PRIVILEGED_FUNCTION;
+	xQueueHandle xQueueCreateMutexStatic( unsigned char ucQueueType, xStaticQueue *pxStaticQueue ) PRIVILEGED_FUNCTION;
+#endif
 
 /*
  * Co-routine queue functions differ from task queue functions.  Co-routines are
@@ -250,6 +265,14 @@ static void prvCopyDataToQueue( xQUEUE *pxQueue, const void *pvItemToQueue, port
  * Copies an item out of a queue.
  */
 static void prvCopyDataFromQueue( xQUEUE * const pxQueue, const void *pvBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Initialises the members of a new mutex, common part of xQueueCreateMutex()
+ * and xQueueCreateMutexStatic().
+ */
+#if ( configUSE_MUTEXES == 1 )
+	static void prvInitialiseMutex( xQUEUE *pxNewQueue, unsigned char ucQueueType ) PRIVILEGED_FUNCTION;
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -347,6 +370,11 @@ xQueueHandle xReturn = NULL;
 				pxNewQueue->uxLength = uxQueueLength;
 				pxNewQueue->uxItemSize = uxItemSize;
 				xQueueGenericReset( pxNewQueue, pdTRUE );
+				#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+				{
+					pxNewQueue->ucStaticallyAllocated = pdFALSE;
+				}
+				#endif
 				#if ( configUSE_TRACE_FACILITY == 1 )
 				{
 					pxNewQueue->ucQueueType = ucQueueType;
@@ -370,19 +398,59 @@ xQueueHandle xReturn = NULL;
 }
 /*-----------------------------------------------------------*/
 
-#if ( configUSE_MUTEXES == 1 )
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
 
-	xQueueHandle xQueueCreateMutex( unsigned char ucQueueType )
+	xQueueHandle xQueueGenericCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueue *pxStaticQueue, unsigned char ucQueueType )
 	{
-	xQUEUE *pxNewQueue;
+	xQUEUE *pxNewQueue = ( xQUEUE * ) pxStaticQueue;
+
+		/* Remove compiler warnings about unused parameters should
+		configUSE_TRACE_FACILITY not be set to 1. */
+		( void ) ucQueueType;
+
+		configASSERT( uxQueueLength > ( unsigned portBASE_TYPE ) 0 );
+		configASSERT( pxStaticQueue );
+
+		/* The storage must be queueSTATIC_STORAGE_SIZE() bytes long - one byte
+		longer than the items, as in xQueueGenericCreate().  Semaphores don't
+		store any data, but pcHead must not be NULL as that marks a mutex, so it
+		points to the queue structure itself. */
+		if( uxItemSize == ( unsigned portBASE_TYPE ) 0 )
+		{
+			pxNewQueue->pcHead = ( signed char * ) pxNewQueue;
+		}
+		else
+		{
+			configASSERT( pucQueueStorage );
+			pxNewQueue->pcHead = ( signed char * ) pucQueueStorage;
+		}
+
+		pxNewQueue->uxLength = uxQueueLength;
+		pxNewQueue->uxItemSize = uxItemSize;
+		xQueueGenericReset( pxNewQueue, pdTRUE );
+		pxNewQueue->ucStaticallyAllocated = pdTRUE;
+		#if ( configUSE_TRACE_FACILITY == 1 )
+		{
+			pxNewQueue->ucQueueType = ucQueueType;
+		}
+		#endif /* configUSE_TRACE_FACILITY */
+
+		traceQUEUE_CREATE( pxNewQueue );
+
+		return pxNewQueue;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
 
+#if ( configUSE_MUTEXES == 1 )
+
+	static void prvInitialiseMutex( xQUEUE *pxNewQueue, unsigned char ucQueueType )
+	{
 		/* Prevent compiler warnings about unused parameters if
 		configUSE_TRACE_FACILITY does not equal 1. */
 		( void ) ucQueueType;
 
-		/* Allocate the new queue structure. */
-		pxNewQueue = ( xQUEUE * ) pvPortMalloc( sizeof( xQUEUE ) );
-		if( pxNewQueue != NULL )
 		{
 			/* Information required for priority inheritance. */
 			pxNewQueue->pxMutexHolder = NULL;
@@ -417,6 +485,25 @@ xQueueHandle xReturn = NULL;
 			/* Start with the semaphore in the expected state. */
 			xQueueGenericSend( pxNewQueue, NULL, ( portTickType ) 0U, queueSEND_TO_BACK );
 		}
+	}
+	/*-----------------------------------------------------------*/
+
+	xQueueHandle xQueueCreateMutex( unsigned char ucQueueType )
+	{
+	xQUEUE *pxNewQueue;
+
+		/* Allocate the new queue structure. */
+		pxNewQueue = ( xQUEUE * ) pvPortMalloc( sizeof( xQUEUE ) );
+		if( pxNewQueue != NULL )
+		{
+			#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+			{
+				pxNewQueue->ucStaticallyAllocated = pdFALSE;
+			}
+			#endif
+
+			prvInitialiseMutex( pxNewQueue, ucQueueType );
+		}
 		else
 		{
 			traceCREATE_MUTEX_FAILED();
@@ -425,6 +512,23 @@ xQueueHandle xReturn = NULL;
 		configASSERT( pxNewQueue );
 		return pxNewQueue;
 	}
+	/*-----------------------------------------------------------*/
+
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+		xQueueHandle xQueueCreateMutexStatic( unsigned char ucQueueType, xStaticQueue *pxStaticQueue )
+		{
+		xQUEUE *pxNewQueue = ( xQUEUE * ) pxStaticQueue;
+
+			configASSERT( pxStaticQueue );
+
+			pxNewQueue->ucStaticallyAllocated = pdTRUE;
+			prvInitialiseMutex( pxNewQueue, ucQueueType );
+
+			return pxNewQueue;
+		}
+
+	#endif /* configSUPPORT_STATIC_ALLOCATION */
 
 #endif /* configUSE_MUTEXES */
 /*-----------------------------------------------------------*/
@@ -1196,6 +1300,17 @@ void vQueueDelete( xQueueHandle pxQueue )
 
 	traceQUEUE_DELETE( pxQueue );
 	vQueueUnregisterQueue( pxQueue );
+
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	{
+		/* Memory provided by the application is not freed. */
+		if( pxQueue->ucStaticallyAllocated != pdFALSE )
+		{
+			return;
+		}
+	}
+	#endif
+
 	vPortFree( pxQueue->pcHead );
 	vPortFree( pxQueue );
 }
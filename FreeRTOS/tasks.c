@@ -129,8 +129,41 @@ typedef struct tskTaskControlBlock
 		unsigned long ulRunTimeCounter;		/*< Used for calculating how much CPU time each task is utilising. */
 	#endif
 
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+		volatile unsigned long ulNotifiedValue;	/*< Number of notifications given to the task and not taken yet, see xTaskNotifyGive(). */
+	#endif
+
+	#if ( INCLUDE_uxTaskGetStackHighWaterMark == 1 )
+		unsigned short usStackDepth;		/*< The size of the stack in words, reported with the high water mark. */
+	#endif
+
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+		volatile unsigned char ucNotifyState;	/*< taskWAITING_NOTIFICATION while the task is blocked in ulTaskNotifyTake().  Kept next to the other byte members so the TCB doesn't grow by padding. */
+	#endif
+
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char ucStaticAllocation;	/*< tskSTATIC_TCB and tskSTATIC_STACK flags - memory which must not be freed when the task is deleted. */
+	#endif
+
 } tskTCB;
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	#define tskSTATIC_TCB		( ( unsigned char ) 0x01U )
+	#define tskSTATIC_STACK		( ( unsigned char ) 0x02U )
+
+	/* xStaticTask in FreeRTOS.h must be kept in line with tskTCB. */
+	typedef char prvStaticTaskSizeCheck[ ( sizeof( xStaticTask ) == sizeof( tskTCB ) ) ? 1 : -1 ];
+
+#endif
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	#define taskNOT_WAITING_NOTIFICATION	( ( unsigned char ) 0U )
+	#define taskWAITING_NOTIFICATION		( ( unsigned char ) 1U )
+
+#endif
+
 
 /*
  * Some kernel aware debuggers require data to be viewed to be global, rather
@@ -192,6 +225,12 @@ PRIVILEGED_DATA static portTickType xNextTaskUnblockTime						= ( portTickType )
 
 #endif
 
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	static unsigned portBASE_TYPE prvListTaskStatusWithinSingleList( xTaskStatusType *pxTaskStatusArray, xList *pxList ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /* Debugging and trace facilities private variables and macros. ------------*/
 
 /*
@@ -352,11 +391,45 @@ static void prvCheckTasksWaitingTermination( void ) PRIVILEGED_FUNCTION;
  */
 static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake ) PRIVILEGED_FUNCTION;
 
+/*
+ * Return the amount of time, in ticks, that will pass before the kernel will
+ * next move a task from the Blocked state to the Running state.  Returns 0 if
+ * a task other than the idle task is ready to run.
+ */
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	static portTickType prvGetExpectedIdleTime( void ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * Allocates memory from the heap for a TCB and associated stack.  Checks the
  * allocation was successful.
  */
-static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer ) PRIVILEGED_FUNCTION;
+static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer, tskTCB *pxTCBBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Creates a task - common part of xTaskGenericCreate() and xTaskCreateStatic().
+ * The TCB is allocated from the heap if pxTCBBuffer is NULL.
+ */
+static signed portBASE_TYPE prvTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions, tskTCB *pxTCBBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * The idle task is created with the scheduler, its TCB and stack are static if
+ * static allocation is supported.
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	PRIVILEGED_DATA static xStaticTask xIdleTaskTCB;
+	PRIVILEGED_DATA static portSTACK_TYPE xIdleTaskStack[ tskIDLE_STACK_SIZE ];
+
+	#define prvCreateIdleTask( pxCreatedTask ) xTaskCreateStatic( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), ( pxCreatedTask ), xIdleTaskStack, &xIdleTaskTCB )
+
+#else
+
+	#define prvCreateIdleTask( pxCreatedTask ) xTaskCreate( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), ( pxCreatedTask ) )
+
+#endif
 
 /*
  * Called from vTaskList.  vListTasks details all the tasks currently under
@@ -394,6 +467,25 @@ static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TY
  *----------------------------------------------------------*/
 
 signed portBASE_TYPE xTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions )
+{
+	return prvTaskGenericCreate( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, puxStackBuffer, xRegions, NULL );
+}
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	signed portBASE_TYPE xTaskCreateStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, xStaticTask *pxTaskBuffer )
+	{
+		configASSERT( puxStackBuffer );
+		configASSERT( pxTaskBuffer );
+
+		return prvTaskGenericCreate( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, puxStackBuffer, NULL, ( tskTCB * ) pxTaskBuffer );
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+static signed portBASE_TYPE prvTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions, tskTCB *pxTCBBuffer )
 {
 signed portBASE_TYPE xReturn;
 tskTCB * pxNewTCB;
@@ -403,7 +495,7 @@ tskTCB * pxNewTCB;
 
 	/* Allocate the memory required by the TCB and stack for the new task,
 	checking that the allocation was successful. */
-	pxNewTCB = prvAllocateTCBAndStack( usStackDepth, puxStackBuffer );
+	pxNewTCB = prvAllocateTCBAndStack( usStackDepth, puxStackBuffer, pxTCBBuffer );
 
 	if( pxNewTCB != NULL )
 	{
@@ -1063,12 +1155,12 @@ portBASE_TYPE xReturn;
 	{
 		/* Create the idle task, storing its handle in xIdleTaskHandle so it can
 		be returned by the xTaskGetIdleTaskHandle() function. */
-		xReturn = xTaskCreate( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), &xIdleTaskHandle );
+		xReturn = prvCreateIdleTask( &xIdleTaskHandle );
 	}
 	#else
 	{
 		/* Create the idle task without storing its handle. */
-		xReturn = xTaskCreate( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), NULL );
+		xReturn = prvCreateIdleTask( NULL );
 	}
 	#endif
 
@@ -1424,6 +1516,87 @@ unsigned portBASE_TYPE uxTaskGetNumberOfTasks( void )
 		return xIdleTaskHandle;
 	}
 	
+#endif
+/*----------------------------------------------------------*/
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+	unsigned long ulTaskGetRunTimeCounter( xTaskHandle xTask )
+	{
+	tskTCB *pxTCB;
+
+		/* The counter is a single word, so it can be read without entering a
+		critical section. */
+		pxTCB = prvGetTCBFromHandle( xTask );
+		return pxTCB->ulRunTimeCounter;
+	}
+
+#endif
+/*----------------------------------------------------------*/
+
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	unsigned portBASE_TYPE uxTaskGetSystemState( xTaskStatusType *pxTaskStatusArray, unsigned portBASE_TYPE uxArraySize, unsigned long *pulTotalRunTime )
+	{
+	unsigned portBASE_TYPE uxTask = 0, uxQueue = configMAX_PRIORITIES;
+
+		vTaskSuspendAll();
+		{
+			/* Is there a space in the array for each task in the system? */
+			if( uxArraySize >= uxCurrentNumberOfTasks )
+			{
+				/* Fill in an xTaskStatusType structure with information on
+				each task in the Ready state. */
+				do
+				{
+					uxQueue--;
+					uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( xList * ) &( pxReadyTasksLists[ uxQueue ] ) );
+				} while( uxQueue > ( unsigned portBASE_TYPE ) tskIDLE_PRIORITY );
+
+				/* Blocked tasks. */
+				uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( xList * ) pxDelayedTaskList );
+				uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( xList * ) pxOverflowDelayedTaskList );
+
+				/* Tasks woken while the scheduler was suspended are still
+				referenced from the lists above with their generic list items,
+				xPendingReadyList holds only their event list items. */
+
+				#if ( INCLUDE_vTaskDelete == 1 )
+				{
+					/* Tasks that have been deleted but not yet cleaned up. */
+					uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &xTasksWaitingTermination );
+				}
+				#endif
+
+				#if ( INCLUDE_vTaskSuspend == 1 )
+				{
+					uxTask += prvListTaskStatusWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &xSuspendedTaskList );
+				}
+				#endif
+
+				if( pulTotalRunTime != NULL )
+				{
+					#if ( configGENERATE_RUN_TIME_STATS == 1 )
+					{
+						#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
+							portALT_GET_RUN_TIME_COUNTER_VALUE( ( *pulTotalRunTime ) );
+						#else
+							*pulTotalRunTime = portGET_RUN_TIME_COUNTER_VALUE();
+						#endif
+					}
+					#else
+					{
+						*pulTotalRunTime = 0UL;
+					}
+					#endif
+				}
+			}
+		}
+		( void ) xTaskResumeAll();
+
+		return uxTask;
+	}
+
 #endif
 
 /*-----------------------------------------------------------
@@ -1506,6 +1679,43 @@ tskTCB * pxTCB;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	void vTaskStepTick( portTickType xTicksToJump )
+	{
+		/* Correct the tick count value after a period during which the tick
+		was suppressed.  Note this does *not* call the tick hook function for
+		each stepped tick. */
+		configASSERT( ( xTickCount + xTicksToJump ) < xNextTaskUnblockTime );
+		xTickCount += xTicksToJump;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	eSleepModeStatus eTaskConfirmSleepModeStatus( void )
+	{
+	eSleepModeStatus eReturn = eStandardSleep;
+
+		if( listCURRENT_LIST_LENGTH( &xPendingReadyList ) != 0 )
+		{
+			/* A task was made ready while the scheduler was suspended. */
+			eReturn = eAbortSleep;
+		}
+		else if( xMissedYield != pdFALSE )
+		{
+			/* A yield was pended while the scheduler was suspended. */
+			eReturn = eAbortSleep;
+		}
+
+		return eReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_APPLICATION_TASK_TAG == 1 )
 
 	void vTaskSetApplicationTaskTag( xTaskHandle xTask, pdTASK_HOOK_CODE pxHookFunction )
@@ -1921,6 +2131,36 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 		}
 		#endif
 
+		#if ( configUSE_TICKLESS_IDLE != 0 )
+		{
+		portTickType xExpectedIdleTime;
+
+			/* It is not desirable to suspend then resume the scheduler on
+			each iteration of the idle task.  Therefore, a preliminary test
+			of the expected idle time is performed without the scheduler
+			suspended.  The result here is not necessarily valid. */
+			xExpectedIdleTime = prvGetExpectedIdleTime();
+
+			if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+			{
+				vTaskSuspendAll();
+				{
+					/* Now the scheduler is suspended, the expected idle
+					time can be sampled again, and this time its value can
+					be used. */
+					configASSERT( xNextTaskUnblockTime >= xTickCount );
+					xExpectedIdleTime = prvGetExpectedIdleTime();
+
+					if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+					{
+						portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime );
+					}
+				}
+				xTaskResumeAll();
+			}
+		}
+		#endif
+
 		#if ( configUSE_IDLE_HOOK == 1 )
 		{
 			extern void vApplicationIdleHook( void );
@@ -2002,6 +2242,19 @@ static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const
 	}
 	#endif
 
+	#if ( INCLUDE_uxTaskGetStackHighWaterMark == 1 )
+	{
+		pxTCB->usStackDepth = usStackDepth;
+	}
+	#endif
+
+	#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+	{
+		pxTCB->ulNotifiedValue = 0UL;
+		pxTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+	}
+	#endif
+
 	#if ( portUSING_MPU_WRAPPERS == 1 )
 	{
 		vPortStoreTaskMPUSettings( &( pxTCB->xMPUSettings ), xRegions, pxTCB->pxStack, usStackDepth );
@@ -2101,6 +2354,34 @@ static void prvCheckTasksWaitingTermination( void )
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICKLESS_IDLE != 0 )
+
+	static portTickType prvGetExpectedIdleTime( void )
+	{
+	portTickType xReturn;
+
+		if( pxCurrentTCB->uxPriority > tskIDLE_PRIORITY )
+		{
+			xReturn = 0;
+		}
+		else if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > 1 )
+		{
+			/* There are other idle priority tasks in the ready state.  If
+			time slicing is used then the very next tick interrupt must be
+			processed. */
+			xReturn = 0;
+		}
+		else
+		{
+			xReturn = xNextTaskUnblockTime - xTickCount;
+		}
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake )
 {
 	/* The list item will be inserted in wake time order. */
@@ -2127,13 +2408,20 @@ static void prvAddCurrentTaskToDelayedList( portTickType xTimeToWake )
 }
 /*-----------------------------------------------------------*/
 
-static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer )
+static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer, tskTCB *pxTCBBuffer )
 {
 tskTCB *pxNewTCB;
 
-	/* Allocate space for the TCB.  Where the memory comes from depends on
-	the implementation of the port malloc function. */
-	pxNewTCB = ( tskTCB * ) pvPortMalloc( sizeof( tskTCB ) );
+	/* Allocate space for the TCB, unless it was provided.  Where the memory
+	comes from depends on the implementation of the port malloc function. */
+	if( pxTCBBuffer != NULL )
+	{
+		pxNewTCB = pxTCBBuffer;
+	}
+	else
+	{
+		pxNewTCB = ( tskTCB * ) pvPortMalloc( sizeof( tskTCB ) );
+	}
 
 	if( pxNewTCB != NULL )
 	{
@@ -2145,13 +2433,32 @@ tskTCB *pxNewTCB;
 		if( pxNewTCB->pxStack == NULL )
 		{
 			/* Could not allocate the stack.  Delete the allocated TCB. */
-			vPortFree( pxNewTCB );
+			if( pxTCBBuffer == NULL )
+			{
+				vPortFree( pxNewTCB );
+			}
 			pxNewTCB = NULL;
 		}
 		else
 		{
 			/* Just to help debugging. */
 			memset( pxNewTCB->pxStack, ( int ) tskSTACK_FILL_BYTE, ( size_t ) usStackDepth * sizeof( portSTACK_TYPE ) );
+
+			#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+			{
+				pxNewTCB->ucStaticAllocation = 0;
+
+				if( pxTCBBuffer != NULL )
+				{
+					pxNewTCB->ucStaticAllocation |= tskSTATIC_TCB;
+				}
+
+				if( puxStackBuffer != NULL )
+				{
+					pxNewTCB->ucStaticAllocation |= tskSTATIC_STACK;
+				}
+			}
+			#endif
 		}
 	}
 
@@ -2191,6 +2498,60 @@ tskTCB *pxNewTCB;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TRACE_FACILITY == 1 )
+
+	static unsigned portBASE_TYPE prvListTaskStatusWithinSingleList( xTaskStatusType *pxTaskStatusArray, xList *pxList )
+	{
+	volatile tskTCB *pxNextTCB, *pxFirstTCB;
+	unsigned portBASE_TYPE uxTask = 0;
+
+		if( listCURRENT_LIST_LENGTH( pxList ) > ( unsigned portBASE_TYPE ) 0 )
+		{
+			listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
+
+			/* Populate an xTaskStatusType structure within the
+			pxTaskStatusArray array for each task that is referenced from
+			pxList. */
+			do
+			{
+				listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList );
+
+				pxTaskStatusArray[ uxTask ].xHandle = ( xTaskHandle ) pxNextTCB;
+				pxTaskStatusArray[ uxTask ].pcTaskName = ( const signed char * ) &( pxNextTCB->pcTaskName [ 0 ] );
+				pxTaskStatusArray[ uxTask ].xTaskNumber = pxNextTCB->uxTCBNumber;
+				pxTaskStatusArray[ uxTask ].uxCurrentPriority = pxNextTCB->uxPriority;
+
+				#if ( configGENERATE_RUN_TIME_STATS == 1 )
+				{
+					pxTaskStatusArray[ uxTask ].ulRunTimeCounter = pxNextTCB->ulRunTimeCounter;
+				}
+				#else
+				{
+					pxTaskStatusArray[ uxTask ].ulRunTimeCounter = 0UL;
+				}
+				#endif
+
+				#if ( INCLUDE_uxTaskGetStackHighWaterMark == 1 )
+				{
+					pxTaskStatusArray[ uxTask ].usStackDepth = pxNextTCB->usStackDepth;
+				}
+				#else
+				{
+					pxTaskStatusArray[ uxTask ].usStackDepth = 0U;
+				}
+				#endif
+
+				uxTask++;
+
+			} while( pxNextTCB != pxFirstTCB );
+		}
+
+		return uxTask;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
 	static void prvGenerateRunTimeStatsForTasksInList( const signed char *pcWriteBuffer, xList *pxList, unsigned long ulTotalRunTime )
@@ -2321,8 +2682,25 @@ tskTCB *pxNewTCB;
 
 		/* Free up the memory allocated by the scheduler for the task.  It is up to
 		the task to free any memory allocated at the application level. */
-		vPortFreeAligned( pxTCB->pxStack );
-		vPortFree( pxTCB );
+		#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		{
+			/* Memory provided by the application is not freed. */
+			if( ( pxTCB->ucStaticAllocation & tskSTATIC_STACK ) == 0 )
+			{
+				vPortFreeAligned( pxTCB->pxStack );
+			}
+
+			if( ( pxTCB->ucStaticAllocation & tskSTATIC_TCB ) == 0 )
+			{
+				vPortFree( pxTCB );
+			}
+		}
+		#else
+		{
+			vPortFreeAligned( pxTCB->pxStack );
+			vPortFree( pxTCB );
+		}
+		#endif
 	}
 
 #endif
@@ -2475,6 +2853,181 @@ void vTaskExitCritical( void )
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	signed portBASE_TYPE xTaskNotifyGive( xTaskHandle xTaskToNotify )
+	{
+	tskTCB *pxTCB;
+	unsigned char ucOriginalNotifyState;
+
+		configASSERT( xTaskToNotify );
+
+		pxTCB = ( tskTCB * ) xTaskToNotify;
+
+		taskENTER_CRITICAL();
+		{
+			ucOriginalNotifyState = pxTCB->ucNotifyState;
+			pxTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+			( pxTCB->ulNotifiedValue )++;
+
+			traceTASK_NOTIFY_GIVE( pxTCB );
+
+			if( ucOriginalNotifyState == taskWAITING_NOTIFICATION )
+			{
+				/* The task is blocked in ulTaskNotifyTake(), so it is in a
+				delayed list or in the suspended list, but not in any event
+				list.  This function is called by a task, so the scheduler
+				can't be suspended by someone else - the lists can be accessed
+				directly. */
+				configASSERT( listIS_CONTAINED_WITHIN( NULL, &( pxTCB->xEventListItem ) ) );
+
+				vListRemove( &( pxTCB->xGenericListItem ) );
+				prvAddTaskToReadyQueue( pxTCB );
+
+				if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+				{
+					/* The notified task has a priority above the task that is
+					currently executing so a yield is required. */
+					portYIELD_WITHIN_API();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		return pdPASS;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	void vTaskNotifyGiveFromISR( xTaskHandle xTaskToNotify, signed portBASE_TYPE *pxHigherPriorityTaskWoken )
+	{
+	tskTCB *pxTCB;
+	unsigned char ucOriginalNotifyState;
+	unsigned portBASE_TYPE uxSavedInterruptStatus;
+
+		configASSERT( xTaskToNotify );
+
+		pxTCB = ( tskTCB * ) xTaskToNotify;
+
+		uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+		{
+			ucOriginalNotifyState = pxTCB->ucNotifyState;
+			pxTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+			( pxTCB->ulNotifiedValue )++;
+
+			traceTASK_NOTIFY_GIVE_FROM_ISR( pxTCB );
+
+			if( ucOriginalNotifyState == taskWAITING_NOTIFICATION )
+			{
+				configASSERT( listIS_CONTAINED_WITHIN( NULL, &( pxTCB->xEventListItem ) ) );
+
+				if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
+				{
+					vListRemove( &( pxTCB->xGenericListItem ) );
+					prvAddTaskToReadyQueue( pxTCB );
+				}
+				else
+				{
+					/* We cannot access the delayed or ready lists, so will hold
+					this task pending until the scheduler is resumed. */
+					vListInsertEnd( ( xList * ) &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
+				}
+
+				if( ( pxTCB->uxPriority > pxCurrentTCB->uxPriority ) && ( pxHigherPriorityTaskWoken != NULL ) )
+				{
+					*pxHigherPriorityTaskWoken = pdTRUE;
+				}
+			}
+		}
+		portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_NOTIFICATIONS == 1 )
+
+	unsigned long ulTaskNotifyTake( portBASE_TYPE xClearCountOnExit, portTickType xTicksToWait )
+	{
+	portTickType xTimeToWake;
+	unsigned long ulReturn;
+
+		/* Only block if the notification count is not already non-zero.  The
+		task is not placed in any event list - the notifying side finds it
+		through its handle. */
+		taskENTER_CRITICAL();
+		{
+			if( ( pxCurrentTCB->ulNotifiedValue == 0UL ) && ( xTicksToWait > ( portTickType ) 0U ) )
+			{
+				pxCurrentTCB->ucNotifyState = taskWAITING_NOTIFICATION;
+
+				traceTASK_NOTIFY_TAKE_BLOCK();
+
+				/* We must remove ourselves from the ready list before adding
+				ourselves to the blocked list as the same list item is used
+				for both lists. */
+				vListRemove( ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+
+				#if ( INCLUDE_vTaskSuspend == 1 )
+				{
+					if( xTicksToWait == portMAX_DELAY )
+					{
+						/* Add ourselves to the suspended task list instead of a
+						delayed task list to ensure we are not woken by a timing
+						event.  We will block indefinitely. */
+						vListInsertEnd( ( xList * ) &xSuspendedTaskList, ( xListItem * ) &( pxCurrentTCB->xGenericListItem ) );
+					}
+					else
+					{
+						xTimeToWake = xTickCount + xTicksToWait;
+						prvAddCurrentTaskToDelayedList( xTimeToWake );
+					}
+				}
+				#else
+				{
+					xTimeToWake = xTickCount + xTicksToWait;
+					prvAddCurrentTaskToDelayedList( xTimeToWake );
+				}
+				#endif
+
+				/* The context switch happens when the critical section is
+				exited. */
+				portYIELD_WITHIN_API();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		taskENTER_CRITICAL();
+		{
+			traceTASK_NOTIFY_TAKE();
+
+			ulReturn = pxCurrentTCB->ulNotifiedValue;
+
+			if( ulReturn != 0UL )
+			{
+				if( xClearCountOnExit != pdFALSE )
+				{
+					pxCurrentTCB->ulNotifiedValue = 0UL;
+				}
+				else
+				{
+					pxCurrentTCB->ulNotifiedValue = ulReturn - 1UL;
+				}
+			}
+
+			pxCurrentTCB->ucNotifyState = taskNOT_WAITING_NOTIFICATION;
+		}
+		taskEXIT_CRITICAL();
+
+		return ulReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 
 
 
@@ -94,8 +94,18 @@ typedef struct tmrTimerControl
 	unsigned portBASE_TYPE	uxAutoReload;		/*<< Set to pdTRUE if the timer should be automatically restarted once expired.  Set to pdFALSE if the timer is, in effect, a one shot timer. */
 	void 					*pvTimerID;			/*<< An ID to identify the timer.  This allows the timer to be identified when the same callback is used for multiple timers. */
 	tmrTIMER_CALLBACK		pxCallbackFunction;	/*<< The function that will be called when the timer expires. */
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char		ucStaticallyAllocated;/*<< Set to pdTRUE if the memory of the timer must not be freed when the timer is deleted. */
+	#endif
 } xTIMER;
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	/* xStaticTimer in FreeRTOS.h must be kept in line with xTIMER. */
+	typedef char prvStaticTimerSizeCheck[ ( sizeof( xStaticTimer ) == sizeof( xTIMER ) ) ? 1 : -1 ];
+
+#endif
+
 /* The definition of messages that can be sent and received on the timer
 queue. */
 typedef struct tmrTimerQueueMessage
@@ -123,6 +133,25 @@ PRIVILEGED_DATA static xQueueHandle xTimerQueue = NULL;
 	
 #endif
 
+/* The timer queue and the timer service task are created in static memory if
+static allocation is supported. */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	PRIVILEGED_DATA static xStaticQueue xTimerQueueBuffer;
+	PRIVILEGED_DATA static unsigned char ucTimerQueueStorage[ queueSTATIC_STORAGE_SIZE( configTIMER_QUEUE_LENGTH, sizeof( xTIMER_MESSAGE ) ) ];
+	PRIVILEGED_DATA static xStaticTask xTimerTaskTCB;
+	PRIVILEGED_DATA static portSTACK_TYPE xTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
+
+	#define tmrCREATE_TIMER_QUEUE() xQueueCreateStatic( ( unsigned portBASE_TYPE ) configTIMER_QUEUE_LENGTH, sizeof( xTIMER_MESSAGE ), ucTimerQueueStorage, &xTimerQueueBuffer )
+	#define tmrCREATE_TIMER_TASK( pxCreatedTask ) xTaskCreateStatic( prvTimerTask, ( const signed char * ) "Tmr Svc", ( unsigned short ) configTIMER_TASK_STACK_DEPTH, NULL, ( ( unsigned portBASE_TYPE ) configTIMER_TASK_PRIORITY ) | portPRIVILEGE_BIT, ( pxCreatedTask ), xTimerTaskStack, &xTimerTaskTCB )
+
+#else
+
+	#define tmrCREATE_TIMER_QUEUE() xQueueCreate( ( unsigned portBASE_TYPE ) configTIMER_QUEUE_LENGTH, sizeof( xTIMER_MESSAGE ) )
+	#define tmrCREATE_TIMER_TASK( pxCreatedTask ) xTaskCreate( prvTimerTask, ( const signed char * ) "Tmr Svc", ( unsigned short ) configTIMER_TASK_STACK_DEPTH, NULL, ( ( unsigned portBASE_TYPE ) configTIMER_TASK_PRIORITY ) | portPRIVILEGE_BIT, ( pxCreatedTask ) )
+
+#endif
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -131,6 +160,12 @@ PRIVILEGED_DATA static xQueueHandle xTimerQueue = NULL;
  */
 static void prvCheckForValidListAndQueue( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Initialise the members of a new timer - common part of xTimerCreate() and
+ * xTimerCreateStatic().
+ */
+static void prvInitialiseNewTimer( xTIMER *pxNewTimer, const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction ) PRIVILEGED_FUNCTION;
+
 /*
  * The timer service task (daemon).  Timer functionality is controlled by this
  * task.  Other tasks communicate with the timer service task using the
@@ -200,12 +235,12 @@ portBASE_TYPE xReturn = pdFAIL;
 		{
 			/* Create the timer task, storing its handle in xTimerTaskHandle so
 			it can be returned by the xTimerGetTimerDaemonTaskHandle() function. */
-			xReturn = xTaskCreate( prvTimerTask, ( const signed char * ) "Tmr Svc", ( unsigned short ) configTIMER_TASK_STACK_DEPTH, NULL, ( ( unsigned portBASE_TYPE ) configTIMER_TASK_PRIORITY ) | portPRIVILEGE_BIT, &xTimerTaskHandle );	
+			xReturn = tmrCREATE_TIMER_TASK( &xTimerTaskHandle );
 		}
 		#else
 		{
 			/* Create the timer task without storing its handle. */
-			xReturn = xTaskCreate( prvTimerTask, ( const signed char * ) "Tmr Svc", ( unsigned short ) configTIMER_TASK_STACK_DEPTH, NULL, ( ( unsigned portBASE_TYPE ) configTIMER_TASK_PRIORITY ) | portPRIVILEGE_BIT, NULL);
+			xReturn = tmrCREATE_TIMER_TASK( NULL );
 		}
 		#endif
 	}
@@ -230,19 +265,13 @@ xTIMER *pxNewTimer;
 		pxNewTimer = ( xTIMER * ) pvPortMalloc( sizeof( xTIMER ) );
 		if( pxNewTimer != NULL )
 		{
-			/* Ensure the infrastructure used by the timer service task has been
-			created/initialised. */
-			prvCheckForValidListAndQueue();
-	
-			/* Initialise the timer structure members using the function parameters. */
-			pxNewTimer->pcTimerName = pcTimerName;
-			pxNewTimer->xTimerPeriodInTicks = xTimerPeriodInTicks;
-			pxNewTimer->uxAutoReload = uxAutoReload;
-			pxNewTimer->pvTimerID = pvTimerID;
-			pxNewTimer->pxCallbackFunction = pxCallbackFunction;
-			vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
-			
-			traceTIMER_CREATE( pxNewTimer );
+			prvInitialiseNewTimer( pxNewTimer, pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction );
+
+			#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+			{
+				pxNewTimer->ucStaticallyAllocated = pdFALSE;
+			}
+			#endif
 		}
 		else
 		{
@@ -254,6 +283,42 @@ xTIMER *pxNewTimer;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	xTimerHandle xTimerCreateStatic( const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction, xStaticTimer *pxTimerBuffer )
+	{
+	xTIMER *pxNewTimer = ( xTIMER * ) pxTimerBuffer;
+
+		configASSERT( ( xTimerPeriodInTicks > 0 ) );
+		configASSERT( pxTimerBuffer );
+
+		prvInitialiseNewTimer( pxNewTimer, pcTimerName, xTimerPeriodInTicks, uxAutoReload, pvTimerID, pxCallbackFunction );
+		pxNewTimer->ucStaticallyAllocated = pdTRUE;
+
+		return ( xTimerHandle ) pxNewTimer;
+	}
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewTimer( xTIMER *pxNewTimer, const signed char *pcTimerName, portTickType xTimerPeriodInTicks, unsigned portBASE_TYPE uxAutoReload, void *pvTimerID, tmrTIMER_CALLBACK pxCallbackFunction )
+{
+	/* Ensure the infrastructure used by the timer service task has been
+	created/initialised. */
+	prvCheckForValidListAndQueue();
+
+	/* Initialise the timer structure members using the function parameters. */
+	pxNewTimer->pcTimerName = pcTimerName;
+	pxNewTimer->xTimerPeriodInTicks = xTimerPeriodInTicks;
+	pxNewTimer->uxAutoReload = uxAutoReload;
+	pxNewTimer->pvTimerID = pvTimerID;
+	pxNewTimer->pxCallbackFunction = pxCallbackFunction;
+	vListInitialiseItem( &( pxNewTimer->xTimerListItem ) );
+
+	traceTIMER_CREATE( pxNewTimer );
+}
+/*-----------------------------------------------------------*/
+
 portBASE_TYPE xTimerGenericCommand( xTimerHandle xTimer, portBASE_TYPE xCommandID, portTickType xOptionalValue, signed portBASE_TYPE *pxHigherPriorityTaskWoken, portTickType xBlockTime )
 {
 portBASE_TYPE xReturn = pdFAIL;
@@ -564,8 +629,20 @@ portTickType xTimeNow;
 
 			case tmrCOMMAND_DELETE :
 				/* The timer has already been removed from the active list,
-				just free up the memory. */
-				vPortFree( pxTimer );
+				just free up the memory, unless it was provided by the
+				application. */
+				#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+				{
+					if( pxTimer->ucStaticallyAllocated == pdFALSE )
+					{
+						vPortFree( pxTimer );
+					}
+				}
+				#else
+				{
+					vPortFree( pxTimer );
+				}
+				#endif
 				break;
 
 			default	:			
@@ -646,7 +723,7 @@ static void prvCheckForValidListAndQueue( void )
 			vListInitialise( &xActiveTimerList2 );
 			pxCurrentTimerList = &xActiveTimerList1;
 			pxOverflowTimerList = &xActiveTimerList2;
-			xTimerQueue = xQueueCreate( ( unsigned portBASE_TYPE ) configTIMER_QUEUE_LENGTH, sizeof( xTIMER_MESSAGE ) );
+			xTimerQueue = tmrCREATE_TIMER_QUEUE();
 		}
 	}
 	taskEXIT_CRITICAL();
@@ -0,0 +1,199 @@
+/*
+ * boottime.cpp
+ *
+ * Measurement of the boot sequence. Time from reset is counted with DWT cycle counter, which is started by
+ * boottimeStart() from low_level_init_0(). The counter runs with the core clock, so elapsed cycles are converted to
+ * microseconds around every change of the system clock. The counter is shared with the trace recorder, so it's never
+ * written after the start - cycles are counted from the value at the previous change. The change itself (waiting for
+ * oscillators) is counted with the old frequency. Time spent in sleep modes (core clock stopped) isn't counted, so the
+ * measurement is valid for the boot sequence only. Milestones are printed by the "boot" command of the console.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "stm32l1xx.h"
+
+#include "rcc.h"
+
+#include "boottime.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static uint32_t _now(uint32_t frequency);
+static void _fold(uint32_t frequency);
+static void _clockPreChange(uint32_t frequency);
+static void _clockPostChange(uint32_t frequency);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+static uint32_t _elapsed_us;				///< time folded from the cycle counter at previous clock changes
+static uint32_t _foldCycles;				///< value of the cycle counter at the previous clock change
+static uint32_t _changeFrequency;			///< frequency of the core before current change of the clock
+static uint32_t _milestones_us[BOOTTIME_MILESTONES];	///< time of milestones from reset, 0 - not reached yet
+
+/// names of milestones printed by boottimePrint()
+static const char* const _milestoneNames[] = {"main", "early init", "clock", "first sample"};
+
+static_assert(sizeof(_milestoneNames) / sizeof(_milestoneNames[0]) == BOOTTIME_MILESTONES,
+		"_milestoneNames doesn't match enum BoottimeMilestone!");
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Starts DWT cycle counter from zero. Doesn't use any variables, so it may be called before .data and .bss are
+ * 			initialized.
+ */
+void boottimeStart(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * \brief	Registers for changes of the system clock and marks BOOTTIME_MAIN. Should be called first in main(), before
+ * 			the clock is changed.
+ */
+void boottimeInitialize(void)
+{
+	rccRegisterClockCallbacks(_clockPreChange, _clockPostChange);
+	boottimeMark(BOOTTIME_MAIN);
+}
+
+/**
+ * \brief	Marks a milestone of the boot sequence. Only the first call for each milestone is recorded, so it may be
+ * 			called from every place which reaches the milestone. Can be used in interrupts.
+ *
+ * \param [in] milestone is the reached milestone
+ */
+void boottimeMark(enum BoottimeMilestone milestone)
+{
+	if(_milestones_us[milestone] != 0)
+		return;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if(_milestones_us[milestone] == 0)
+		_milestones_us[milestone] = _now(rccGetCoreFrequency());
+
+	__set_PRIMASK(primask);
+}
+
+/**
+ * \brief	Reads time of a milestone.
+ *
+ * \param [in] milestone is the milestone
+ * \param [out] time_us is the time from reset to the milestone, in us
+ *
+ * \return	true if the milestone was reached, false otherwise
+ */
+bool boottimeGet(enum BoottimeMilestone milestone, uint32_t* time_us)
+{
+	*time_us = _milestones_us[milestone];
+
+	return *time_us != 0;
+}
+
+/**
+ * \brief	Prints time of milestones as a table, to be used as the output of a command.
+ *
+ * \param [out] buffer is the buffer for the string
+ * \param [in] size is the size of the buffer, lines which don't fit are skipped
+ *
+ * \return	length of the string, without trailing '\0'
+ */
+size_t boottimePrint(char* buffer, size_t size)
+{
+	char line[40];
+	size_t length = 0;
+
+	if(size == 0)
+		return 0;
+
+	buffer[0] = '\0';
+
+	for(size_t i = 0; i < BOOTTIME_MILESTONES; i++)
+	{
+		uint32_t time_us;
+
+		if(boottimeGet((enum BoottimeMilestone)i, &time_us) == true)
+			sprintf(line, "%-12s %10u us\r\n", _milestoneNames[i], (unsigned int)time_us);
+		else
+			sprintf(line, "%-12s not reached\r\n", _milestoneNames[i]);
+
+		size_t line_length = strlen(line);
+
+		if(length + line_length >= size)
+			break;
+
+		memcpy(&buffer[length], line, line_length + 1);
+		length += line_length;
+	}
+
+	return length;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Calculates time from reset. Must be called with interrupts disabled.
+ *
+ * \param [in] frequency is the frequency of the core since the last fold, in Hz
+ *
+ * \return	time from reset in us, never 0
+ */
+static uint32_t _now(uint32_t frequency)
+{
+	uint32_t time_us = _elapsed_us + ((uint64_t)(DWT->CYCCNT - _foldCycles) * 1000000) / frequency;
+
+	return time_us != 0 ? time_us : 1;
+}
+
+/**
+ * \brief	Folds counted cycles into _elapsed_us and starts counting from current value of the counter.
+ *
+ * \param [in] frequency is the frequency of the core since the last fold, in Hz
+ */
+static void _fold(uint32_t frequency)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	uint32_t cycles = DWT->CYCCNT;
+
+	_elapsed_us += ((uint64_t)(cycles - _foldCycles) * 1000000) / frequency;
+	_foldCycles = cycles;
+
+	__set_PRIMASK(primask);
+}
+
+/**
+ * \brief	Folds cycles counted with the old frequency.
+ */
+static void _clockPreChange(uint32_t frequency)
+{
+	(void) frequency;						// suppress warning
+
+	_changeFrequency = rccGetCoreFrequency();
+	_fold(_changeFrequency);
+}
+
+/**
+ * \brief	Folds cycles of the change, they are mostly spent with the old frequency.
+ */
+static void _clockPostChange(uint32_t frequency)
+{
+	(void) frequency;						// suppress warning
+
+	_fold(_changeFrequency);
+}
@@ -0,0 +1,49 @@
+/*
+ * boottime.h
+ */
+
+#ifndef BOOTTIME_H_
+#define BOOTTIME_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// points of the boot sequence measured from reset
+enum BoottimeMilestone
+{
+	BOOTTIME_MAIN,							///< main() entered, memory initialized
+	BOOTTIME_EARLY_INIT,					///< drivers initialized with MSI
+	BOOTTIME_CLOCK,							///< system clock switched to RCC_CLOCK_PLL32
+	BOOTTIME_FIRST_SAMPLE,					///< first sample acquired
+
+	BOOTTIME_MILESTONES						///< number of milestones
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions' prototypes
++---------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void boottimeStart(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+void boottimeInitialize(void);
+
+void boottimeMark(enum BoottimeMilestone milestone);
+
+bool boottimeGet(enum BoottimeMilestone milestone, uint32_t* time_us);
+
+size_t boottimePrint(char* buffer, size_t size);
+
+#endif /* BOOTTIME_H_ */
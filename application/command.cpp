@@ -0,0 +1,273 @@
+/*
+ * command.cpp
+ *
+ * Commands of the console. The first word of the input selects the handler from the table, the handler writes its
+ * output to the buffer.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include "config.h"
+
+#include "FreeRTOS.h"
+
+#include "boottime.h"
+#include "cpuload.h"
+#include "governor.h"
+#include "pools.h"
+#include "stackmon.h"
+#include "usart.h"
+#include "trace.h"
+
+#include "command.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// command of the console
+struct _Command {
+	const char* name;						///< name of the command, the first word of input
+	const char* help;						///< description printed by "help"
+	enum Error (*handler)(char* output, size_t size);	///< handler of the command
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static enum Error _help(char* output, size_t size);
+static enum Error _boot(char* output, size_t size);
+static enum Error _governor(char* output, size_t size);
+static enum Error _heap(char* output, size_t size);
+static enum Error _load(char* output, size_t size);
+static enum Error _stack(char* output, size_t size);
+static enum Error _trace(char* output, size_t size);
+static bool _traceWrite(const char* line);
+static bool _append(char* buffer, size_t size, size_t* length, const char* line);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+static const struct _Command _commands[] =
+{
+		{"help", "prints this list", _help},
+		{"boot", "prints time of boot milestones from reset", _boot},
+		{"governor", "prints clock governor statistics and decisions", _governor},
+		{"heap", "prints heap and pool statistics", _heap},
+		{"load", "prints CPU load of tasks and ISRs", _load},
+		{"stack", "prints stack usage of tasks and ISRs", _stack},
+		{"trace", "dumps recorded kernel events, see tools/trace", _trace},
+};
+
+static enum Error _traceError;				///< error of the last line of trace dump
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Executes a command.
+ *
+ * \param [in] input is the input line, terminated with "\r\n" and '\0'
+ * \param [out] output is the buffer for the output string
+ * \param [in] size is the size of the output buffer
+ *
+ * \return	ERROR_NONE if successful, ERROR_COMMAND_NOT_FOUND if the command is unknown, otherwise an error code of the
+ * handler
+ */
+enum Error commandProcessInput(const char* input, char* output, size_t size)
+{
+	char name[COMMAND_ARGUMENT_LENGTH];
+	size_t length = strcspn(input, " \r\n");
+
+	if(size == 0)
+		return ERROR_BUFFER_OVERFLOW;
+
+	output[0] = '\0';
+
+	if(length == 0)							// empty line
+		return ERROR_NONE;
+
+	if(length >= sizeof(name))
+		return ERROR_COMMAND_NOT_FOUND;
+
+	memcpy(name, input, length);
+	name[length] = '\0';
+
+	for(size_t i = 0; i < sizeof(_commands) / sizeof(_commands[0]); i++)
+		if(strcmp(name, _commands[i].name) == 0)
+			return _commands[i].handler(output, size);
+
+	return ERROR_COMMAND_NOT_FOUND;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Handler of "help" - prints the list of commands.
+ */
+static enum Error _help(char* output, size_t size)
+{
+	size_t length = 0;
+
+	for(size_t i = 0; i < sizeof(_commands) / sizeof(_commands[0]); i++)
+	{
+		size_t name_length = strlen(_commands[i].name);
+		size_t help_length = strlen(_commands[i].help);
+
+		if(length + name_length + help_length + 5 >= size)	// " - " and "\r\n"
+			return ERROR_BUFFER_OVERFLOW;
+
+		memcpy(&output[length], _commands[i].name, name_length);
+		length += name_length;
+		memcpy(&output[length], " - ", 3);
+		length += 3;
+		memcpy(&output[length], _commands[i].help, help_length);
+		length += help_length;
+		memcpy(&output[length], "\r\n", 3);
+		length += 2;
+	}
+
+	return ERROR_NONE;
+}
+
+/**
+ * \brief	Handler of "boot" - prints time of boot milestones.
+ */
+static enum Error _boot(char* output, size_t size)
+{
+	boottimePrint(output, size);
+
+	return ERROR_NONE;
+}
+
+/**
+ * \brief	Handler of "governor" - prints statistics and decisions of the clock governor.
+ */
+static enum Error _governor(char* output, size_t size)
+{
+	governorPrint(output, size);
+
+	return ERROR_NONE;
+}
+
+/**
+ * \brief	Handler of "heap" - prints statistics of the heap, with configHEAP_CALL_SITE_STATS also live allocations of
+ * 			each caller of pvPortMalloc(), then statistics of the pools.
+ */
+static enum Error _heap(char* output, size_t size)
+{
+	xHeapStats stats;
+	char line[64];
+	size_t length = 0;
+
+	vPortGetHeapStats(&stats);
+
+	size_t fragmentation = stats.xAvailableHeapSpaceInBytes != 0 ?
+			100 - (stats.xSizeOfLargestFreeBlockInBytes * 100) / stats.xAvailableHeapSpaceInBytes : 0;
+
+	sprintf(line, "heap %u B free, %u B min, %u B largest (%u%% frag)\r\n",
+			(unsigned int)stats.xAvailableHeapSpaceInBytes, (unsigned int)stats.xMinimumEverFreeBytesRemaining,
+			(unsigned int)stats.xSizeOfLargestFreeBlockInBytes, (unsigned int)fragmentation);
+	_append(output, size, &length, line);
+
+	sprintf(line, "%u allocations, %u frees, %u failed\r\n", (unsigned int)stats.xNumberOfSuccessfulAllocations,
+			(unsigned int)stats.xNumberOfSuccessfulFrees, (unsigned int)stats.xNumberOfFailedAllocations);
+	_append(output, size, &length, line);
+
+#if configHEAP_CALL_SITE_STATS == 1
+
+	static xHeapCallSite sites[configHEAP_CALL_SITES];	// too big for the stack of the caller
+	unsigned portBASE_TYPE count = uxPortGetHeapCallSites(sites, configHEAP_CALL_SITES);
+
+	for(unsigned portBASE_TYPE i = 0; i < count; i++)
+	{
+		sprintf(line, "caller %08x %3u blocks %5u B, peak %5u B\r\n", (unsigned int)sites[i].pvSite,
+				(unsigned int)sites[i].uxLiveBlocks, (unsigned int)sites[i].xLiveBytes,
+				(unsigned int)sites[i].xPeakBytes);
+		if(_append(output, size, &length, line) == false)
+			break;
+	}
+
+#endif
+
+	poolsPrint(&output[length], size - length);	// _append() leaves room for '\0'
+
+	return ERROR_NONE;
+}
+
+/**
+ * \brief	Handler of "load" - prints the last CPU load snapshot.
+ */
+static enum Error _load(char* output, size_t size)
+{
+	cpuloadPrint(output, size);
+
+	return ERROR_NONE;
+}
+
+/**
+ * \brief	Handler of "stack" - prints stack usage.
+ */
+static enum Error _stack(char* output, size_t size)
+{
+	stackmonPrint(output, size);
+
+	return ERROR_NONE;
+}
+
+/**
+ * \brief	Handler of "trace" - dumps the trace recorder directly to USART, the dump is too big for the output buffer.
+ */
+static enum Error _trace(char* output, size_t size)
+{
+	(void) output;							// suppress warning
+	(void) size;							// suppress warning
+
+	_traceError = ERROR_NONE;
+	traceDump(_traceWrite);
+
+	return _traceError;
+}
+
+/**
+ * \brief	Writer of trace dump lines.
+ *
+ * \param [in] line is the line to send
+ *
+ * \return	true if the line was queued, false if it wasn't (the error is kept in _traceError)
+ */
+static bool _traceWrite(const char* line)
+{
+	_traceError = usartSendString(line, portMAX_DELAY);
+
+	return _traceError == ERROR_NONE;
+}
+
+/**
+ * \brief	Appends a line to the buffer if it fits.
+ *
+ * \param [in,out] buffer is the buffer for the string
+ * \param [in] size is the size of the buffer
+ * \param [in,out] length is the length of the string in the buffer
+ * \param [in] line is the line to append
+ *
+ * \return	true if the line was appended, false if it doesn't fit
+ */
+static bool _append(char* buffer, size_t size, size_t* length, const char* line)
+{
+	size_t line_length = strlen(line);
+
+	if(*length + line_length >= size)
+		return false;
+
+	memcpy(&buffer[*length], line, line_length + 1);
+	*length += line_length;
+
+	return true;
+}
@@ -0,0 +1,18 @@
+/*
+ * command.h
+ */
+
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+#include <stddef.h>
+
+#include "error.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions' prototypes
++---------------------------------------------------------------------------------------------------------------------*/
+
+enum Error commandProcessInput(const char* input, char* output, size_t size);
+
+#endif /* COMMAND_H_ */
@@ -0,0 +1,315 @@
+/*
+ * cpuload.cpp
+ *
+ * Periodic snapshots of CPU load per task and per group of ISRs. Every CPULOAD_PERIOD_ms a software timer samples
+ * run-time counters of all tasks (uxTaskGetSystemState()) and ISR groups (runtime.h) and stores their deltas as load.
+ *
+ * Snapshots are taken only while somebody reads them - the first read starts the timer and ISR accounting, both are
+ * stopped after CPULOAD_IDLE_PERIODS periods without reads. The first snapshot is ready two periods after the start
+ * (the first sample is the baseline).
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include "config.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+#include "runtime.h"
+
+#include "cpuload.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// previous sample of a task
+struct _TaskSample {
+	unsigned portBASE_TYPE number;			///< unique number of the task
+	unsigned long runTime;					///< run-time counter of the task
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static void _timerCallback(xTimerHandle timer);
+static void _publish(unsigned portBASE_TYPE count, uint32_t period, const uint32_t* isr_counters);
+static uint32_t _previousRunTime(unsigned portBASE_TYPE number);
+static uint16_t _permille(uint32_t delta, uint32_t period);
+static bool _append(char* buffer, size_t size, size_t* length, const char* line);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+static xTimerHandle _timer;
+static xStaticTimer _timerBuffer;
+
+static bool _running;						///< timer and ISR accounting are started
+static uint8_t _idlePeriods;				///< periods since the last read
+
+static xTaskStatusType _status[CPULOAD_MAX_TASKS];	///< current sample of tasks, used only by the timer callback
+static struct _TaskSample _previous[CPULOAD_MAX_TASKS];	///< previous sample of tasks
+static unsigned portBASE_TYPE _previousCount;	///< number of valid entries in _previous
+static unsigned long _previousTotal;		///< previous sample of the run-time counter
+static uint32_t _previousIsr[RUNTIME_ISR_GROUP_COUNT];	///< previous sample of ISR groups
+static bool _baselineValid;					///< previous sample is valid
+
+static struct CpuloadSnapshot _snapshot;	///< last snapshot
+static bool _snapshotValid;					///< _snapshot is from current run of the timer
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Creates the snapshot timer. It is started by the first read.
+ *
+ * \return	ERROR_NONE if successful, otherwise an error code defined in the file error.h
+ */
+enum Error cpuloadInitialize(void)
+{
+	_timer = xTimerCreateStatic((const signed char*)"CPULOAD", CPULOAD_PERIOD_ms / portTICK_RATE_MS, pdTRUE, NULL,
+			_timerCallback, &_timerBuffer);
+
+	return errorConvert_portBASE_TYPE(_timer != NULL ? pdPASS : pdFAIL);
+}
+
+/**
+ * \brief	Copies the last snapshot. Starts snapshots if they are stopped.
+ *
+ * \param [out] snapshot is the buffer for the snapshot
+ *
+ * \return	true if the snapshot was copied, false if snapshots were stopped (or are just started) and there is none yet
+ */
+bool cpuloadGetSnapshot(struct CpuloadSnapshot* snapshot)
+{
+	taskENTER_CRITICAL();
+
+	_idlePeriods = 0;
+
+	bool start = _running == false;
+
+	if(start == true)
+	{
+		_running = true;
+		_snapshotValid = false;
+		runtimeEnableIsrAccounting(true);
+	}
+
+	taskEXIT_CRITICAL();
+
+	if(start == true)
+	{
+		if(xTimerStart(_timer, 0) != pdPASS)	// timer queue full? next read will try again
+		{
+			taskENTER_CRITICAL();
+			_running = false;
+			runtimeEnableIsrAccounting(false);
+			taskEXIT_CRITICAL();
+		}
+
+		return false;
+	}
+
+	vTaskSuspendAll();
+
+	bool valid = _snapshotValid;
+
+	if(valid == true)
+		*snapshot = _snapshot;
+
+	xTaskResumeAll();
+
+	return valid;
+}
+
+/**
+ * \brief	Prints the last snapshot as a table, to be used as the output of a command. Not reentrant.
+ *
+ * \param [out] buffer is the buffer for the string
+ * \param [in] size is the size of the buffer, lines which don't fit are skipped
+ *
+ * \return	length of the string, without trailing '\0'
+ */
+size_t cpuloadPrint(char* buffer, size_t size)
+{
+	static struct CpuloadSnapshot snapshot;	// too big for the stack of the caller
+	char line[48];
+	size_t length = 0;
+
+	if(size == 0)
+		return 0;
+
+	buffer[0] = '\0';
+
+	if(cpuloadGetSnapshot(&snapshot) == false)
+	{
+		sprintf(line, "CPU load is being measured, repeat in %u ms\r\n", 2 * CPULOAD_PERIOD_ms);
+		_append(buffer, size, &length, line);
+		return length;
+	}
+
+	sprintf(line, "CPU load in %u ms:\r\n", (unsigned int)((snapshot.period * 1000ULL) / RUNTIME_FREQUENCY));
+	_append(buffer, size, &length, line);
+
+	for(size_t i = 0; i < snapshot.taskCount; i++)
+	{
+		const struct CpuloadTask *task = &snapshot.tasks[i];
+
+		sprintf(line, "%-12s %2u %3u.%u%%\r\n", task->name, task->priority, task->loadPermille / 10,
+				task->loadPermille % 10);
+		if(_append(buffer, size, &length, line) == false)
+			return length;
+	}
+
+	for(size_t group = 0; group < RUNTIME_ISR_GROUP_COUNT; group++)
+	{
+		sprintf(line, "ISR %-8s    %3u.%u%%\r\n", runtimeGetIsrGroupName((enum RuntimeIsrGroup)group),
+				snapshot.isrPermille[group] / 10, snapshot.isrPermille[group] % 10);
+		if(_append(buffer, size, &length, line) == false)
+			return length;
+	}
+
+	return length;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Snapshot timer callback - samples run-time counters, publishes the snapshot and stops the timer when nobody
+ * reads snapshots.
+ */
+static void _timerCallback(xTimerHandle timer)
+{
+	unsigned long total;
+	unsigned portBASE_TYPE count = uxTaskGetSystemState(_status, CPULOAD_MAX_TASKS, &total);
+	uint32_t isr_counters[RUNTIME_ISR_GROUP_COUNT];
+
+	for(size_t group = 0; group < RUNTIME_ISR_GROUP_COUNT; group++)
+		isr_counters[group] = runtimeGetIsrCounter((enum RuntimeIsrGroup)group);
+
+	if(_baselineValid == true && total != _previousTotal)
+		_publish(count, total - _previousTotal, isr_counters);
+
+	for(unsigned portBASE_TYPE i = 0; i < count; i++)
+	{
+		_previous[i].number = _status[i].xTaskNumber;
+		_previous[i].runTime = _status[i].ulRunTimeCounter;
+	}
+
+	_previousCount = count;
+	_previousTotal = total;
+	memcpy(_previousIsr, isr_counters, sizeof(_previousIsr));
+	_baselineValid = true;
+
+	taskENTER_CRITICAL();
+
+	bool stop = ++_idlePeriods >= CPULOAD_IDLE_PERIODS;
+
+	if(stop == true)
+	{
+		_running = false;
+		_baselineValid = false;
+		runtimeEnableIsrAccounting(false);
+	}
+
+	taskEXIT_CRITICAL();
+
+	if(stop == true)
+		xTimerStop(timer, 0);
+}
+
+/**
+ * \brief	Computes the snapshot from current and previous samples.
+ *
+ * \param [in] count is the number of valid entries in _status
+ * \param [in] period is the delta of the run-time counter
+ * \param [in] isr_counters are current samples of ISR groups
+ */
+static void _publish(unsigned portBASE_TYPE count, uint32_t period, const uint32_t* isr_counters)
+{
+	vTaskSuspendAll();
+
+	_snapshot.tick = xTaskGetTickCount();
+	_snapshot.period = period;
+	_snapshot.taskCount = count;
+
+	for(unsigned portBASE_TYPE i = 0; i < count; i++)
+	{
+		struct CpuloadTask *task = &_snapshot.tasks[i];
+
+		strncpy(task->name, (const char*)_status[i].pcTaskName, sizeof(task->name) - 1);
+		task->name[sizeof(task->name) - 1] = '\0';
+		task->priority = _status[i].uxCurrentPriority;
+		task->loadPermille = _permille(_status[i].ulRunTimeCounter - _previousRunTime(_status[i].xTaskNumber), period);
+	}
+
+	for(size_t group = 0; group < RUNTIME_ISR_GROUP_COUNT; group++)
+		_snapshot.isrPermille[group] = _permille(isr_counters[group] - _previousIsr[group], period);
+
+	_snapshotValid = true;
+
+	xTaskResumeAll();
+}
+
+/**
+ * \brief	Finds the previous sample of a task.
+ *
+ * \param [in] number is the unique number of the task
+ *
+ * \return	previous run-time counter of the task, 0 for tasks created in this period
+ */
+static uint32_t _previousRunTime(unsigned portBASE_TYPE number)
+{
+	for(unsigned portBASE_TYPE i = 0; i < _previousCount; i++)
+		if(_previous[i].number == number)
+			return _previous[i].runTime;
+
+	return 0;
+}
+
+/**
+ * \brief	Converts a delta of run time to load.
+ *
+ * \param [in] delta is the delta of run time
+ * \param [in] period is the delta of the run-time counter, not 0
+ *
+ * \return	load, in 0.1%
+ */
+static uint16_t _permille(uint32_t delta, uint32_t period)
+{
+	if(delta > period)						// counters are sampled with small skew
+		delta = period;
+
+	return ((uint64_t)delta * 1000 + period / 2) / period;
+}
+
+/**
+ * \brief	Appends a line to the buffer if it fits.
+ *
+ * \param [in,out] buffer is the buffer for the string
+ * \param [in] size is the size of the buffer
+ * \param [in,out] length is the length of the string in the buffer
+ * \param [in] line is the line to append
+ *
+ * \return	true if the line was appended, false if it doesn't fit
+ */
+static bool _append(char* buffer, size_t size, size_t* length, const char* line)
+{
+	size_t line_length = strlen(line);
+
+	if(*length + line_length >= size)
+		return false;
+
+	memcpy(&buffer[*length], line, line_length + 1);
+	*length += line_length;
+
+	return true;
+}
@@ -0,0 +1,50 @@
+/*
+ * cpuload.h
+ */
+
+#ifndef CPULOAD_H_
+#define CPULOAD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+
+#include "config.h"
+#include "error.h"
+#include "runtime.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// load of one task in a snapshot
+struct CpuloadTask
+{
+	char name[configMAX_TASK_NAME_LEN];		///< name of the task
+	uint8_t priority;						///< priority of the task, including inherited one
+	uint16_t loadPermille;					///< run time of the task in the period, in 0.1%
+};
+
+/// CPU load in one period
+struct CpuloadSnapshot
+{
+	portTickType tick;						///< time of the snapshot, in ticks
+	uint32_t period;						///< length of the period, in 1 / RUNTIME_FREQUENCY s
+	size_t taskCount;						///< number of valid entries in tasks
+	struct CpuloadTask tasks[CPULOAD_MAX_TASKS];	///< tasks, in order of FreeRTOS lists
+	uint16_t isrPermille[RUNTIME_ISR_GROUP_COUNT];	///< run time of groups of ISRs in the period, in 0.1%
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions' prototypes
++---------------------------------------------------------------------------------------------------------------------*/
+
+enum Error cpuloadInitialize(void);
+
+bool cpuloadGetSnapshot(struct CpuloadSnapshot* snapshot);
+
+size_t cpuloadPrint(char* buffer, size_t size);
+
+#endif /* CPULOAD_H_ */
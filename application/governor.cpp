@@ -0,0 +1,402 @@
+/*
+ * governor.cpp
+ *
+ * Load-driven clock governor. Every GOVERNOR_PERIOD_ms the task samples run time of the idle task from FreeRTOS
+ * run-time statistics and fill of acquisition queues, and selects the slowest clock which keeps the load below
+ * GOVERNOR_TARGET_LOAD_percent. The clock is raised at once, but lowered only after GOVERNOR_DOWN_PERIODS periods of
+ * low load. Clock is never selected below rccGetClockFloor() (e.g. USB needs PLL32 while connected), a floor taken by
+ * a driver raises the clock in the next period. Decisions are logged and charge used by the core is estimated from
+ * typical currents of each clock. Statistics and the log are printed by the "governor" command of the console.
+ *
+ * Run-time counter (portGET_RUN_TIME_COUNTER_VALUE(), TIM6 from runtime.cpp) must not depend on core frequency. If it
+ * doesn't run, the governor keeps current clock.
+ *
+ * Watched queues are created by tasks of the acquisition pipeline (BLE sender, flash saver), which are not part of this
+ * firmware yet. Until they are, queue fill is always 0 and the clock follows the load only.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include "config.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#include "task_communication.h"
+
+#include "governor.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// queue watched by the governor
+struct _WatchedQueue {
+	xQueueHandle *queue;					///< pointer to the handle, the queue may be created after the governor
+	uint8_t length;							///< length of the queue given at creation
+};
+
+/// typical currents of the core with a clock, in uA
+struct _ClockCurrent {
+	uint16_t run;							///< current in run mode
+	uint16_t sleep;							///< current in sleep mode (idle task)
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static void _governorTask(void *parameters);
+static uint8_t _queueFill(void);
+static enum rccClock _select(uint32_t load_permille, enum rccClock clock, uint8_t queue_fill);
+static void _account(enum rccClock clock, uint32_t load_permille);
+static void _log(uint32_t load_permille, uint8_t queue_fill, enum rccClock from, enum rccClock to);
+static bool _append(char* buffer, size_t size, size_t* length, const char* line);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// queues of acquisition pipeline, fill above GOVERNOR_QUEUE_HIGH_percent means deadlines are at risk
+static const struct _WatchedQueue _watchedQueues[] =
+{
+		{&commonDataQueue, COMMON_DATA_QUEUE_LENGTH},
+		{&dataSenderBLEQueue, DATA_SENDER_BLE_QUEUE_LENGTH},
+		{&dataSaverFLASHQueue, DATA_SAVER_FLASH_QUEUE},
+};
+
+/// typical currents (STM32L152 datasheet, VDD 3V, code in flash, rounded) indexed with enum rccClock, they are used
+/// only to compare decisions
+static const struct _ClockCurrent _currents[] =
+{
+		{40, 15}, {60, 20}, {100, 27}, {170, 40}, {300, 60}, {560, 110}, {1000, 200},	// MSI
+		{3400, 700},						// HSI16
+		{8000, 1800},						// PLL32
+};
+
+static_assert(sizeof(_currents) / sizeof(_currents[0]) == RCC_CLOCK_PLL32 + 1, "_currents doesn't match enum rccClock!");
+
+static struct GovernorStatistics _statistics;
+static struct GovernorDecision _decisions[GOVERNOR_LOG_LENGTH];	///< ring buffer of last decisions
+static size_t _decisionsNext;				///< index of the next entry in _decisions
+static size_t _decisionsCount;				///< number of valid entries in _decisions
+
+static xStaticTask _governorTaskBuffer;
+static portSTACK_TYPE _governorTaskStack[GOVERNOR_STACK_SIZE];
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Creates the governor task. The task starts to change the clock after the scheduler is started.
+ *
+ * \return	ERROR_NONE if successful, otherwise an error code defined in the file error.h
+ */
+enum Error governorInitialize(void)
+{
+	portBASE_TYPE ret = xTaskCreateStatic(_governorTask, (signed char*)"GOVERNOR", GOVERNOR_STACK_SIZE, NULL,
+			GOVERNOR_TASK_PRIORITY, NULL, _governorTaskStack, &_governorTaskBuffer);
+
+	return errorConvert_portBASE_TYPE(ret);
+}
+
+/**
+ * \brief	Copies logged decisions, from the oldest one.
+ *
+ * \param [out] decisions is the buffer for decisions
+ * \param [in] count is the number of elements in the buffer
+ *
+ * \return	number of copied decisions
+ */
+size_t governorGetLog(struct GovernorDecision* decisions, size_t count)
+{
+	taskENTER_CRITICAL();
+
+	if(count > _decisionsCount)
+		count = _decisionsCount;
+
+	size_t index = (_decisionsNext + GOVERNOR_LOG_LENGTH - _decisionsCount) % GOVERNOR_LOG_LENGTH;
+
+	for(size_t i = 0; i < count; i++)
+	{
+		decisions[i] = _decisions[index];
+		index = (index + 1) % GOVERNOR_LOG_LENGTH;
+	}
+
+	taskEXIT_CRITICAL();
+
+	return count;
+}
+
+/**
+ * \brief	Copies statistics of the governor.
+ *
+ * \param [out] statistics is the buffer for statistics
+ */
+void governorGetStatistics(struct GovernorStatistics* statistics)
+{
+	taskENTER_CRITICAL();
+	*statistics = _statistics;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * \brief	Prints statistics and logged decisions, the newest first, to be used as the output of a command. Not
+ * 			reentrant.
+ *
+ * \param [out] buffer is the buffer for the string
+ * \param [in] size is the size of the buffer, lines which don't fit are skipped
+ *
+ * \return	length of the string, without trailing '\0'
+ */
+size_t governorPrint(char* buffer, size_t size)
+{
+	static struct GovernorDecision decisions[GOVERNOR_LOG_LENGTH];	// too big for the stack of the caller
+	struct GovernorStatistics statistics;
+	char line[64];
+	size_t length = 0;
+
+	if(size == 0)
+		return 0;
+
+	buffer[0] = '\0';
+
+	governorGetStatistics(&statistics);
+
+	sprintf(line, "%u switches, charge %u uAs, %u uAs at max clock\r\n", (unsigned int)statistics.switches,
+			(unsigned int)(statistics.charge_uAms / 1000), (unsigned int)(statistics.chargeAtMax_uAms / 1000));
+	_append(buffer, size, &length, line);
+
+	for(size_t clock = 0; clock <= RCC_CLOCK_PLL32; clock++)
+	{
+		if(statistics.periods[clock] == 0)
+			continue;
+
+		sprintf(line, "%5u kHz %10u periods\r\n", (unsigned int)(rccGetClockFrequency((enum rccClock)clock) / 1000),
+				(unsigned int)statistics.periods[clock]);
+		if(_append(buffer, size, &length, line) == false)
+			return length;
+	}
+
+	size_t count = governorGetLog(decisions, GOVERNOR_LOG_LENGTH);
+
+	_append(buffer, size, &length, "TICK        LOAD QUEUE  FROM ->   TO (kHz)\r\n");
+
+	while(count-- > 0)
+	{
+		const struct GovernorDecision *decision = &decisions[count];
+
+		sprintf(line, "%10u %3u.%u%% %4u%% %5u -> %5u\r\n", (unsigned int)decision->tick,
+				decision->loadPermille / 10, decision->loadPermille % 10, decision->queueFillPercent,
+				(unsigned int)(rccGetClockFrequency((enum rccClock)decision->from) / 1000),
+				(unsigned int)(rccGetClockFrequency((enum rccClock)decision->to) / 1000));
+		if(_append(buffer, size, &length, line) == false)
+			return length;
+	}
+
+	return length;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Governor task - samples the load and changes the clock.
+ */
+static void _governorTask(void *parameters)
+{
+	(void) parameters;						// suppress warning
+
+	xTaskHandle idle_task = xTaskGetIdleTaskHandle();
+	unsigned long last_total = portGET_RUN_TIME_COUNTER_VALUE();
+	unsigned long last_idle = ulTaskGetRunTimeCounter(idle_task);
+	portTickType wake_time = xTaskGetTickCount();
+	uint8_t low_periods = 0;				// consecutive periods in which slower clock was selected
+	enum rccClock low_target = GOVERNOR_MIN_CLOCK;	// fastest clock selected during low_periods
+
+	while(1)
+	{
+		vTaskDelayUntil(&wake_time, GOVERNOR_PERIOD_ms / portTICK_RATE_MS);
+
+		unsigned long total = portGET_RUN_TIME_COUNTER_VALUE();
+		unsigned long idle = ulTaskGetRunTimeCounter(idle_task);
+		unsigned long total_delta = total - last_total;
+		unsigned long idle_delta = idle - last_idle;
+
+		last_total = total;
+		last_idle = idle;
+
+		if(total_delta == 0)				// run-time counter not running?
+			continue;
+
+		if(idle_delta > total_delta)
+			idle_delta = total_delta;
+
+		uint32_t load_permille = ((uint64_t)(total_delta - idle_delta) * 1000) / total_delta;
+		uint8_t queue_fill = _queueFill();
+		enum rccClock clock = rccGetClock();
+		enum rccClock target = _select(load_permille, clock, queue_fill);
+
+		_account(clock, load_permille);
+
+		if(target < clock)					// lower the clock only after GOVERNOR_DOWN_PERIODS of low load
+		{
+			if(low_periods == 0 || target > low_target)
+				low_target = target;
+
+			if(++low_periods < GOVERNOR_DOWN_PERIODS)
+				continue;
+
+			target = low_target;
+		}
+
+		low_periods = 0;
+
+		if(target == clock)
+			continue;
+
+		rccSetClock(target);
+		_log(load_permille, queue_fill, clock, target);
+	}
+}
+
+/**
+ * \brief	Checks fill of watched queues.
+ *
+ * \return	highest fill of created watched queues, in %, 0 if none is created
+ */
+static uint8_t _queueFill(void)
+{
+	uint8_t fill = 0;
+
+	for(size_t i = 0; i < sizeof(_watchedQueues) / sizeof(_watchedQueues[0]); i++)
+	{
+		xQueueHandle queue = *_watchedQueues[i].queue;
+
+		if(queue == NULL)
+			continue;
+
+		uint8_t queue_fill = (uxQueueMessagesWaiting(queue) * 100) / _watchedQueues[i].length;
+
+		if(queue_fill > fill)
+			fill = queue_fill;
+	}
+
+	return fill;
+}
+
+/**
+ * \brief	Selects the slowest clock which keeps the load below GOVERNOR_TARGET_LOAD_percent, not below the clock floor
+ * 			held by drivers.
+ *
+ * \param [in] load_permille is the load measured with current clock, in 0.1%
+ * \param [in] clock is current clock
+ * \param [in] queue_fill is the highest fill of watched queues, in %
+ *
+ * \return	selected clock
+ */
+static enum rccClock _select(uint32_t load_permille, enum rccClock clock, uint8_t queue_fill)
+{
+	if(queue_fill >= GOVERNOR_QUEUE_HIGH_percent)	// backlog is growing - use full speed
+		return GOVERNOR_MAX_CLOCK;
+
+	uint64_t work = (uint64_t)load_permille * rccGetClockFrequency(clock);	// busy cycles per second * 1000
+	enum rccClock floor = rccGetClockFloor();
+
+	if(floor >= GOVERNOR_MAX_CLOCK)
+		return floor;
+
+	for(uint8_t candidate = floor > GOVERNOR_MIN_CLOCK ? floor : GOVERNOR_MIN_CLOCK; candidate < GOVERNOR_MAX_CLOCK;
+			candidate++)
+		if(work <= (uint64_t)rccGetClockFrequency((enum rccClock)candidate) * GOVERNOR_TARGET_LOAD_percent * 10)
+			return (enum rccClock)candidate;
+
+	return GOVERNOR_MAX_CLOCK;
+}
+
+/**
+ * \brief	Updates statistics with one period.
+ *
+ * Charge of the period is estimated from run and sleep currents of the clock. The same work with GOVERNOR_MAX_CLOCK
+ * takes proportionally shorter time.
+ *
+ * \param [in] clock is the clock used in the period
+ * \param [in] load_permille is the load measured in the period, in 0.1%
+ */
+static void _account(enum rccClock clock, uint32_t load_permille)
+{
+	const struct _ClockCurrent *current = &_currents[clock];
+	const struct _ClockCurrent *max_current = &_currents[GOVERNOR_MAX_CLOCK];
+	uint32_t load_at_max_permille = ((uint64_t)load_permille * rccGetClockFrequency(clock)) /
+			rccGetClockFrequency(GOVERNOR_MAX_CLOCK);
+
+	if(load_at_max_permille > 1000)
+		load_at_max_permille = 1000;
+
+	uint64_t charge = ((uint64_t)current->run * load_permille + (uint64_t)current->sleep * (1000 - load_permille)) *
+			GOVERNOR_PERIOD_ms / 1000;
+	uint64_t charge_at_max = ((uint64_t)max_current->run * load_at_max_permille +
+			(uint64_t)max_current->sleep * (1000 - load_at_max_permille)) * GOVERNOR_PERIOD_ms / 1000;
+
+	taskENTER_CRITICAL();
+	_statistics.periods[clock]++;
+	_statistics.charge_uAms += charge;
+	_statistics.chargeAtMax_uAms += charge_at_max;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * \brief	Adds a decision to the log.
+ *
+ * \param [in] load_permille is the load measured with the previous clock, in 0.1%
+ * \param [in] queue_fill is the highest fill of watched queues, in %
+ * \param [in] from is the previous clock
+ * \param [in] to is the selected clock
+ */
+static void _log(uint32_t load_permille, uint8_t queue_fill, enum rccClock from, enum rccClock to)
+{
+	struct GovernorDecision decision;
+
+	decision.tick = xTaskGetTickCount();
+	decision.loadPermille = load_permille;
+	decision.queueFillPercent = queue_fill;
+	decision.from = from;
+	decision.to = to;
+
+	taskENTER_CRITICAL();
+
+	_decisions[_decisionsNext] = decision;
+	_decisionsNext = (_decisionsNext + 1) % GOVERNOR_LOG_LENGTH;
+	if(_decisionsCount < GOVERNOR_LOG_LENGTH)
+		_decisionsCount++;
+	_statistics.switches++;
+
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * \brief	Appends a line to the buffer if it fits.
+ *
+ * \param [in,out] buffer is the buffer for the string
+ * \param [in] size is the size of the buffer
+ * \param [in,out] length is the length of the string in the buffer
+ * \param [in] line is the line to append
+ *
+ * \return	true if the line was appended, false if it doesn't fit
+ */
+static bool _append(char* buffer, size_t size, size_t* length, const char* line)
+{
+	size_t line_length = strlen(line);
+
+	if(*length + line_length >= size)
+		return false;
+
+	memcpy(&buffer[*length], line, line_length + 1);
+	*length += line_length;
+
+	return true;
+}
@@ -0,0 +1,51 @@
+/*
+ * governor.h
+ */
+
+#ifndef GOVERNOR_H_
+#define GOVERNOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+#include "error.h"
+#include "rcc.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// one change of the system clock made by the governor
+struct GovernorDecision
+{
+	portTickType tick;						///< time of the decision, in ticks
+	uint16_t loadPermille;					///< load measured with the previous clock, in 0.1%
+	uint8_t queueFillPercent;				///< highest fill of watched queues, in %
+	uint8_t from;							///< previous clock, enum rccClock
+	uint8_t to;								///< selected clock, enum rccClock
+};
+
+/// statistics of the governor since start
+struct GovernorStatistics
+{
+	uint32_t periods[RCC_CLOCK_PLL32 + 1];	///< number of periods spent with each clock
+	uint32_t switches;						///< number of clock changes
+	uint64_t charge_uAms;					///< estimated charge used by the core, in uA*ms
+	uint64_t chargeAtMax_uAms;				///< estimated charge of the same work with GOVERNOR_MAX_CLOCK, in uA*ms
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions' prototypes
++---------------------------------------------------------------------------------------------------------------------*/
+
+enum Error governorInitialize(void);
+
+size_t governorGetLog(struct GovernorDecision* decisions, size_t count);
+
+void governorGetStatistics(struct GovernorStatistics* statistics);
+
+size_t governorPrint(char* buffer, size_t size);
+
+#endif /* GOVERNOR_H_ */
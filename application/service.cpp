@@ -20,6 +20,8 @@
 // Drivers
 #include "M41T56C64.h"
 
+#include "wallclock.h"
+
 /**
  * \brief	Disabling LCD, enabling UART. Waiting for number 49 '1'. Then downloading actual clock
  * 			from userusing UART, and setting RTC to desired clock. At the end disabling UART,
@@ -48,8 +50,7 @@ void serviceMode()
 	strcpy(string,"Aktualna godzina: ");
 	serialSendString(string);
 
-	M41T56C64_ReadTime(time);
-	M41T56C64_ConvertToInt(time);
+	wallclockGetTime(time);
 	M41T56C64_ConvertToString(time,string);
 	serialSendString(string);
 
@@ -72,6 +73,7 @@ void serviceMode()
 	time[2]=USART1->DR;
 
 	M41T56C64_Init(time);
+	wallclockResync();
 
 	strcpy(string,"\r\nSetting new clock for RTC\r\n");
 	serialSendString(string);
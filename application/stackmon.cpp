@@ -0,0 +1,305 @@
+/*
+ * stackmon.cpp
+ *
+ * Stack monitor. Stacks of tasks are painted by FreeRTOS and the main stack (used by ISRs) by startup code. Every
+ * STACKMON_PERIOD_ms a software timer samples the high water mark of every task and of the main stack and keeps the
+ * lowest free space seen, also for tasks deleted later. The report is printed by the "stack" command, so sizes of
+ * stacks in FreeRTOSConfig.h can be checked against run-time usage (and against the static estimate of
+ * tools/stack_report).
+ *
+ * Overflows are detected by FreeRTOS at context switches (configCHECK_FOR_STACK_OVERFLOW 2). The name of the task is
+ * kept in RAM which is not initialized by startup code and the core is reset, the overflow is reported after reset.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include "stm32l1xx.h"
+
+#include "config.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+#include "stackmon.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local defines
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define _STACK_FILL							0xA5A5A5A5	///< pattern painted on the main stack by startup code
+#define _OVERFLOW_MAGIC						0x53544B4F	///< marks valid _overflow after reset
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// record of a stack overflow, survives reset
+struct _Overflow {
+	uint32_t magic;							///< _OVERFLOW_MAGIC if the record is valid
+	char name[configMAX_TASK_NAME_LEN];		///< name of the task
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static void _timerCallback(xTimerHandle timer);
+static void _sample(void);
+static void _update(const xTaskStatusType* status, uint16_t free);
+static bool _append(char* buffer, size_t size, size_t* length, const char* line);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+extern "C" const uint32_t __main_stack_start[];	// imported from linker script
+extern "C" const uint32_t __main_stack_end[];	// imported from linker script
+
+static xStaticTimer _timerBuffer;
+
+static xTaskStatusType _status[STACKMON_MAX_TASKS];	///< current sample of tasks, used with the scheduler suspended
+static struct StackmonTask _tasks[STACKMON_MAX_TASKS];	///< monitored tasks, in order of the first sample
+static unsigned portBASE_TYPE _numbers[STACKMON_MAX_TASKS];	///< unique numbers of monitored tasks
+static size_t _taskCount;					///< number of valid entries in _tasks
+static bool _tooManyTasks;					///< some tasks were not monitored
+static uint16_t _mainStackFree;				///< lowest free space of the main stack, in words
+
+static struct _Overflow _overflow __attribute__ ((section(".noinit")));
+static char _overflowName[configMAX_TASK_NAME_LEN];	///< task which overflowed its stack before reset, empty if none
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Starts sampling of stacks. Takes the record of stack overflow before reset.
+ *
+ * \return	ERROR_NONE if successful, otherwise an error code defined in the file error.h
+ */
+enum Error stackmonInitialize(void)
+{
+	if(_overflow.magic == _OVERFLOW_MAGIC)
+	{
+		memcpy(_overflowName, _overflow.name, sizeof(_overflowName));
+		_overflowName[sizeof(_overflowName) - 1] = '\0';
+	}
+
+	_overflow.magic = 0;
+
+	xTimerHandle timer = xTimerCreateStatic((const signed char*)"STACKMON", STACKMON_PERIOD_ms / portTICK_RATE_MS,
+			pdTRUE, NULL, _timerCallback, &_timerBuffer);
+
+	return errorConvert_portBASE_TYPE(xTimerStart(timer, 0));
+}
+
+/**
+ * \brief	Samples stacks and copies stack usage of monitored tasks.
+ *
+ * \param [out] tasks is the buffer for tasks
+ * \param [in] count is the number of elements in the buffer
+ *
+ * \return	number of copied tasks
+ */
+size_t stackmonGetReport(struct StackmonTask* tasks, size_t count)
+{
+	vTaskSuspendAll();
+
+	_sample();
+
+	if(count > _taskCount)
+		count = _taskCount;
+
+	memcpy(tasks, _tasks, count * sizeof(*tasks));
+
+	xTaskResumeAll();
+
+	return count;
+}
+
+/**
+ * \brief	Gets the lowest free space of the main stack (used by ISRs) seen by sampling.
+ *
+ * \return	free space of the main stack, in words
+ */
+uint16_t stackmonGetMainStackFree(void)
+{
+	return _mainStackFree;
+}
+
+/**
+ * \brief	Samples stacks and prints stack usage as a table, to be used as the output of a command.
+ *
+ * \param [out] buffer is the buffer for the string
+ * \param [in] size is the size of the buffer, lines which don't fit are skipped
+ *
+ * \return	length of the string, without trailing '\0'
+ */
+size_t stackmonPrint(char* buffer, size_t size)
+{
+	char line[48];
+	size_t length = 0;
+	uint16_t main_size = __main_stack_end - __main_stack_start;
+
+	if(size == 0)
+		return 0;
+
+	buffer[0] = '\0';
+
+	_append(buffer, size, &length, "TASK         SIZE USED FREE (words)\r\n");
+
+	vTaskSuspendAll();						// _tasks is formatted in place, it's too big to be copied to the stack
+
+	_sample();
+
+	for(size_t i = 0; i < _taskCount; i++)
+	{
+		const struct StackmonTask *task = &_tasks[i];
+
+		sprintf(line, "%-12s %4u %4u %4u%s\r\n", task->name, task->size, task->size - task->minFree, task->minFree,
+				task->lowTick != 0 ? " LOW" : "");
+		if(_append(buffer, size, &length, line) == false)
+			break;
+	}
+
+	xTaskResumeAll();
+
+	sprintf(line, "%-12s %4u %4u %4u\r\n", "(ISRs)", main_size, main_size - _mainStackFree, _mainStackFree);
+	_append(buffer, size, &length, line);
+
+	if(_tooManyTasks == true)
+		_append(buffer, size, &length, "some tasks not monitored, raise STACKMON_MAX_TASKS\r\n");
+
+	if(_overflowName[0] != '\0')
+	{
+		sprintf(line, "stack overflow of %s before reset\r\n", _overflowName);
+		_append(buffer, size, &length, line);
+	}
+
+	return length;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Sampling timer callback.
+ */
+static void _timerCallback(xTimerHandle timer)
+{
+	(void) timer;							// suppress warning
+
+	vTaskSuspendAll();
+	_sample();
+	xTaskResumeAll();
+}
+
+/**
+ * \brief	Samples high water marks of all tasks and of the main stack. Has to be called with the scheduler suspended,
+ * so tasks can't be deleted while their stacks are scanned.
+ */
+static void _sample(void)
+{
+	unsigned portBASE_TYPE count = uxTaskGetSystemState(_status, STACKMON_MAX_TASKS, NULL);
+
+	if(count == 0)							// array too small?
+		_tooManyTasks = true;
+
+	for(unsigned portBASE_TYPE i = 0; i < count; i++)
+		_update(&_status[i], uxTaskGetStackHighWaterMark(_status[i].xHandle));
+
+	const uint32_t *word = __main_stack_start;
+
+	while(word < __main_stack_end && *word == _STACK_FILL)
+		word++;
+
+	_mainStackFree = word - __main_stack_start;
+}
+
+/**
+ * \brief	Updates the entry of a task with a sample, adds the entry for new task.
+ *
+ * \param [in] status is the status of the task
+ * \param [in] free is the high water mark of the task, in words
+ */
+static void _update(const xTaskStatusType* status, uint16_t free)
+{
+	size_t i;
+
+	for(i = 0; i < _taskCount; i++)
+		if(_numbers[i] == status->xTaskNumber)
+			break;
+
+	if(i == _taskCount)						// new task?
+	{
+		if(_taskCount == STACKMON_MAX_TASKS)
+		{
+			_tooManyTasks = true;
+			return;
+		}
+
+		struct StackmonTask *task = &_tasks[_taskCount];
+
+		strncpy(task->name, (const char*)status->pcTaskName, sizeof(task->name) - 1);
+		task->name[sizeof(task->name) - 1] = '\0';
+		task->size = status->usStackDepth;
+		task->minFree = free;
+		task->lowTick = 0;
+		_numbers[_taskCount] = status->xTaskNumber;
+		_taskCount++;
+	}
+
+	struct StackmonTask *task = &_tasks[i];
+
+	if(free < task->minFree)
+		task->minFree = free;
+
+	if(task->minFree < STACKMON_LOW_words && task->lowTick == 0)
+		task->lowTick = xTaskGetTickCount() | 1;	// 0 means "never low"
+}
+
+/**
+ * \brief	Appends a line to the buffer if it fits.
+ *
+ * \param [in,out] buffer is the buffer for the string
+ * \param [in] size is the size of the buffer
+ * \param [in,out] length is the length of the string in the buffer
+ * \param [in] line is the line to append
+ *
+ * \return	true if the line was appended, false if it doesn't fit
+ */
+static bool _append(char* buffer, size_t size, size_t* length, const char* line)
+{
+	size_t line_length = strlen(line);
+
+	if(*length + line_length >= size)
+		return false;
+
+	memcpy(&buffer[*length], line, line_length + 1);
+	*length += line_length;
+
+	return true;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| FreeRTOS hooks
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Called by FreeRTOS when stack overflow of the task being switched out is detected. The stack is already
+ * corrupted, so the name of the task is kept for the report and the core is reset.
+ *
+ * \param [in] task is the handle of the task
+ * \param [in] name is the name of the task
+ */
+extern "C" void vApplicationStackOverflowHook(xTaskHandle task, signed char* name)
+{
+	(void) task;							// suppress warning
+
+	strncpy(_overflow.name, (const char*)name, sizeof(_overflow.name));
+	_overflow.magic = _OVERFLOW_MAGIC;
+
+	NVIC_SystemReset();
+}
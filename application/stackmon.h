@@ -0,0 +1,41 @@
+/*
+ * stackmon.h
+ */
+
+#ifndef STACKMON_H_
+#define STACKMON_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+
+#include "config.h"
+#include "error.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// stack usage of one task
+struct StackmonTask
+{
+	char name[configMAX_TASK_NAME_LEN];		///< name of the task
+	uint16_t size;							///< size of the stack, in words
+	uint16_t minFree;						///< lowest free stack seen (high water mark), in words
+	portTickType lowTick;					///< time when minFree dropped below STACKMON_LOW_words, 0 if it didn't
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions' prototypes
++---------------------------------------------------------------------------------------------------------------------*/
+
+enum Error stackmonInitialize(void);
+
+size_t stackmonGetReport(struct StackmonTask* tasks, size_t count);
+
+uint16_t stackmonGetMainStackFree(void);
+
+size_t stackmonPrint(char* buffer, size_t size);
+
+#endif /* STACKMON_H_ */
@@ -0,0 +1,213 @@
+/*
+ * wallclock.cpp
+ *
+ * Wall-clock time cached in RAM. Time is read from M41T56C64 once at start and then counted by 1 Hz interrupt of the
+ * internal RTC, so getting a timestamp is a memory read instead of I2C transaction. Time is read from M41T56C64 again
+ * every CLOCK_RESYNC_PERIOD_s by software timer, which corrects the drift of internal RTC clock. While the internal RTC
+ * runs from inaccurate LSI (LSE was not ready at boot), time is read every CLOCK_RESYNC_LSI_PERIOD_s and the RTC is
+ * moved to LSE as soon as it is ready.
+ */
+
+#include <string.h>
+
+#include "stm32l1xx.h"
+#include "config.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+#include "i2c.h"
+#include "rtc.h"
+#include "wallclock.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static void wallclockTick(void);
+static void wallclockAddSecond(struct M41T56C64_Clock* now);
+static void wallclockResyncCallback(xTimerHandle timer);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+static struct M41T56C64_Clock _now;			///< cached time
+static volatile uint32_t _sequence;			///< incremented before and after each update of _now, odd during update
+static xTimerHandle _resyncTimer;			///< periodic timer reading time from M41T56C64
+static xStaticTimer _resyncTimerBuffer;		///< storage of _resyncTimer
+static bool _resyncOnLsi;					///< RTC runs from LSI, resynchronisation uses the short period
+
+/// number of days in months, February of leap year is handled separately
+static const uint8_t _daysInMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Reads time from M41T56C64 and starts counting it with 1 Hz interrupt of the internal RTC. Periodic
+ * 			resynchronisation with M41T56C64 is started too.
+ *
+ * \return	ERROR_NONE if successful, otherwise an error code defined in the file error.h
+ */
+enum Error wallclockInitialize(void)
+{
+	i2cInitialize();
+
+	M41T56C64_ReadClock(&_now);
+
+	rtcEnableSecondInterrupt(wallclockTick);
+
+	if(_resyncTimer == NULL)
+	{
+		_resyncOnLsi = rtcInitialize() != RTC_LSE_FREQUENCY;
+
+		_resyncTimer = xTimerCreateStatic((const signed char*)"CLOCK",
+				((_resyncOnLsi == true ? CLOCK_RESYNC_LSI_PERIOD_s : CLOCK_RESYNC_PERIOD_s) * 1000) / portTICK_RATE_MS,
+				pdTRUE, NULL, wallclockResyncCallback, &_resyncTimerBuffer);
+	}
+
+	return errorConvert_portBASE_TYPE(xTimerStart(_resyncTimer, 0));
+}
+
+/**
+ * \brief	Reads time from M41T56C64 and replaces cached time. Has to be called from task after M41T56C64 was set.
+ */
+void wallclockResync(void)
+{
+	struct M41T56C64_Clock now;
+
+	M41T56C64_ReadClock(&now);
+
+	taskENTER_CRITICAL();					// RTC interrupt can not update cache at the same time
+	_sequence++;
+	_now = now;
+	_sequence++;
+	taskEXIT_CRITICAL();
+}
+
+/**
+ * \brief	Returns cached time. Copy is repeated if it was interrupted by update, so it must not be called from interrupt
+ * 			of higher priority than RTC_ALARM_IRQ_PRIORITY.
+ *
+ * \param now	Pointer to structure where time will be written
+ */
+void wallclockGet(struct M41T56C64_Clock* now)
+{
+	uint32_t sequence;
+
+	do
+	{
+		sequence = _sequence;
+		memcpy(now, (const void*)&_now, sizeof(*now));
+		__DMB();
+	} while((sequence & 1) != 0 || sequence != _sequence);
+}
+
+/**
+ * \brief	Returns cached hours, minutes and seconds, in the format of M41T56C64_ConvertToString() and LCD_WriteTime().
+ *
+ * \param time	Pointer to table where hours, minutes and seconds will be written
+ */
+void wallclockGetTime(uint8_t* time)
+{
+	struct M41T56C64_Clock now;
+
+	wallclockGet(&now);
+
+	time[0] = now.hours;
+	time[1] = now.minutes;
+	time[2] = now.seconds;
+}
+
+/**
+ * \brief	Returns cached time packed in the format of FatFS get_fattime().
+ *
+ * \return	Bits 31:25 year from 1980, 24:21 month, 20:16 day, 15:11 hours, 10:5 minutes, 4:0 seconds / 2
+ */
+uint32_t wallclockGetFatTime(void)
+{
+	struct M41T56C64_Clock now;
+
+	wallclockGet(&now);
+
+	return ((uint32_t)(now.year + 20) << 25) | ((uint32_t)now.month << 21) | ((uint32_t)now.date << 16) |
+			((uint32_t)now.hours << 11) | ((uint32_t)now.minutes << 5) | ((uint32_t)now.seconds >> 1);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	RTC interrupt callback, adds one second to cached time.
+ */
+static void wallclockTick(void)
+{
+	_sequence++;
+	__DMB();
+
+	wallclockAddSecond(&_now);
+
+	__DMB();
+	_sequence++;
+}
+
+/**
+ * \brief	Adds one second to time. Years are counted from 2000, so every fourth year is a leap year.
+ *
+ * \param now	Pointer to structure with time
+ */
+static void wallclockAddSecond(struct M41T56C64_Clock* now)
+{
+	uint8_t days;
+
+	if(++now->seconds < 60)
+		return;
+	now->seconds = 0;
+
+	if(++now->minutes < 60)
+		return;
+	now->minutes = 0;
+
+	if(++now->hours < 24)
+		return;
+	now->hours = 0;
+
+	if(++now->day > 7)
+		now->day = 1;
+
+	days = (now->month >= 1 && now->month <= 12) ? _daysInMonth[now->month - 1] : 31;
+	if(now->month == 2 && (now->year & 3) == 0)
+		days++;
+
+	if(++now->date <= days)
+		return;
+	now->date = 1;
+
+	if(++now->month <= 12)
+		return;
+	now->month = 1;
+
+	if(++now->year > 99)
+		now->year = 0;
+}
+
+/**
+ * \brief	Resynchronisation timer callback, reads time from M41T56C64 in timer task. While the RTC runs from LSI, it is
+ * 			moved to LSE first, the time read afterwards covers the seconds lost while LSE was restarting.
+ *
+ * \param timer	Handle of expired timer
+ */
+static void wallclockResyncCallback(xTimerHandle timer)
+{
+	if(_resyncOnLsi == true && rtcSwitchToLse() == RTC_LSE_FREQUENCY)
+	{
+		_resyncOnLsi = false;
+		xTimerChangePeriod(timer, (CLOCK_RESYNC_PERIOD_s * 1000) / portTICK_RATE_MS, 0);
+	}
+
+	wallclockResync();
+}
@@ -0,0 +1,28 @@
+/*
+ * wallclock.h
+ */
+
+#ifndef WALLCLOCK_H_
+#define WALLCLOCK_H_
+
+#include <stdint.h>
+
+#include "error.h"
+
+#include "M41T56C64.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions' prototypes
++---------------------------------------------------------------------------------------------------------------------*/
+
+enum Error wallclockInitialize(void);
+
+void wallclockResync(void);
+
+void wallclockGet(struct M41T56C64_Clock* now);
+
+void wallclockGetTime(uint8_t* time);
+
+uint32_t wallclockGetFatTime(void);
+
+#endif /* WALLCLOCK_H_ */
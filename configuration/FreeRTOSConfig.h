@@ -74,7 +74,13 @@
 #include "rcc.h"
 
 // needed for runtimestats
-#include "helper.h"
+#include "runtime.h"
+
+// needed for tickless idle
+#include "power.h"
+
+// needed for trace recorder
+#include "trace.h"
 
 /*-----------------------------------------------------------
  * Application specific definitions.
@@ -91,6 +97,8 @@
 #define configUSE_PREEMPTION			1
 #define configUSE_IDLE_HOOK				0
 #define configUSE_TICK_HOOK				0
+#define configUSE_TICKLESS_IDLE			1
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP	5	/* restart of HSE and PLL after STOP mode takes about 2 ms */
 #define configCPU_CLOCK_HZ				rccGetCoreFrequency()
 #define configTICK_RATE_HZ				( ( portTickType ) 1000 )
 #define configMAX_PRIORITIES			( ( unsigned portBASE_TYPE ) 5 )
@@ -102,10 +110,17 @@
 #define configUSE_MUTEXES				1
 #define configQUEUE_REGISTRY_SIZE		5
 #define configGENERATE_RUN_TIME_STATS	1
-#define configCHECK_FOR_STACK_OVERFLOW	0
+#define configCHECK_FOR_STACK_OVERFLOW	2
 #define configUSE_RECURSIVE_MUTEXES		0
 #define configUSE_MALLOC_FAILED_HOOK	0
 #define configUSE_APPLICATION_TASK_TAG	0
+#define configUSE_TASK_NOTIFICATIONS	1	/* 1 - xTaskNotifyGive(), ulTaskNotifyTake() */
+
+/* Software timer definitions. */
+#define configUSE_TIMERS				1
+#define configTIMER_TASK_PRIORITY		( configMAX_PRIORITIES - 1 )
+#define configTIMER_QUEUE_LENGTH		5
+#define configTIMER_TASK_STACK_DEPTH	( configMINIMAL_STACK_SIZE * 2 )
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		0
@@ -121,6 +136,9 @@ to exclude the API function. */
 #define INCLUDE_vTaskSuspend			1
 #define INCLUDE_vTaskDelayUntil			1
 #define INCLUDE_vTaskDelay				1
+#define INCLUDE_xTaskGetIdleTaskHandle	1
+#define INCLUDE_uxTaskGetStackHighWaterMark	1
+#define INCLUDE_xTaskGetCurrentTaskHandle	1
 
 /* Use the system definition, if there is one */
 #ifdef __NVIC_PRIO_BITS
@@ -147,6 +165,22 @@ See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
 #define xPortPendSVHandler					PendSV_Handler
 #define xPortSysTickHandler					SysTick_Handler
 
+/*---------------------------------------------------------------------------------------------------------------------+
+| Tickless idle
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define portSUPPRESS_TICKS_AND_SLEEP(xExpectedIdleTime)	powerSuppressTicksAndSleep(xExpectedIdleTime)
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| Heap (heap_tlsf.c)
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define configTLSF_SL_INDEX_COUNT_LOG2		3	/* 8 lists per power of two, at most 12.5% lost to rounding */
+#define configTLSF_FL_INDEX_MAX				13	/* blocks up to 16kB */
+#define configHEAP_CALL_SITE_STATS			0	/* 1 - account live allocations per caller of pvPortMalloc() */
+#define configHEAP_CALL_SITES				16
+#define configSUPPORT_STATIC_ALLOCATION		1	/* 1 - ...Static() API, kernel objects of the system are created in .bss */
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | Priorities and stacks for tasks in the system
 +---------------------------------------------------------------------------------------------------------------------*/
@@ -171,12 +205,50 @@ See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
 #define ACC_TASK_PRIORITY					(tskIDLE_PRIORITY + 1)
 #define ACC_TASK_STACK_SIZE					256
 
+// clock governor task, above the workload it measures
+#define GOVERNOR_TASK_PRIORITY				(tskIDLE_PRIORITY + 2)
+#define GOVERNOR_STACK_SIZE					128
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | Runtime stats configuration
 +---------------------------------------------------------------------------------------------------------------------*/
 
-#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	configureTimerForRuntimestats()
-#define portGET_RUN_TIME_COUNTER_VALUE()	((tim6OverflowCount << 16) | TIM6->CNT)
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()	runtimeInitialize()
+#define portGET_RUN_TIME_COUNTER_VALUE()	runtimeGetCounter()
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| Trace recorder (trace.cpp) - object of task events is uxTCBNumber, of queue events ucQueueNumber
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define traceTASK_CREATE(pxNewTCB)			traceAddTask((pxNewTCB)->uxTCBNumber, (const char*)(pxNewTCB)->pcTaskName)
+#define traceTASK_SWITCHED_IN()				traceTaskSwitchedIn(pxCurrentTCB->uxTCBNumber, pxCurrentTCB->uxPriority)
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB)	traceRecord(TRACE_EVENT_TASK_READY, (pxTCB)->uxTCBNumber, (pxTCB)->uxPriority);
+#define traceTASK_DELAY()					traceRecord(TRACE_EVENT_TASK_DELAY, pxCurrentTCB->uxTCBNumber, xTicksToDelay)
+#define traceTASK_DELAY_UNTIL()				traceRecord(TRACE_EVENT_TASK_DELAY_UNTIL, pxCurrentTCB->uxTCBNumber, 0)
+#define traceTASK_SUSPEND(pxTCB)			traceRecord(TRACE_EVENT_TASK_SUSPEND, (pxTCB)->uxTCBNumber, 0)
+#define traceTASK_DELETE(pxTCB)				traceRecord(TRACE_EVENT_TASK_DELETE, (pxTCB)->uxTCBNumber, 0)
+#define traceTASK_PRIORITY_INHERIT(pxTCB, uxPriority)		traceRecord(TRACE_EVENT_PRIORITY_INHERIT, (pxTCB)->uxTCBNumber, uxPriority)
+#define traceTASK_PRIORITY_DISINHERIT(pxTCB, uxPriority)	traceRecord(TRACE_EVENT_PRIORITY_DISINHERIT, (pxTCB)->uxTCBNumber, uxPriority)
+
+#define traceQUEUE_CREATE(pxQueue)			(pxQueue)->ucQueueNumber = traceAddQueue((pxQueue)->ucQueueType)
+#define traceCREATE_MUTEX(pxQueue)			(pxQueue)->ucQueueNumber = traceAddQueue((pxQueue)->ucQueueType)
+#define _TRACE_QUEUE(type, pxQueue)			traceRecord(type, (pxQueue)->ucQueueNumber, (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_SEND(pxQueue)			_TRACE_QUEUE(TRACE_EVENT_QUEUE_SEND, pxQueue)
+#define traceQUEUE_RECEIVE(pxQueue)			_TRACE_QUEUE(TRACE_EVENT_QUEUE_RECEIVE, pxQueue)
+#define traceQUEUE_PEEK(pxQueue)			_TRACE_QUEUE(TRACE_EVENT_QUEUE_PEEK, pxQueue)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)	_TRACE_QUEUE(TRACE_EVENT_QUEUE_SEND_FROM_ISR, pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)	_TRACE_QUEUE(TRACE_EVENT_QUEUE_RECEIVE_FROM_ISR, pxQueue)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)	_TRACE_QUEUE(TRACE_EVENT_QUEUE_BLOCKING_SEND, pxQueue)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)	_TRACE_QUEUE(TRACE_EVENT_QUEUE_BLOCKING_RECEIVE, pxQueue)
+#define traceQUEUE_SEND_FAILED(pxQueue)		_TRACE_QUEUE(TRACE_EVENT_QUEUE_SEND_FAILED, pxQueue)
+#define traceQUEUE_SEND_FROM_ISR_FAILED(pxQueue)	_TRACE_QUEUE(TRACE_EVENT_QUEUE_SEND_FAILED, pxQueue)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue)	_TRACE_QUEUE(TRACE_EVENT_QUEUE_RECEIVE_FAILED, pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR_FAILED(pxQueue)	_TRACE_QUEUE(TRACE_EVENT_QUEUE_RECEIVE_FAILED, pxQueue)
+
+#define traceTASK_NOTIFY_GIVE(pxTCB)		traceRecord(TRACE_EVENT_NOTIFY_GIVE, (pxTCB)->uxTCBNumber, (pxTCB)->ulNotifiedValue)
+#define traceTASK_NOTIFY_GIVE_FROM_ISR(pxTCB)	traceRecord(TRACE_EVENT_NOTIFY_GIVE_FROM_ISR, (pxTCB)->uxTCBNumber, (pxTCB)->ulNotifiedValue)
+#define traceTASK_NOTIFY_TAKE_BLOCK()		traceRecord(TRACE_EVENT_NOTIFY_TAKE_BLOCK, pxCurrentTCB->uxTCBNumber, xTicksToWait)
+#define traceTASK_NOTIFY_TAKE()				traceRecord(TRACE_EVENT_NOTIFY_TAKE, pxCurrentTCB->uxTCBNumber, pxCurrentTCB->ulNotifiedValue)
 
 #endif /* FREERTOS_CONFIG_H */
 
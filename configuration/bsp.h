@@ -17,17 +17,19 @@
 | LEDs INTERFACE
 +---------------------------------------------------------------------------------------------------------------------*/
 
-#define LED_GPIO							GPIOB	///< GPIO port to which the LED is connected
+#define LED_GPIO_BASE						GPIOB_BASE	///< base address of GPIO port to which the LEDs are connected
+#define LED_GPIO							((GPIO_TypeDef *)LED_GPIO_BASE)	///< GPIO port to which the LEDs are connected
 #define LED_pin								GPIO_PIN_6	///< pin number of the LED
 #define LED_pin_1							GPIO_PIN_7	///< pin number of the LED1
 #define LED_pin_2							GPIO_PIN_13	///< pin number of the LED2
 #define LED_pin_3							GPIO_PIN_14	///< pin number of the LED3
 
-/// bit-band "variable" to directly handle the pin
-#define LED_bb								BITBAND(&LED_GPIO->ODR, LED_pin)
-#define LED1_bb								BITBAND(&LED_GPIO->ODR, LED_pin_1)
-#define LED2_bb								BITBAND(&LED_GPIO->ODR, LED_pin_2)
-#define LED3_bb								BITBAND(&LED_GPIO->ODR, LED_pin_3)
+/// typed pins (see Pin in gpio.h) to directly handle the LEDs
+#define LED_Pin								Pin<LED_GPIO_BASE, LED_pin>
+#define LED1_Pin							Pin<LED_GPIO_BASE, LED_pin_1>
+#define LED2_Pin							Pin<LED_GPIO_BASE, LED_pin_2>
+#define LED3_Pin							Pin<LED_GPIO_BASE, LED_pin_3>
+#define LEDS_Pins							PinSet<LED_Pin, LED1_Pin, LED2_Pin, LED3_Pin>	///< all LEDs together
 
 /*---------------------------------------------------------------------------------------------------------------------+
 | BUTTON INTERFACE
@@ -50,63 +52,63 @@
 +---------------------------------------------------------------------------------------------------------------------*/
 
 /// comons
-#define LCD_COM0_GPIO						GPIOA
+#define LCD_COM0_GPIO_BASE					GPIOA_BASE
 #define LCD_COM0_pin						GPIO_PIN_8
-#define LCD_COM1_GPIO						GPIOA
+#define LCD_COM1_GPIO_BASE					GPIOA_BASE
 #define LCD_COM1_pin						GPIO_PIN_9
-#define LCD_COM2_GPIO						GPIOA
+#define LCD_COM2_GPIO_BASE					GPIOA_BASE
 #define LCD_COM2_pin						GPIO_PIN_10
-#define LCD_COM3_GPIO						GPIOB
+#define LCD_COM3_GPIO_BASE					GPIOB_BASE
 #define LCD_COM3_pin						GPIO_PIN_9
 
 /// segments
-#define LCD_SEG0_GPIO						GPIOA
+#define LCD_SEG0_GPIO_BASE					GPIOA_BASE
 #define LCD_SEG0_pin						GPIO_PIN_1
-#define LCD_SEG1_GPIO						GPIOA
+#define LCD_SEG1_GPIO_BASE					GPIOA_BASE
 #define LCD_SEG1_pin						GPIO_PIN_2
-#define LCD_SEG2_GPIO						GPIOA
+#define LCD_SEG2_GPIO_BASE					GPIOA_BASE
 #define LCD_SEG2_pin						GPIO_PIN_3
-#define LCD_SEG3_GPIO						GPIOB
+#define LCD_SEG3_GPIO_BASE					GPIOB_BASE
 #define LCD_SEG3_pin						GPIO_PIN_3
-#define LCD_SEG4_GPIO						GPIOB
+#define LCD_SEG4_GPIO_BASE					GPIOB_BASE
 #define LCD_SEG4_pin						GPIO_PIN_4
-#define LCD_SEG5_GPIO						GPIOB
+#define LCD_SEG5_GPIO_BASE					GPIOB_BASE
 #define LCD_SEG5_pin						GPIO_PIN_5
-#define LCD_SEG6_GPIO						GPIOB
+#define LCD_SEG6_GPIO_BASE					GPIOB_BASE
 #define LCD_SEG6_pin						GPIO_PIN_10
-#define LCD_SEG7_GPIO						GPIOB
+#define LCD_SEG7_GPIO_BASE					GPIOB_BASE
 #define LCD_SEG7_pin						GPIO_PIN_11
-#define LCD_SEG8_GPIO						GPIOB
+#define LCD_SEG8_GPIO_BASE					GPIOB_BASE
 #define LCD_SEG8_pin						GPIO_PIN_12
-#define LCD_SEG9_GPIO						GPIOB
+#define LCD_SEG9_GPIO_BASE					GPIOB_BASE
 #define LCD_SEG9_pin						GPIO_PIN_13
-#define LCD_SEG10_GPIO						GPIOB
+#define LCD_SEG10_GPIO_BASE					GPIOB_BASE
 #define LCD_SEG10_pin						GPIO_PIN_14
-#define LCD_SEG11_GPIO						GPIOB
+#define LCD_SEG11_GPIO_BASE					GPIOB_BASE
 #define LCD_SEG11_pin						GPIO_PIN_15
-#define LCD_SEG12_GPIO						GPIOA
+#define LCD_SEG12_GPIO_BASE					GPIOA_BASE
 #define LCD_SEG12_pin						GPIO_PIN_15
-#define LCD_SEG13_GPIO						GPIOB
+#define LCD_SEG13_GPIO_BASE					GPIOB_BASE
 #define LCD_SEG13_pin						GPIO_PIN_8
-#define LCD_SEG14_GPIO						GPIOC
+#define LCD_SEG14_GPIO_BASE					GPIOC_BASE
 #define LCD_SEG14_pin						GPIO_PIN_0
-#define LCD_SEG15_GPIO						GPIOC
+#define LCD_SEG15_GPIO_BASE					GPIOC_BASE
 #define LCD_SEG15_pin						GPIO_PIN_1
-#define LCD_SEG16_GPIO						GPIOC
+#define LCD_SEG16_GPIO_BASE					GPIOC_BASE
 #define LCD_SEG16_pin						GPIO_PIN_2
-#define LCD_SEG17_GPIO						GPIOC
+#define LCD_SEG17_GPIO_BASE					GPIOC_BASE
 #define LCD_SEG17_pin						GPIO_PIN_3
-#define LCD_SEG18_GPIO						GPIOC
+#define LCD_SEG18_GPIO_BASE					GPIOC_BASE
 #define LCD_SEG18_pin						GPIO_PIN_6
-#define LCD_SEG19_GPIO						GPIOC
+#define LCD_SEG19_GPIO_BASE					GPIOC_BASE
 #define LCD_SEG19_pin						GPIO_PIN_7
-#define LCD_SEG20_GPIO						GPIOC
+#define LCD_SEG20_GPIO_BASE					GPIOC_BASE
 #define LCD_SEG20_pin						GPIO_PIN_8
-#define LCD_SEG21_GPIO						GPIOC
+#define LCD_SEG21_GPIO_BASE					GPIOC_BASE
 #define LCD_SEG21_pin						GPIO_PIN_9
-#define LCD_SEG22_GPIO						GPIOC
+#define LCD_SEG22_GPIO_BASE					GPIOC_BASE
 #define LCD_SEG22_pin						GPIO_PIN_10
-#define LCD_SEG23_GPIO						GPIOC
+#define LCD_SEG23_GPIO_BASE					GPIOC_BASE
 #define LCD_SEG23_pin						GPIO_PIN_11
 
 /// number of digits
@@ -117,9 +119,10 @@
 | SD card
 +---------------------------------------------------------------------------------------------------------------------*/
 
-#define SD_CS_GPIO							GPIOC
+#define SD_CS_GPIO_BASE						GPIOC_BASE
+#define SD_CS_GPIO							((GPIO_TypeDef *)SD_CS_GPIO_BASE)
 #define SD_CS_PIN							GPIO_PIN_12
-#define SD_CS_bb							BITBAND(&SD_CS_GPIO->ODR, SD_CS_PIN)
+#define SD_CS_Pin							Pin<SD_CS_GPIO_BASE, SD_CS_PIN>
 
 #define SD_CS_ASSERTED						0
 #define SD_CS_DEASSERTED					1
@@ -128,5 +131,32 @@
 | ACC
 +---------------------------------------------------------------------------------------------------------------------*/
 
+/// INT_O output of the accelerometer, routed to EXTI line 1
+#define ACC_INT_GPIO						GPIOB
+#define ACC_INT_PIN							GPIO_PIN_1
+#define ACC_INT_CONFIGURATION				GPIO_IN_PULL_UP
+#define ACC_INT_EXTICR						SYSCFG_EXTICR1_EXTI1_PB
+#define ACC_INT_EXTICR_mask					SYSCFG_EXTICR1_EXTI1
+#define ACC_INT_EXTICR_index				0
+#define ACC_INT_EXTI_LINE					EXTI_IMR_MR1
+#define ACC_INT_IRQn						EXTI1_IRQn
+#define ACC_INT_IRQHandler					EXTI1_IRQHandler
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| TEM
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// ALERT output of the MCP980x (open drain, active low), routed to EXTI line 2
+#define TEM_ALERT_GPIO_BASE					GPIOB_BASE
+#define TEM_ALERT_GPIO						((GPIO_TypeDef *)TEM_ALERT_GPIO_BASE)
+#define TEM_ALERT_PIN						GPIO_PIN_2
+#define TEM_ALERT_CONFIGURATION				GPIO_IN_PULL_UP
+#define TEM_ALERT_EXTICR					SYSCFG_EXTICR1_EXTI2_PB
+#define TEM_ALERT_EXTICR_mask				SYSCFG_EXTICR1_EXTI2
+#define TEM_ALERT_EXTICR_index				0
+#define TEM_ALERT_EXTI_LINE					EXTI_IMR_MR2
+#define TEM_ALERT_IRQn						EXTI2_IRQn
+#define TEM_ALERT_IRQHandler				EXTI2_IRQHandler
+#define TEM_ALERT_Pin						Pin<TEM_ALERT_GPIO_BASE, TEM_ALERT_PIN>
 
 #endif //BSP_H_
@@ -19,15 +19,18 @@
 | uC Device
 +---------------------------------------------------------------------------------------------------------------------*/
 
-#define DEVICE_VCORE_mV						1800	///< VCORE voltage, configured via VOS in PWR_CR, in mV
+#define FREQUENCY							32000000	///< frequency of the core with PLL (RCC_CLOCK_PLL32)
 
-#define FREQUENCY							32000000	///< desired target frequency of the core
+#define HSE_FREQUENCY						8000000	///< frequency of HSE crystal, in Hz
 
 #define CLOCK_SOURCE						USING_HSE  ///< describe what is clock source of uC
 
 #define USING_HSI							0
 
 #define USING_HSE							1
+
+#define RCC_CLOCK_CALLBACKS					8	///< max number of drivers notified about changes of core frequency
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | USART
 +---------------------------------------------------------------------------------------------------------------------*/
@@ -41,6 +44,16 @@
 #define USARTx_RX_PIN						GPIO_PIN_10
 #define USARTx_RX_CONFIGURATION				GPIO_AF7_PP_40MHz_PULL_UP
 
+/// start bit on RX pin wakes the core up from STOP mode through EXTI line 10
+#define USARTx_RX_EXTICR					SYSCFG_EXTICR3_EXTI10_PA
+#define USARTx_RX_EXTICR_mask				SYSCFG_EXTICR3_EXTI10
+#define USARTx_RX_EXTICR_index				2
+#define USARTx_RX_EXTI_LINE					EXTI_IMR_MR10
+#define USARTx_RX_EXTI_IRQn					EXTI15_10_IRQn
+#define USARTx_RX_EXTI_IRQHandler			EXTI15_10_IRQHandler
+
+#define USARTx_CONSOLE_IDLE_ms				30000	///< STOP mode is blocked for that long after the last input
+
 #define RCC_APBxENR_USARTxEN_bb				RCC_APB2ENR_USART1EN_bb
 
 #define USARTx_BAUDRATE						115200
@@ -90,7 +103,8 @@
 
 #define RCC_APBxENR_SPIxEN_bb				RCC_APB2ENR_SPI1EN_bb
 
-#define SPIx_SSB_GPIO						GPIOA
+#define SPIx_SSB_GPIO_BASE					GPIOA_BASE
+#define SPIx_SSB_GPIO						((GPIO_TypeDef *)SPIx_SSB_GPIO_BASE)
 #define SPIx_SSB_PIN						GPIO_PIN_4
 #define SPIx_SSB_CONFIGURATION				GPIO_OUT_PP_40MHz_PULL_UP
 #define SPIx_SCK_GPIO						GPIOA
@@ -103,7 +117,7 @@
 #define SPIx_MOSI_PIN						GPIO_PIN_7
 #define SPIx_MOSI_CONFIGURATION				GPIO_AF5_PP_40MHz_PULL_UP
 
-#define SPIx_SSB_bb							BITBAND(&SPIx_SSB_GPIO->ODR, SPIx_SSB_PIN)
+#define SPIx_SSB_Pin						Pin<SPIx_SSB_GPIO_BASE, SPIx_SSB_PIN>
 
 #define	SPIx_SSB_START						0
 #define SPIx_SSB_END						1
@@ -127,6 +141,84 @@
 
 #define I2C_FREQUENCY						100000
 
+/*---------------------------------------------------------------------------------------------------------------------+
+| RTC
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define RTC_LSE_FREQUENCY					32768	///< frequency of LSE crystal, in Hz
+#define RTC_LSI_FREQUENCY					37000	///< typical frequency of LSI, used if LSE does not start, in Hz
+#define RTC_LSE_STARTUP_LOOPS				30000	///< checks of LSERDY before LSI is selected, ~100 ms on 2 MHz MSI
+#define RTC_PREDIV_A						127		///< asynchronous prescaler of RTC, ck_apre = RTCCLK / 128
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| low-power modes
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define POWER_TICKLESS_PERIOD_ms			50		///< max period of RTC wakeup timer in tickless idle, up to 4000 ms
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| wall-clock
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define CLOCK_RESYNC_PERIOD_s				3600	///< period of reading time from M41T56C64 again, in seconds
+#define CLOCK_RESYNC_LSI_PERIOD_s			10		///< the same period while the RTC runs from LSI, in seconds
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| clock governor
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define GOVERNOR_PERIOD_ms					100		///< period of load sampling, in ms
+#define GOVERNOR_MIN_CLOCK					RCC_CLOCK_MSI_2MHz	///< slowest clock selected, I2C needs 2MHz
+#define GOVERNOR_MAX_CLOCK					RCC_CLOCK_PLL32	///< fastest clock selected
+#define GOVERNOR_TARGET_LOAD_percent		70		///< highest load allowed at selected clock, rest is deadline margin
+#define GOVERNOR_QUEUE_HIGH_percent			50		///< fill of watched queue which selects GOVERNOR_MAX_CLOCK
+#define GOVERNOR_DOWN_PERIODS				10		///< consecutive periods of low load before the clock is lowered
+#define GOVERNOR_LOG_LENGTH					16		///< number of logged decisions
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| run-time statistics
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define RUNTIME_FREQUENCY					10000	///< frequency of run-time counter (TIM6), in Hz
+
+/// groups of ISRs with accounted run time - entry(name)
+#define RUNTIME_ISR_GROUP_TABLE(entry) \
+		entry(USART) \
+		entry(RTC) \
+		entry(SENSORS) \
+		entry(LCD)
+
+#define CPULOAD_PERIOD_ms					1000	///< period of CPU load snapshots, in ms
+#define CPULOAD_MAX_TASKS					12		///< max number of tasks in snapshot
+#define CPULOAD_IDLE_PERIODS				10		///< periods without reads after which snapshots are stopped
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| stack monitor
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define STACKMON_PERIOD_ms					10000	///< period of sampling high water marks of stacks, in ms
+#define STACKMON_MAX_TASKS					12		///< max number of monitored tasks, deleted ones are kept
+#define STACKMON_LOW_words					16		///< free stack below which the task is reported as low
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| trace recorder
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define TRACE_EVENTS						128		///< size of the ring buffer of events, 8 bytes each
+#define TRACE_MAX_TASKS						12		///< max number of named tasks, including deleted ones
+#define TRACE_MAX_QUEUES					16		///< max number of numbered queues, semaphores and mutexes
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| memory pools
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define USART_STRING_LENGTH					48		///< size of pooled USART strings, longer ones are allocated from heap
+
+/// fixed-block pools - entry(type of blocks, number of blocks), one pool per type, only for types which are allocated;
+/// +2 is one block being filled and one being processed, besides full queue
+#define POOL_TABLE(entry) \
+		entry(UsartString,					USARTx_TX_QUEUE_LENGTH + 2)
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | commands
 +---------------------------------------------------------------------------------------------------------------------*/
@@ -139,6 +231,13 @@
 
 #define USARTx_DMAx_TX_CH_IRQ_PRIORITY		10
 #define USARTx_IRQ_PRIORITY					10
+#define USARTx_RX_EXTI_IRQ_PRIORITY			10
 #define SERIALx_IRQ_PRIORITY 				2
 #define TIM6_IRQ_PRIORITY					10
+#define ACC_INT_IRQ_PRIORITY				10
+#define TEM_ALERT_IRQ_PRIORITY				10
+#define RTC_ALARM_IRQ_PRIORITY				10
+#define RTC_WAKEUP_IRQ_PRIORITY				10
+#define LCD_IRQ_PRIORITY					10
+#define RCC_IRQ_PRIORITY					10
 #endif /* CONFIG_H_ */
@@ -89,6 +89,9 @@ enum Error
 	// various
 
 	ERROR_BUFFER_OVERFLOW,
+	ERROR_INVALID_ARGUMENT,
+	ERROR_DATA_CORRUPTED,
+	ERROR_TIMEOUT,
 
 };
 
@@ -15,9 +15,18 @@
 #include "usb_device.h"
 #include "hdr/hdr_rcc.h"
 #include "rcc.h"
+#include "rtc.h"
 #include "config.h"
 #include "hdr_gpio.h"
 #include "stm32l152xb.h"
+#include "wallclock.h"
+#include "governor.h"
+#include "cpuload.h"
+#include "stackmon.h"
+#include "trace.h"
+#include "boottime.h"
+#include "MCP980x.h"
+#include "pools.h"
 /* Private variables ---------------------------------------------------------*/
 
 
@@ -25,19 +34,40 @@
 void SystemClock_Config(void);
 static void GPIO_Init(void);
 static void _sysInit(void);
-static void _setVCore(void);
-static void _configureHSE(void);
 static void _configureHSI(void);
 static void _startPLL(void);
 
 
 
+/**
+ * \brief Called by startup code before .data and .bss are initialized. Starts the boot timer and oscillators of the
+ * PLL and the RTC, so they become ready in the background while memory is initialized and early init runs on MSI.
+ */
+extern "C" void low_level_init_0(void)
+{
+  boottimeStart();
+  rccPrepareClock(RCC_CLOCK_PLL32);
+  rtcPrepareClock();
+}
+
 int main(void)
 {
-  /* Configure the system clock */
-  _sysInit();
-  /* Initialize all configured peripherals */
+  boottimeInitialize();
+  poolsInitialize();
+  traceInitialize();
+  /* Initialize all configured peripherals (still on MSI) */
   GPIO_Init();
+  wallclockInitialize();
+  boottimeMark(BOOTTIME_EARLY_INIT);
+  /* Configure the system clock - drivers are re-timed by their clock callbacks */
+  _sysInit();
+  boottimeMark(BOOTTIME_CLOCK);
+  /* First sample right after the clock switch, its time is printed by the "boot" command */
+  MCP980x_Init();
+  MCP980x_Single_Measure();
+  governorInitialize();
+  cpuloadInitialize();
+  stackmonInitialize();
   USB_DEVICE_Init();
 
   /* Infinite loop */
@@ -56,28 +86,11 @@ void GPIO_Init(void)
 
 static void _sysInit(void)
 {
-	_setVCore();
-
 	/**
-	 * System Clock Configuration
+	 * System Clock Configuration - VCORE range 1 (1.8V) and PLL from CLOCK_SOURCE, started in low_level_init_0()
 	 */
-	_configureHSE();
-
-	rccStartPll(RCC_PLL_INPUT_HSE, HSE_VALUE, FREQUENCY);
-
-}
-
-static void _setVCore(void)
-{
-	RCC_APB1ENR_PWREN_bb = 1;
-	PWR->CR = (PWR->CR & (~PWR_CR_VOS)) | PWR_CR_VOS_0;	// set VCORE voltage range 1 (1.8V)
-	while((PWR->CSR & PWR_CSR_VOSF) != 0);				// wait for regulator ready
-}
-
-static void _configureHSE(void)
-{
-	RCC_CR_HSEON_bb = 1;					// enable HSE oscillator
-	while (RCC_CR_HSERDY_bb == 0);			// wait till READY
+	rccSetClock(RCC_CLOCK_PLL32);
+	RCC_APB2ENR_SYSCFGEN_bb = 1;
 }
 
 static void _configureHSI(void)
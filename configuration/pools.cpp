@@ -0,0 +1,118 @@
+/**
+ * \file pools.cpp
+ * \brief Fixed-block pools of the project.
+ *
+ * Storage of pools defined with POOL_TABLE in config.h. Storage is static, so the RAM taken by pools is known at link
+ * time.
+ *
+ * project: mg-stm32l_acquisition_supervisor; chip: STM32L152RB
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include "pools.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// definition of a pool
+struct _PoolDefinition {
+	uint32_t *storage;
+	size_t blockSize;
+	uint32_t count;
+	const char *name;
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+struct Pool pools[POOL_COUNT];
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define _POOL_STORAGE(type, count)			static uint32_t _storage_##type[POOL_STORAGE_WORDS(sizeof(type), count)];
+
+POOL_TABLE(_POOL_STORAGE)
+
+#undef _POOL_STORAGE
+
+#define _POOL_DEFINITION(type, count)		{_storage_##type, sizeof(type), count, #type},
+
+static const struct _PoolDefinition _definitions[POOL_COUNT] =
+{
+		POOL_TABLE(_POOL_DEFINITION)
+};
+
+#undef _POOL_DEFINITION
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Initializes all pools. Must be called before any pool is used.
+ */
+
+void poolsInitialize(void)
+{
+	for (size_t i = 0; i < POOL_COUNT; i++)
+		poolInitialize(&pools[i], _definitions[i].storage, _definitions[i].blockSize, _definitions[i].count);
+}
+
+/**
+ * \brief Gets name of a pool - name of the type of its blocks.
+ *
+ * \param [in] id is the identifier of the pool
+ *
+ * \return name of the pool
+ */
+
+const char* poolsGetName(enum PoolId id)
+{
+	return _definitions[id].name;
+}
+
+/**
+ * \brief Prints statistics of all pools as a table, to be used as the output of a command.
+ *
+ * \param [out] buffer is the buffer for the string
+ * \param [in] size is the size of the buffer, lines which don't fit are skipped
+ *
+ * \return length of the string, without trailing '\0'
+ */
+
+size_t poolsPrint(char* buffer, size_t size)
+{
+	char line[64];
+	size_t length = 0;
+
+	if (size == 0)
+		return 0;
+
+	buffer[0] = '\0';
+
+	for (size_t i = 0; i < POOL_COUNT; i++)
+	{
+		struct PoolStatistics statistics;
+
+		poolGetStatistics(&pools[i], &statistics);
+		sprintf(line, "pool %-12s %3u B %2u/%2u used, %2u max, %u failed\r\n", poolsGetName((enum PoolId)i),
+				(unsigned int)statistics.blockSize, (unsigned int)statistics.used, (unsigned int)statistics.count,
+				(unsigned int)statistics.highWater, (unsigned int)statistics.failures);
+
+		size_t line_length = strlen(line);
+
+		if (length + line_length >= size)
+			break;
+
+		memcpy(&buffer[length], line, line_length + 1);
+		length += line_length;
+	}
+
+	return length;
+}
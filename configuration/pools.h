@@ -0,0 +1,90 @@
+/**
+ * \file pools.h
+ * \brief Fixed-block pools of the project.
+ *
+ * Pools are defined with POOL_TABLE in config.h, one pool per type of blocks. Blocks are allocated with
+ * poolAllocate<type>() and returned with poolFree(block) - both may be called from tasks and ISRs. Allocation of a type
+ * without a pool doesn't compile.
+ *
+ * project: mg-stm32l_acquisition_supervisor; chip: STM32L152RB
+ */
+
+#ifndef POOLS_H_
+#define POOLS_H_
+
+#include <stdint.h>
+
+#include "config.h"
+
+#include "pool.h"
+#include "usart.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global types
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define _POOL_ID(type, count)				POOL_ID_##type,
+
+/// identifiers of pools, POOL_ID_<type>
+enum PoolId {
+	POOL_TABLE(_POOL_ID)
+	POOL_COUNT
+};
+
+#undef _POOL_ID
+
+/// pool of a type, defined only for types in POOL_TABLE
+template<typename T>
+struct PoolOf;
+
+#define _POOL_OF(type, count)				template<> struct PoolOf<type> { static const enum PoolId id = POOL_ID_##type; };
+
+POOL_TABLE(_POOL_OF)
+
+#undef _POOL_OF
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+extern struct Pool pools[POOL_COUNT];
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+void poolsInitialize(void);
+
+const char* poolsGetName(enum PoolId id);
+
+size_t poolsPrint(char* buffer, size_t size);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Allocates a block from the pool of a type. May be called from tasks and ISRs.
+ *
+ * \return pointer to the block, NULL if the pool is empty
+ */
+
+template<typename T>
+inline T* poolAllocate(void)
+{
+	return static_cast<T*>(poolAllocate(&pools[PoolOf<T>::id]));
+}
+
+/**
+ * \brief Returns a block to the pool of its type. May be called from tasks and ISRs.
+ *
+ * \param [in] block is the block allocated with poolAllocate<T>(), NULL is ignored
+ */
+
+template<typename T>
+inline void poolFree(T *block)
+{
+	poolFree(&pools[PoolOf<T>::id], block);
+}
+
+#endif /* POOLS_H_ */
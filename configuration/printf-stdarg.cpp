@@ -27,16 +27,29 @@
 */
 
 #include <stdarg.h>
+#include <stddef.h>
 
 #define putchar(c)							usartSendCharacter(c)
 
-static void printchar(char **str, int c)
+/*
+	Output of print(). Characters which don't fit before end are only
+	counted, so vsnprintf() can measure the string with str = 0.
+*/
+
+struct output {
+	char *str;		/* next character, 0 to count only */
+	char *end;		/* place of terminating '\0', 0 if not bounded */
+};
+
+static void printchar(struct output *out, int c)
 {
 	extern int putchar(int c);
 	
-	if (str) {
-		**str = c;
-		++(*str);
+	if (out) {
+		if (out->str && (!out->end || out->str < out->end)) {
+			*out->str = c;
+			++out->str;
+		}
 	}
 	else (void)putchar(c);
 }
@@ -44,7 +57,7 @@ static void printchar(char **str, int c)
 #define PAD_RIGHT 1
 #define PAD_ZERO 2
 
-static int prints(char **out, const char *string, int width, int pad)
+static int prints(struct output *out, const char *string, int width, int pad)
 {
 	register int pc = 0, padchar = ' ';
 
@@ -77,7 +90,7 @@ static int prints(char **out, const char *string, int width, int pad)
 /* the following should be enough for 32 bit int */
 #define PRINT_BUF_LEN 12
 
-static int printi(char **out, int i, int b, int sg, int width, int pad, int letbase)
+static int printi(struct output *out, int i, int b, int sg, int width, int pad, int letbase)
 {
 	char print_buf[PRINT_BUF_LEN];
 	register char *s;
@@ -120,7 +133,7 @@ static int printi(char **out, int i, int b, int sg, int width, int pad, int letb
 	return pc + prints (out, s, width, pad);
 }
 
-static int print(char **out, const char *format, va_list args )
+static int print(struct output *out, const char *format, va_list args )
 {
 	register int width, pad;
 	register int pc = 0;
@@ -183,7 +196,7 @@ static int print(char **out, const char *format, va_list args )
 			++pc;
 		}
 	}
-	if (out) **out = '\0';
+	if (out && out->str) *out->str = '\0';
 	va_end( args );
 	return pc;
 }
@@ -196,17 +209,33 @@ int printf(const char *format, ...)
         return print( 0, format, args );
 }
 
-int sprintf(char *out, const char *format, ...)
+extern "C" int sprintf(char *out, const char *format, ...)
 {
+        struct output o = { out, 0 };
         va_list args;
         
         va_start( args, format );
-        return print( &out, format, args );
+        return print( &o, format, args );
 }
 
-int vsprintf(char *out, const char *format, va_list args)
+extern "C" int vsprintf(char *out, const char *format, va_list args)
 {
-		return print(&out, format, args);
+		struct output o = { out, 0 };
+
+		return print(&o, format, args);
+}
+
+/*
+	Writes at most size - 1 characters and the terminating '\0'. Returns
+	the length of the whole formatted string, so vsnprintf(0, 0, ...)
+	only measures it.
+*/
+
+extern "C" int vsnprintf(char *out, size_t size, const char *format, va_list args)
+{
+		struct output o = { size ? out : 0, size ? out + size - 1 : 0 };
+
+		return print(&o, format, args);
 }
 
 #ifdef TEST_PRINTF
@@ -16,6 +16,9 @@ extern "C" {
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/times.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
 
 /*---------------------------------------------------------------------------------------------------------------------+
 | configuration
@@ -31,9 +34,10 @@ extern "C" {
 #define SYSCALLS_HAVE_KILL_R		1
 #define SYSCALLS_HAVE_LINK_R		1
 #define SYSCALLS_HAVE_LSEEK_R		1
+#define SYSCALLS_HAVE_MALLOC_R		1
 #define SYSCALLS_HAVE_OPEN_R		1
 #define SYSCALLS_HAVE_READ_R		1
-#define SYSCALLS_HAVE_SBRK_R		1
+#define SYSCALLS_HAVE_SBRK_R		0	// heap belongs to pvPortMalloc(), link fails if newlib's malloc is pulled in
 #define SYSCALLS_HAVE_STAT_R		1
 #define SYSCALLS_HAVE_TIMES_R		1
 #define SYSCALLS_HAVE_UNLINK_R		1
@@ -287,6 +291,117 @@ off_t _lseek_r(struct _reent *r, int file, off_t offset, int whence)
 
 #endif
 
+#if SYSCALLS_HAVE_MALLOC_R == 1
+
+/**
+ * \brief Allocate memory.
+ *
+ * Allocate memory. Whole heap is managed by pvPortMalloc(), so newlib's allocator is not linked at all.
+ *
+ * \param [in] size is the requested size.
+ *
+ * \return pointer to allocated memory or NULL for failure.
+ */
+
+void *_malloc_r(struct _reent *r, size_t size)
+{
+	void *pointer = pvPortMalloc(size);
+
+	(void)r;								// suppress warning
+
+	if (pointer == NULL)
+		errno = ENOMEM;						// not enough memory left
+
+	return pointer;
+}
+
+/**
+ * \brief Free memory.
+ *
+ * Free memory allocated with _malloc_r(), _calloc_r() or _realloc_r().
+ *
+ * \param [in] pointer is the pointer to memory to free, may be NULL.
+ */
+
+void _free_r(struct _reent *r, void *pointer)
+{
+	(void)r;								// suppress warning
+
+	vPortFree(pointer);
+}
+
+/**
+ * \brief Allocate zeroed memory.
+ *
+ * Allocate memory for an array and set it to zero.
+ *
+ * \param [in] count is the number of elements.
+ * \param [in] size is the size of one element.
+ *
+ * \return pointer to allocated memory or NULL for failure.
+ */
+
+void *_calloc_r(struct _reent *r, size_t count, size_t size)
+{
+	void *pointer;
+
+	if (size != 0 && count > (size_t)-1 / size)	// overflow?
+	{
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	pointer = _malloc_r(r, count * size);
+
+	if (pointer != NULL)
+		memset(pointer, 0, count * size);
+
+	return pointer;
+}
+
+/**
+ * \brief Change size of allocated memory.
+ *
+ * Change size of allocated memory. The block is kept if it is big enough, otherwise data is copied to a new block.
+ *
+ * \param [in] pointer is the pointer to memory to resize, may be NULL.
+ * \param [in] size is the requested size.
+ *
+ * \return pointer to resized memory or NULL for failure (original memory is not freed then).
+ */
+
+void *_realloc_r(struct _reent *r, void *pointer, size_t size)
+{
+	void *new_pointer;
+	size_t old_size;
+
+	if (pointer == NULL)
+		return _malloc_r(r, size);
+
+	if (size == 0)
+	{
+		vPortFree(pointer);
+		return NULL;
+	}
+
+	old_size = xPortGetBlockSize(pointer);
+
+	if (size <= old_size)
+		return pointer;
+
+	new_pointer = _malloc_r(r, size);
+
+	if (new_pointer != NULL)
+	{
+		memcpy(new_pointer, pointer, old_size);
+		vPortFree(pointer);
+	}
+
+	return new_pointer;
+}
+
+#endif
+
 #if SYSCALLS_HAVE_OPEN_R == 1
 
 /**
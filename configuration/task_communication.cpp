@@ -0,0 +1,21 @@
+/**
+ * \file task_communication.cpp
+ * \brief Queues and semaphores used to communicate inside OS.
+ *
+ * Definitions of handles declared in task_communication.h.
+ *
+ * project: mg-stm32l_acquisition_supervisor; chip: STM32L152RB
+ */
+
+#include "FreeRTOS.h"
+
+#include "task_communication.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+//cross-tasks communication
+xQueueHandle dataSenderBLEQueue;
+xQueueHandle dataSaverFLASHQueue;
+xQueueHandle commonDataQueue;
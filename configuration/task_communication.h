@@ -25,11 +25,8 @@
 +---------------------------------------------------------------------------------------------------------------------*/
 
 //cross-tasks communication
-xQueueHandle dataSenderBLEQueue;
-xQueueHandle dataSaverFLASHQueue;
-xQueueHandle commonDataQueue;
-
-//ISR communication
-xSemaphoreHandle xSemaphoreForAccISR;
+extern xQueueHandle dataSenderBLEQueue;
+extern xQueueHandle dataSaverFLASHQueue;
+extern xQueueHandle commonDataQueue;
 
 #endif //TSK_COMM_H_
@@ -5,79 +5,227 @@
  *      Author: Adrian
  */
 
+#include <stddef.h>
+#include <string.h>
+
 #include "stm32l1xx.h"
-#include "M41T56C64\M41T56C64.h"
+#include "M41T56C64.h"
 #include "i2c.h"
+#include "format.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// binary value of BCD byte, indexed with BCD value 0x00 - 0x99, invalid codes give 0
+static const uint8_t _bcdToBin[0x9A]=
+{
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 0, 0, 0, 0, 0, 0,
+	10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 0, 0, 0, 0, 0, 0,
+	20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 0, 0, 0, 0, 0, 0,
+	30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 0, 0, 0, 0, 0, 0,
+	40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 0, 0, 0, 0, 0, 0,
+	50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 0, 0, 0, 0, 0, 0,
+	60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 0, 0, 0, 0, 0, 0,
+	70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 0, 0, 0, 0, 0, 0,
+	80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 0, 0, 0, 0, 0, 0,
+	90, 91, 92, 93, 94, 95, 96, 97, 98, 99,
+};
+
+/// BCD value of binary byte, indexed with binary value 0 - 99
+static const uint8_t _binToBcd[100]=
+{
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+	0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19,
+	0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29,
+	0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+	0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+	0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+	0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+	0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79,
+	0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+	0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99,
+};
+
+/// masks of BCD digits of clock registers, in the order of registers
+static const uint8_t _clockMasks[M41T56_CLOCK_SIZE]=
+{
+	M41T56_SECONDS_MASK, M41T56_MINUTES_MASK, M41T56_HOURS_MASK, M41T56_DAY_MASK,
+	M41T56_DATE_MASK, M41T56_MONTH_MASK, M41T56_YEAR_MASK,
+};
+
+static_assert(2 * sizeof(struct M41T56C64_CheckpointSlot) == M41T56_NVRAM_SIZE, "two checkpoint slots fill NVRAM");
+
+/// generation of the newest slot in NVRAM and its index, valid after M41T56C64_ReadCheckpoint()
+static uint16_t _checkpointGeneration;
+static uint8_t _checkpointSlot = 1;
+static bool _checkpointLoaded;			///< true if _checkpointGeneration and _checkpointSlot were read from NVRAM
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static uint16_t M41T56C64_Crc(const uint8_t* data, size_t length);
+static bool M41T56C64_SlotValid(const struct M41T56C64_CheckpointSlot* slot);
+
+static uint8_t M41T56C64_BcdToBin(uint8_t bcd);
+static uint8_t M41T56C64_BinToBcd(uint8_t bin);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
 
 /**
- * \brief	Initializes RTC Module M41T56C64. Writing to RTC memory desired Time.
+ * \brief	Initializes RTC Module M41T56C64. Writing to RTC memory desired Time. Seconds, minutes and hours are written
+ * 			in one transaction, using auto-increment of register address.
  *
  * \param time	Pointer to table which contains hours, minutes and seconds
  */
 void M41T56C64_Init(uint8_t* time)
 {
-	uint8_t tab[2]={M41T56_SECONDS, *(time+2)};
-
-	uint8_t temp;
+	uint8_t tab[4]={M41T56_SECONDS, M41T56C64_BinToBcd(time[2]), M41T56C64_BinToBcd(time[1]),
+			M41T56C64_BinToBcd(time[0])};
 
 	i2cInitialize();
 
-	// Converting to BCD format
-	// Hours
-	temp=*time;
-	temp=*(time)%10;
-	temp+=( ( *(time)/10 ) << 4 );
-	*(time)=temp;
-
-	// Minutes
-	temp=*(time+1);
-	temp=*(time+1)%10;
-	temp+=( ( *(time+1)/10 ) << 4);
-	*(time+1)=temp;
-
-	// Seconds
-	temp=*(time+2);
-	temp=*(time+2)%10;
-	temp+=( ( *(time+2)/10 ) << 4);
-	*(time+2)=temp;
-
-
-	// setting seconds
-	i2cWrite(M41T56_SlaveAddress, tab, 2);
-
-	// setting minutes
-	tab[0]=M41T56_MINUTES;
-	tab[1]=*(time+1);
-	i2cWrite(M41T56_SlaveAddress, tab, 2);
-
-	// setting hours
-	tab[0]=M41T56_HOURS;
-	tab[1]=*time;
-	i2cWrite(M41T56_SlaveAddress, tab, 2);
+	i2cLock();
+	i2cWrite(M41T56_SlaveAddress, tab, 4);
+	i2cUnlock();
 }
 
 /**
- * \brief	Redaing from RTC actual time in BCD format
+ * \brief	Redaing from RTC actual time in BCD format. Seconds, minutes and hours are read in one transaction, so
+ * 			the time is consistent.
  *
  * \param tab	Pointer to table where hours, minutes and seconds will be written
  */
 void M41T56C64_ReadTime(uint8_t* tab)
 {
-	// Reading hours in BCD format
-	i2cWriteOneByteWhithoutStop(M41T56_SlaveAddress, M41T56_HOURS);
-	i2cRead(M41T56_SlaveAddress, tab, 1);
+	uint8_t clock[3];
 
-	tab++;
+	i2cLock();
+	i2cWriteOneByteWhithoutStop(M41T56_SlaveAddress, M41T56_SECONDS);
+	i2cRead(M41T56_SlaveAddress, clock, 3);
+	i2cUnlock();
 
-	// Reading minutes in BCD format
-	i2cWriteOneByteWhithoutStop(M41T56_SlaveAddress, M41T56_MINUTES);
-	i2cRead(M41T56_SlaveAddress, tab, 1);
+	tab[0]=clock[M41T56_HOURS];
+	tab[1]=clock[M41T56_MINUTES];
+	tab[2]=clock[M41T56_SECONDS];
+}
 
-	tab++;
+/**
+ * \brief	Reads full clock (seconds to year) from RTC in one burst transaction and converts it to binary format.
+ *
+ * \param clock	Pointer to structure where clock will be written
+ */
+void M41T56C64_ReadClock(struct M41T56C64_Clock* clock)
+{
+	uint8_t* tab = (uint8_t*)clock;
 
-	// Reading seconds in BCD format
+	i2cLock();
 	i2cWriteOneByteWhithoutStop(M41T56_SlaveAddress, M41T56_SECONDS);
-	i2cRead(M41T56_SlaveAddress, tab, 1);
+	i2cRead(M41T56_SlaveAddress, tab, M41T56_CLOCK_SIZE);
+	i2cUnlock();
+
+	for(uint8_t i=0; i<M41T56_CLOCK_SIZE; i++)
+		tab[i]=M41T56C64_BcdToBin(tab[i] & _clockMasks[i]);
+}
+
+/**
+ * \brief	Writes full clock (seconds to year) to RTC in one burst transaction. Oscillator is started (ST bit cleared),
+ * 			CONTROL register is not changed.
+ *
+ * \param clock	Pointer to structure with clock in binary format
+ */
+void M41T56C64_WriteClock(const struct M41T56C64_Clock* clock)
+{
+	const uint8_t* bin = (const uint8_t*)clock;
+	uint8_t tab[M41T56_CLOCK_SIZE + 1];
+
+	tab[0]=M41T56_SECONDS;
+
+	for(uint8_t i=0; i<M41T56_CLOCK_SIZE; i++)
+		tab[i + 1]=M41T56C64_BinToBcd(bin[i]) & _clockMasks[i];
+
+	i2cLock();
+	i2cWrite(M41T56_SlaveAddress, tab, sizeof(tab));
+	i2cUnlock();
+}
+
+/**
+ * \brief	Reads checkpoint from battery-backed NVRAM. Both slots are read in one burst transaction, the newer slot with
+ * 			valid CRC is returned. Next M41T56C64_WriteCheckpoint() overwrites the other slot.
+ *
+ * \param checkpoint	Pointer to structure where checkpoint will be written
+ *
+ * \return	ERROR_NONE if valid checkpoint was found, ERROR_DATA_CORRUPTED if none of slots is valid (e.g. first start)
+ */
+enum Error M41T56C64_ReadCheckpoint(struct M41T56C64_Checkpoint* checkpoint)
+{
+	struct M41T56C64_CheckpointSlot slots[2];
+
+	i2cLock();
+	i2cWriteOneByteWhithoutStop(M41T56_SlaveAddress, M41T56_NVRAM);
+	i2cRead(M41T56_SlaveAddress, (uint8_t*)slots, sizeof(slots));
+	i2cUnlock();
+
+	bool valid0 = M41T56C64_SlotValid(&slots[0]);
+	bool valid1 = M41T56C64_SlotValid(&slots[1]);
+
+	_checkpointLoaded = true;
+
+	if(valid0 == false && valid1 == false)
+	{
+		_checkpointGeneration = 0;
+		_checkpointSlot = 1;
+		return ERROR_DATA_CORRUPTED;
+	}
+
+	// generation can wrap around, so the difference decides which slot is newer
+	if(valid0 == true && (valid1 == false || (int16_t)(slots[0].generation - slots[1].generation) > 0))
+		_checkpointSlot = 0;
+	else
+		_checkpointSlot = 1;
+
+	_checkpointGeneration = slots[_checkpointSlot].generation;
+	*checkpoint = slots[_checkpointSlot].checkpoint;
+
+	return ERROR_NONE;
+}
+
+/**
+ * \brief	Writes checkpoint to battery-backed NVRAM in one burst transaction. The slot with older copy is overwritten,
+ * 			so valid checkpoint is kept if power fails during write. If M41T56C64_ReadCheckpoint() was not called yet,
+ * 			both slots are read first to find the newest one.
+ *
+ * \param checkpoint	Pointer to structure with checkpoint
+ */
+void M41T56C64_WriteCheckpoint(const struct M41T56C64_Checkpoint* checkpoint)
+{
+	uint8_t tab[1 + sizeof(struct M41T56C64_CheckpointSlot)];
+	struct M41T56C64_CheckpointSlot slot;
+
+	if(_checkpointLoaded == false)
+	{
+		struct M41T56C64_Checkpoint newest;
+
+		M41T56C64_ReadCheckpoint(&newest);
+	}
+
+	_checkpointSlot ^= 1;
+	_checkpointGeneration++;
+
+	slot.generation = _checkpointGeneration;
+	slot.checkpoint = *checkpoint;
+	slot.crc = M41T56C64_Crc((const uint8_t*)&slot.generation,
+			sizeof(slot) - offsetof(struct M41T56C64_CheckpointSlot, generation));
+
+	tab[0] = M41T56_NVRAM + _checkpointSlot * sizeof(struct M41T56C64_CheckpointSlot);
+	memcpy(&tab[1], &slot, sizeof(slot));
+
+	i2cLock();
+	i2cWrite(M41T56_SlaveAddress, tab, sizeof(tab));
+	i2cUnlock();
 }
 
 /**
@@ -87,24 +235,9 @@ void M41T56C64_ReadTime(uint8_t* tab)
  */
 void M41T56C64_ConvertToInt(uint8_t* tab)
 {
-	uint8_t bufor;
-
-	// Hours
-	bufor=( *tab & 0x0F );
-	bufor+=( ( ( *tab & 0b00110000 ) >> 4 ) * 10 );
-	*tab=bufor;
-
-	tab++;
-	// Minutes
-	bufor=( *tab & 0x0F );
-	bufor+=( ( ( *tab & 0b01110000 ) >> 4 )* 10 );
-	*tab=bufor;
-
-	tab++;
-	// Seconds
-	bufor=( *tab & 0x0F );
-	bufor+=( ( ( *tab & 0b01110000 ) >> 4 ) * 10 );
-	*tab=bufor;
+	tab[0]=M41T56C64_BcdToBin(tab[0] & M41T56_HOURS_MASK);
+	tab[1]=M41T56C64_BcdToBin(tab[1] & M41T56_MINUTES_MASK);
+	tab[2]=M41T56C64_BcdToBin(tab[2] & M41T56_SECONDS_MASK);
 }
 /**
  * \brief Converts Hours, Minutes and seconds written in uint8_t table to char table.
@@ -114,25 +247,65 @@ void M41T56C64_ConvertToInt(uint8_t* tab)
  */
 void M41T56C64_ConvertToString(uint8_t* time, char* text)
 {
-	// Hours
-	text[0]=(char)( ( *time / 10 ) + 48 );
-	text[1]=(char)( ( *time % 10 ) + 48 );
-	text[2]=':';
+	formatTime(text, time);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Converts BCD byte to binary value with lookup table.
+ *
+ * \param bcd	BCD value with control flags masked out
+ * \return	Binary value, 0 for invalid BCD code
+ */
+static uint8_t M41T56C64_BcdToBin(uint8_t bcd)
+{
+	return (bcd < sizeof(_bcdToBin)) ? _bcdToBin[bcd] : 0;
+}
 
-	time++;
+/**
+ * \brief	Converts binary value to BCD byte with lookup table.
+ *
+ * \param bin	Binary value 0 - 99
+ * \return	BCD value, 0 for values out of range
+ */
+static uint8_t M41T56C64_BinToBcd(uint8_t bin)
+{
+	return (bin < sizeof(_binToBcd)) ? _binToBcd[bin] : 0;
+}
 
-	// Minutes
-	text[3]=(char)( ( *time / 10 ) + 48 );
-	text[4]=(char)( ( *time % 10 ) + 48 );
-	text[5]=':';
+/**
+ * \brief	Calculates CRC-16-CCITT (polynomial 0x1021, initial value 0xFFFF).
+ *
+ * \param data		Pointer to data
+ * \param length	Number of bytes
+ * \return	CRC of data
+ */
+static uint16_t M41T56C64_Crc(const uint8_t* data, size_t length)
+{
+	uint16_t crc = 0xFFFF;
 
-	time++;
+	while(length--)
+	{
+		crc ^= (uint16_t)(*data++) << 8;
 
-	// Seconds
-	text[6]=(char)( ( *time / 10 ) + 48 );
-	text[7]=(char)( ( *time % 10 ) + 48 );
+		for(uint8_t i=0; i<8; i++)
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+	}
 
-	text[8]='\0';
+	return crc;
 }
 
-
+/**
+ * \brief	Checks CRC of checkpoint slot.
+ *
+ * \param slot	Pointer to slot read from NVRAM
+ * \return	true if CRC matches
+ */
+static bool M41T56C64_SlotValid(const struct M41T56C64_CheckpointSlot* slot)
+{
+	return M41T56C64_Crc((const uint8_t*)&slot->generation,
+			sizeof(*slot) - offsetof(struct M41T56C64_CheckpointSlot, generation)) == slot->crc;
+}
@@ -10,6 +10,10 @@
 #ifndef M41T56C64_H_
 #define M41T56C64_H_
 
+#include <stdint.h>
+
+#include "error.h"
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | global defines
 +---------------------------------------------------------------------------------------------------------------------*/
@@ -30,6 +34,54 @@
 #define M41T56_S		5
 #define M41T56_CALMASK	0x1F
 
+#define M41T56_NVRAM		8		///< first byte of battery-backed SRAM
+#define M41T56_NVRAM_SIZE	56
+
+#define M41T56_CLOCK_SIZE	7		///< registers from M41T56_SECONDS to M41T56_YEAR, read and written in one burst
+
+// masks of BCD digits, upper bits are control flags (ST in seconds, CEB and CB in hours)
+#define M41T56_SECONDS_MASK	0x7F
+#define M41T56_MINUTES_MASK	0x7F
+#define M41T56_HOURS_MASK	0x3F
+#define M41T56_DAY_MASK		0x07
+#define M41T56_DATE_MASK	0x3F
+#define M41T56_MONTH_MASK	0x1F
+#define M41T56_YEAR_MASK	0xFF
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// full clock of the RTC in binary format, fields in the order of registers
+struct M41T56C64_Clock
+{
+	uint8_t seconds;	///< 0 - 59
+	uint8_t minutes;	///< 0 - 59
+	uint8_t hours;		///< 0 - 23
+	uint8_t day;		///< day of week 1 - 7
+	uint8_t date;		///< day of month 1 - 31
+	uint8_t month;		///< 1 - 12
+	uint8_t year;		///< 0 - 99
+};
+
+/// state saved in NVRAM, recovered after reset or brownout
+struct M41T56C64_Checkpoint
+{
+	uint32_t sampleSequence;	///< sequence counter of samples
+	uint32_t messageSequence;	///< sequence counter of messages sent
+	uint32_t logSector;			///< last sector of log written to SD card
+	uint8_t acquisitionState;	///< state of acquisition, defined by application
+	uint8_t reserved[11];		///< free space, keeps the size of slot
+};
+
+/// one of two copies of checkpoint in NVRAM, half of NVRAM
+struct M41T56C64_CheckpointSlot
+{
+	uint16_t crc;				///< CRC-16-CCITT of generation and checkpoint
+	uint16_t generation;		///< incremented with each write, newer valid slot is used
+	struct M41T56C64_Checkpoint checkpoint;
+};
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | global functions' prototypes
 +---------------------------------------------------------------------------------------------------------------------*/
@@ -38,6 +90,14 @@ void M41T56C64_Init(uint8_t* time);
 
 void M41T56C64_ReadTime(uint8_t* tab);
 
+void M41T56C64_ReadClock(struct M41T56C64_Clock* clock);
+
+void M41T56C64_WriteClock(const struct M41T56C64_Clock* clock);
+
+enum Error M41T56C64_ReadCheckpoint(struct M41T56C64_Checkpoint* checkpoint);
+
+void M41T56C64_WriteCheckpoint(const struct M41T56C64_Checkpoint* checkpoint);
+
 void M41T56C64_ConvertToInt(uint8_t* tab);
 
 void M41T56C64_ConvertToString(uint8_t* tab, char* text);
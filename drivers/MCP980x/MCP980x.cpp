@@ -6,8 +6,39 @@
  */
 
 #include "stm32l1xx.h"
+#include "bsp.h"
+#include "config.h"
+#include "gpio.h"
 #include "i2c.h"
-#include "MCP980x\MCP980x.h"
+#include "MCP980x.h"
+
+#include "boottime.h"
+#include "runtime.h"
+
+#include "FreeRTOS.h"
+#include "timers.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static void MCP980x_TimerCallback(xTimerHandle timer);
+static int16_t MCP980x_Convert(const uint8_t* wsk);
+static uint8_t MCP980x_ConfigValue(uint8_t flags);
+static void MCP980x_WriteLimit(uint8_t reg, int16_t temperature);
+static constexpr int16_t MCP980x_LimitSteps(int16_t temperature);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+static xTimerHandle _conversionTimer;		///< one-shot timer armed for conversion time
+static xStaticTimer _conversionTimerBuffer;	///< storage of _conversionTimer
+static MCP980x_Callback _callback;			///< receiver of pending measure, NULL if not used
+static xQueueHandle _queue;					///< receiver of pending measure, NULL if not used
+static volatile bool _pending;				///< conversion started and result not delivered yet
+static enum MCP980x_Resolution _resolution = TEM_RESOLUTION_9BIT;	///< resolution set in CONFIG register
+static xQueueHandle _alertQueue;			///< receiver of ALERT changes, NULL if alert window is not active
 
 /*---------------------------------------------------------------------------------------------------------------------+
 | global functions
@@ -20,22 +51,43 @@ void MCP980x_Init(void)
 {
 	i2cInitialize();	// i2c interface init
 
-	uint8_t tab[]={TEM_CONFIG_REG, 0b00000001};
+	uint8_t tab[]={TEM_CONFIG_REG, MCP980x_ConfigValue(TEM_CONFIG_SHUTDOWN)};
 
+	i2cLock();
 	i2cWrite(TEM_SLAVE_ADDRESS, tab, 2);	// shoot down mode
+	i2cUnlock();
+}
+
+/**
+ * \brief	Sets resolution of next conversions. Higher resolution doubles the conversion time with each bit
+ * 			(30 ms for 9 bits up to 240 ms for 12 bits). Sensor stays in shutdown mode.
+ *
+ * \param resolution	Resolution from 9 to 12 bits
+ */
+void MCP980x_SetResolution(enum MCP980x_Resolution resolution)
+{
+	_resolution = resolution;
+
+	uint8_t tab[]={TEM_CONFIG_REG, MCP980x_ConfigValue(TEM_CONFIG_SHUTDOWN)};
+
+	i2cLock();
+	i2cWrite(TEM_SLAVE_ADDRESS, tab, 2);
+	i2cUnlock();
 }
 
 /**
  * \brief	Doing a single measure by setting bit7 (ONE SHOT) at the CONFIG register. Then waiting for clear this bit,
- * 			reading two bytes from TA register and converts it to float.
+ * 			reading two bytes from TA register and converts it to Q8.4 format.
  *
- * \return	Value of actual temperature in float.
+ * \return	Value of actual temperature in Q8.4 format (1/16 degree).
  */
-float MCP980x_Single_Measure()
+int16_t MCP980x_Single_Measure()
 {
-	uint8_t tab[]={TEM_CONFIG_REG, 0b10000001};
+	uint8_t tab[]={TEM_CONFIG_REG, MCP980x_ConfigValue(TEM_CONFIG_ONE_SHOT | TEM_CONFIG_SHUTDOWN)};
 	uint8_t config_reg;
 
+	i2cLock();
+
 	// writing SourceValue to perpih
 	i2cWrite(TEM_SLAVE_ADDRESS, tab, 2);
 
@@ -54,30 +106,255 @@ float MCP980x_Single_Measure()
 	// reading data from TA register
 	i2cRead(TEM_SLAVE_ADDRESS, tab, 2);
 
+	i2cUnlock();
+
+	boottimeMark(BOOTTIME_FIRST_SAMPLE);
 
 	return MCP980x_Convert(tab);
 }
 
 /**
- * \brief	Converts two bytes: MSB and LSB from TA register to one float.
+ * \brief	Starts a single measure without waiting for its end. Sets bit7 (ONE SHOT) at the CONFIG register and arms
+ * 			software timer for conversion time. Result is read once, when timer expires, and delivered to callback and/or
+ * 			queue (int16_t items, Q8.4 format) from timer task. I2C bus is free for other devices during conversion.
+ *
+ * \param callback	Function called with result, can be NULL
+ * \param queue		Queue for result, can be NULL
+ *
+ * \return	ERROR_NONE if conversion was started, ERROR_MAINBUSS_MODULE_NOT_READY if previous one is still pending,
+ * 			otherwise an error code defined in the file error.h
+ */
+enum Error MCP980x_StartMeasure(MCP980x_Callback callback, xQueueHandle queue)
+{
+	uint8_t tab[]={TEM_CONFIG_REG, MCP980x_ConfigValue(TEM_CONFIG_ONE_SHOT | TEM_CONFIG_SHUTDOWN)};
+	portTickType conversion_time = (TEM_CONVERSION_TIME_9BIT_MS << _resolution) / portTICK_RATE_MS;
+
+	if(_pending)
+		return ERROR_MAINBUSS_MODULE_NOT_READY;
+
+	if(_conversionTimer == NULL)
+	{
+		_conversionTimer = xTimerCreateStatic((const signed char*)"MCP980x", conversion_time,
+				pdFALSE, NULL, MCP980x_TimerCallback, &_conversionTimerBuffer);
+	}
+
+	_callback=callback;
+	_queue=queue;
+	_pending=true;
+
+	// start conversion
+	i2cLock();
+	i2cWrite(TEM_SLAVE_ADDRESS, tab, 2);
+	i2cUnlock();
+
+	portBASE_TYPE ret = xTimerChangePeriod(_conversionTimer, conversion_time, 0);
+
+	enum Error error = errorConvert_portBASE_TYPE(ret);
+
+	if(error != ERROR_NONE)
+		_pending=false;
+
+	return error;
+}
+
+/**
+ * \brief	Starts continuous monitoring of temperature window. TLIMIT and THYST registers are programmed, sensor leaves
+ * 			shutdown mode and converts continuously with ALERT output in comparator mode. ALERT is asserted when
+ * 			temperature exceeds limit and released when it drops below hysteresis, each change wakes the MCU through EXTI
+ * 			and sends TEM_ALERT_ABOVE_LIMIT or TEM_ALERT_BELOW_HYSTERESIS to the queue. No I2C traffic is needed until
+ * 			then. MCP980x_Single_Measure() and MCP980x_StartMeasure() read the last conversion in this mode.
+ *
+ * \param limit			Upper threshold in Q8.4 format, rounded down to 0.5 degree
+ * \param hysteresis	Lower threshold in Q8.4 format, rounded down to 0.5 degree, must be below limit
+ * \param queue			Queue for ALERT changes (uint8_t items)
+ *
+ * \return	ERROR_NONE if monitoring was started, ERROR_INVALID_ARGUMENT if thresholds are not ordered or queue is NULL
+ */
+enum Error MCP980x_StartAlertWindow(int16_t limit, int16_t hysteresis, xQueueHandle queue)
+{
+	if(queue == NULL || MCP980x_LimitSteps(hysteresis) >= MCP980x_LimitSteps(limit))
+		return ERROR_INVALID_ARGUMENT;
+
+	i2cLock();
+	MCP980x_WriteLimit(TEM_TLIMIT_REG, limit);
+	MCP980x_WriteLimit(TEM_THYST_REG, hysteresis);
+	i2cUnlock();
+
+	TEM_ALERT_Pin::configure(TEM_ALERT_CONFIGURATION);
+
+	RCC->APB2ENR|=RCC_APB2ENR_SYSCFGEN;
+	SYSCFG->EXTICR[TEM_ALERT_EXTICR_index]=(SYSCFG->EXTICR[TEM_ALERT_EXTICR_index] & ~TEM_ALERT_EXTICR_mask) |
+			TEM_ALERT_EXTICR;
+
+	_alertQueue=queue;
+
+	// continuous conversion with ALERT in comparator mode
+	uint8_t tab[]={TEM_CONFIG_REG, MCP980x_ConfigValue(0)};
+	i2cLock();
+	i2cWrite(TEM_SLAVE_ADDRESS, tab, 2);
+	i2cUnlock();
+
+	EXTI->RTSR|=TEM_ALERT_EXTI_LINE;		// ALERT released
+	EXTI->FTSR|=TEM_ALERT_EXTI_LINE;		// ALERT asserted
+	EXTI->PR=TEM_ALERT_EXTI_LINE;			// clear pending request
+	EXTI->IMR|=TEM_ALERT_EXTI_LINE;
+
+	NVIC_SetPriority(TEM_ALERT_IRQn, TEM_ALERT_IRQ_PRIORITY);
+	NVIC_EnableIRQ(TEM_ALERT_IRQn);
+
+	return ERROR_NONE;
+}
+
+/**
+ * \brief	Stops monitoring started by MCP980x_StartAlertWindow() and puts sensor back in shutdown mode.
+ */
+void MCP980x_StopAlertWindow(void)
+{
+	NVIC_DisableIRQ(TEM_ALERT_IRQn);
+	EXTI->IMR&= ~TEM_ALERT_EXTI_LINE;
+	EXTI->PR=TEM_ALERT_EXTI_LINE;			// clear pending request
+
+	_alertQueue=NULL;
+
+	uint8_t tab[]={TEM_CONFIG_REG, MCP980x_ConfigValue(TEM_CONFIG_SHUTDOWN)};
+	i2cLock();
+	i2cWrite(TEM_SLAVE_ADDRESS, tab, 2);
+	i2cUnlock();
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Builds value of CONFIG register. Selected resolution is always added. When alert window is active sensor
+ * 			has to convert continuously, so shutdown and one shot bits are dropped and fault queue is set instead.
+ *
+ * \param flags	TEM_CONFIG_SHUTDOWN and/or TEM_CONFIG_ONE_SHOT
+ * \return	Value to write to CONFIG register
+ */
+static uint8_t MCP980x_ConfigValue(uint8_t flags)
+{
+	if(_alertQueue != NULL)
+		flags=TEM_CONFIG_FAULT_QUEUE_4;
+
+	return flags | (_resolution << TEM_CONFIG_RESOLUTION_bit);
+}
+
+/**
+ * \brief	Writes TLIMIT or THYST register. Both have the same format as TA register with 0.5 degree resolution.
+ * 			Bus must be locked with i2cLock().
+ *
+ * \param reg			TEM_TLIMIT_REG or TEM_THYST_REG
+ * \param temperature	Temperature in Q8.4 format
+ */
+static void MCP980x_WriteLimit(uint8_t reg, int16_t temperature)
+{
+	uint16_t value = (uint16_t)(temperature << 4) & TEM_LIMIT_MASK;
+	uint8_t tab[]={reg, (uint8_t)(value >> 8), (uint8_t)value};
+
+	i2cWrite(TEM_SLAVE_ADDRESS, tab, 3);
+}
+
+/**
+ * \brief	Rounds temperature down to the 0.5 degree resolution of THYST and TLIMIT registers, keeping the sign.
+ *
+ * \param temperature	Temperature in Q8.4 format
+ * \return	Temperature in 0.5 degree steps
+ */
+static constexpr int16_t MCP980x_LimitSteps(int16_t temperature)
+{
+	return (int16_t)(temperature >> 3);
+}
+
+// checks of threshold ordering in MCP980x_StartAlertWindow(), values in Q8.4 format
+static_assert(MCP980x_LimitSteps(-1 * 16) < MCP980x_LimitSteps(1 * 16), "hysteresis -1 < 0 < limit 1 must be accepted");
+static_assert(MCP980x_LimitSteps(-20 * 16) < MCP980x_LimitSteps(-1 * 16), "negative window must be accepted");
+static_assert(MCP980x_LimitSteps(-8) == MCP980x_LimitSteps(-4), "-0.5 and -0.25 round down to the same threshold");
+static_assert(MCP980x_LimitSteps(20 * 16 + 7) == MCP980x_LimitSteps(20 * 16), "20.4375 rounds down to 20.0");
+
+/**
+ * \brief	Converts two bytes: MSB and LSB from TA register to Q8.4 fixed point value. TA register is a two's
+ * 			complement value with sign in bit 15 and four fraction bits in 7:4, so it only has to be shifted.
+ * 			Fraction bits below selected resolution are read as zeros.
  *
  * \param	Pointer to table which contains MSB and LSB value of TA register.
- * \return	Actual temperature in float.
+ * \return	Actual temperature in Q8.4 format (1/16 degree), use TEM_Q4_TO_CENTI() for hundredths of degree.
+ */
+static int16_t MCP980x_Convert(const uint8_t* wsk)
+{
+	int16_t ta = (int16_t)((wsk[0] << 8) | wsk[1]);
+
+	return ta >> 4;							// arithmetic shift keeps the sign
+}
+
+/**
+ * \brief	Conversion timer callback. Checks ONE SHOT bit once, if conversion is finished reads TA register and
+ * 			delivers result, otherwise arms timer again for a short time.
+ *
+ * \param timer	Handle of expired timer
  */
-static float MCP980x_Convert(uint8_t* wsk)
+static void MCP980x_TimerCallback(xTimerHandle timer)
 {
-	int8_t MSB= (int8_t)*wsk;
-	wsk++;
-	float LSB=0;
+	uint8_t tab[2];
+	uint8_t config_reg;
+
+	i2cLock();
+
+	i2cWriteOneByteWhithoutStop(TEM_SLAVE_ADDRESS, TEM_CONFIG_REG);
+	i2cRead(TEM_SLAVE_ADDRESS, &config_reg, 1);
+
+	if(config_reg & TEM_CONFIG_ONE_SHOT)
+	{
+		i2cUnlock();
+		xTimerChangePeriod(timer, TEM_CONVERSION_RETRY_MS / portTICK_RATE_MS, 0);
+		return;
+	}
+
+	i2cWriteOneByteWhithoutStop(TEM_SLAVE_ADDRESS, TEM_TA_REG);
+	i2cRead(TEM_SLAVE_ADDRESS, tab, 2);
+
+	i2cUnlock();
+
+	int16_t temperature = MCP980x_Convert(tab);
 
-	if((MSB >> 7)==1) MSB*=(-1);
+	_pending=false;
 
-	if(*wsk & 128) LSB+=0.5;
-	if(*wsk & 64) LSB+=0.25;
-	if(*wsk & 32) LSB+=0.125;
-	if(*wsk & 16) LSB+=0.0625;
+	boottimeMark(BOOTTIME_FIRST_SAMPLE);
 
-	return (float)MSB + LSB;
+	if(_callback != NULL)
+		_callback(temperature);
+
+	if(_queue != NULL)
+		xQueueSend(_queue, &temperature, 0);
 }
 
+/*---------------------------------------------------------------------------------------------------------------------+
+| ISRs
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief MCP980x ALERT interrupt handler
+ *
+ * State of the window is read from the pin level, so the sensor is not accessed in interrupt.
+ */
 
+extern "C" void TEM_ALERT_IRQHandler(void) __attribute__ ((interrupt));
+void TEM_ALERT_IRQHandler(void)
+{
+	struct RuntimeIsr isr;
+	signed portBASE_TYPE higher_priority_task_woken = pdFALSE;
+
+	runtimeIsrEnter(&isr);
+
+	uint8_t state = (TEM_ALERT_Pin::read() == false) ? TEM_ALERT_ABOVE_LIMIT : TEM_ALERT_BELOW_HYSTERESIS;
+
+	EXTI->PR=TEM_ALERT_EXTI_LINE;			// clear pending request
+
+	if(_alertQueue != NULL)
+		xQueueSendFromISR(_alertQueue, &state, &higher_priority_task_woken);
+
+	runtimeIsrExit(&isr, RUNTIME_ISR_GROUP_SENSORS);
+
+	portEND_SWITCHING_ISR(higher_priority_task_woken);
+}
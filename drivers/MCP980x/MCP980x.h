@@ -8,6 +8,11 @@
 #ifndef TEM_H_
 #define TEM_H_
 
+#include "FreeRTOS.h"
+#include "queue.h"
+
+#include "error.h"
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | global defines
 +---------------------------------------------------------------------------------------------------------------------*/
@@ -15,6 +20,45 @@
 #define TEM_SLAVE_ADDRESS 0b1001000
 #define TEM_CONFIG_REG 0b0000001
 #define TEM_TA_REG 0b00000000
+#define TEM_THYST_REG 0b00000010
+#define TEM_TLIMIT_REG 0b00000011
+
+// CONFIG register bits
+#define TEM_CONFIG_SHUTDOWN		0b00000001
+#define TEM_CONFIG_INTERRUPT	0b00000010	///< ALERT in interrupt mode, comparator mode if cleared
+#define TEM_CONFIG_ACTIVE_HIGH	0b00000100	///< ALERT active high, active low if cleared
+#define TEM_CONFIG_FAULT_QUEUE_4	0b00010000	///< ALERT changes after 4 consecutive conversions out of window
+#define TEM_CONFIG_RESOLUTION_bit	5
+#define TEM_CONFIG_ONE_SHOT		0b10000000
+
+#define TEM_CONVERSION_TIME_9BIT_MS	30	///< conversion time for 9 bit resolution (datasheet, typical), doubles with each bit
+#define TEM_CONVERSION_RETRY_MS	5		///< additional wait if conversion is not finished yet
+
+/// THYST and TLIMIT registers have 0.5 degree resolution, bits 15:7
+#define TEM_LIMIT_MASK			0xFF80
+
+// items sent to the queue given to MCP980x_StartAlertWindow()
+#define TEM_ALERT_BELOW_HYSTERESIS	0	///< temperature dropped below THYST, ALERT released
+#define TEM_ALERT_ABOVE_LIMIT		1	///< temperature exceeded TLIMIT, ALERT asserted
+
+/// converts temperature in Q8.4 format (1/16 degree) to hundredths of degree
+#define TEM_Q4_TO_CENTI(q4)		(((int32_t)(q4) * 25) / 4)
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// resolution of conversion, written to bits 6:5 of CONFIG register
+enum MCP980x_Resolution
+{
+	TEM_RESOLUTION_9BIT = 0,		///< 0.5 degree, 30 ms
+	TEM_RESOLUTION_10BIT,			///< 0.25 degree, 60 ms
+	TEM_RESOLUTION_11BIT,			///< 0.125 degree, 120 ms
+	TEM_RESOLUTION_12BIT,			///< 0.0625 degree, 240 ms
+};
+
+/// function called (from timer task) with the result of MCP980x_StartMeasure(), temperature in Q8.4 format
+typedef void (*MCP980x_Callback)(int16_t temperature);
 
 /*---------------------------------------------------------------------------------------------------------------------+
 | global functions' prototypes
@@ -22,8 +66,14 @@
 
 void MCP980x_Init(void);
 
-float MCP980x_Single_Measure();
+void MCP980x_SetResolution(enum MCP980x_Resolution resolution);
+
+int16_t MCP980x_Single_Measure();
+
+enum Error MCP980x_StartMeasure(MCP980x_Callback callback, xQueueHandle queue);
+
+enum Error MCP980x_StartAlertWindow(int16_t limit, int16_t hysteresis, xQueueHandle queue);
 
-static float MCP980x_Convert(uint8_t* wsk);
+void MCP980x_StopAlertWindow(void);
 
 #endif /* TEM_H_ */
@@ -3,22 +3,38 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include "acc_def.h"
 #include "config.h"
 #include "stm32l1xx.h"
 #include "gpio.h"
 #include "peripherals/spi.h"
+#include "rcc.h"
 #include "acc.h"
 #include "hdr/hdr_spi.h"
 #include "config.h"
 #include "bsp.h"
+#include "runtime.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#include "task_communication.h"
 
 #define NO_ERROR 0
 
 void acc_InitTap(struct acc_t *self);
+static void acc_EventTask(void *parameters);
 
 uint8_t command;
 
+static xQueueHandle acc_eventQueue;	///< queue for struct acc_event_t, set by acc_EnableEvents
+
+static xTaskHandle acc_eventTaskHandle;	///< acc_EventTask, notified by ACC_INT_IRQHandler
+static xStaticTask acc_eventTaskBuffer;
+static portSTACK_TYPE acc_eventTaskStack[ACC_TASK_STACK_SIZE];
+
 void acc_Init(struct acc_t *self, uint8_t work_mode, acc_config_t *config)
 {
 	acc_InitTap(self);
@@ -27,22 +43,22 @@ void acc_Init(struct acc_t *self, uint8_t work_mode, acc_config_t *config)
 uint8_t*
 acc_ReadData(struct acc_t *self, uint8_t* data, uint8_t size)
 {
-	SPIx_SSB_bb=SPIx_SSB_START;
+	spiStart();
 	uint8_t addres=AAC_SPI_READ_ADDRESS;
 	spiTransfer(&addres, NULL , 1);
 	spiTransfer(NULL, data, size);
-	SPIx_SSB_bb=SPIx_SSB_END;
+	spiStop();
 	return data;
 }
 
 void
 acc_WriteData(struct acc_t *self, uint8_t* data, uint8_t size)
 {
-	SPIx_SSB_bb=SPIx_SSB_START;
+	spiStart();
 	uint8_t address=ACC_SPI_WRITE_ADDRESS;
 	spiTransfer(&address, NULL , 1);
 	spiTransfer(data, NULL , size);
-	SPIx_SSB_bb=SPIx_SSB_END;
+	spiStop();
 }
 
 void acc_MailboxSendConfig( struct acc_t *self, uint8_t app_id, uint8_t* config_data, uint8_t size_config, uint8_t offset )
@@ -56,32 +72,63 @@ void acc_MailboxSendConfig( struct acc_t *self, uint8_t app_id, uint8_t* config_
 	mail[3]=(uint8_t)offset;
 	mail[4]=size_config;
 
-	SPIx_SSB_bb=SPIx_SSB_START;
+	spiStart();
 	spiTransfer(mail, 0 , 5);
 	spiTransfer(config_data, NULL , size_config);
-	SPIx_SSB_bb=SPIx_SSB_END;
+	spiStop();
 	while(czekaj--);
 }
 
-uint8_t* acc_MailboxReadData( struct acc_t *self, uint8_t app_id, uint8_t *buffer, uint8_t size, uint8_t offset )
+/**
+ * \brief Polls mailbox until response is complete and reads its data.
+ *
+ * \param [out] Buffer for data, without mailbox header, zeroed if response doesn't come
+ * \param [in] Number of data bytes to read
+ *
+ * \return ERROR_NONE on success, ERROR_TIMEOUT if response wasn't complete within ACC_MAILBOX_TIMEOUT_us
+ */
+static enum Error acc_MailboxTakeResponse(uint8_t *buffer, uint8_t size)
 {
-	uint8_t data_buff[4], addres=AAC_SPI_READ_ADDRESS;
-	self->acc_MailboxReadAsk(self, app_id,  size,  offset);
+	uint8_t data_buff[ACC_MAILBOX_HEADER_SIZE], addres=AAC_SPI_READ_ADDRESS;
+	// time limit is measured with the cycle counter, so it doesn't depend on the speed of SPI
+	uint32_t timeout=((uint64_t)rccGetCoreFrequency()*ACC_MAILBOX_TIMEOUT_us)/1000000;
+	uint32_t start;
+
+	CoreDebug->DEMCR|=CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL|=DWT_CTRL_CYCCNTENA_Msk;
+	start=DWT->CYCCNT;
 
-	uint16_t czekaj=ACC_SPI_READ_DEALY;
-	while(czekaj--);  // do poprawy
 	while(1)
 	{
-		SPIx_SSB_bb=SPIx_SSB_START;
+		spiStart();
 		spiTransfer(&addres, NULL , 1);
-		spiTransfer(NULL, data_buff, 4);
-		if(data_buff[1]==0x80)
+		spiTransfer(NULL, data_buff, ACC_MAILBOX_HEADER_SIZE);
+		if(data_buff[1]==ACC_MAILBOX_COCO)
 		{
 			break;
 		}  // dopisac elsa by obsugiwa bdy gdy dane nie zostan poprawnie odebrane
+		spiStop();
+
+		if(DWT->CYCCNT-start>=timeout)
+		{
+			memset(buffer, 0, size);
+			return ERROR_TIMEOUT;
+		}
 	}
 	spiTransfer(NULL, buffer, size);
-	SPIx_SSB_bb=SPIx_SSB_END;
+	spiStop();
+
+	return ERROR_NONE;
+}
+
+uint8_t* acc_MailboxReadData( struct acc_t *self, uint8_t app_id, uint8_t *buffer, uint8_t size, uint8_t offset )
+{
+	self->acc_MailboxReadAsk(self, app_id,  size,  offset);
+
+	uint16_t czekaj=ACC_SPI_READ_DEALY;
+	while(czekaj--);  // do poprawy
+	if(acc_MailboxTakeResponse(buffer, size)!=ERROR_NONE)
+		return NULL;
 	return buffer;
 }
 
@@ -125,13 +172,18 @@ void acc_WakeUp( struct acc_t *self)
   	self->acc_WriteData(self, mail , 5);
 }
 
+static void acc_DecodePoss(struct acc_t *self, const uint8_t *poss_buffer)
+{
+	self->position[0]=(poss_buffer[0]<<8)| (poss_buffer[1]);
+	self->position[1]=(poss_buffer[2]<<8)| (poss_buffer[3]);
+	self->position[2]=(poss_buffer[4]<<8)| (poss_buffer[5]);
+}
+
 uint16_t* acc_GetPoss(struct acc_t *self)
 {
 	uint8_t poss_buffer[6];
 	self->acc_MailboxReadData(self, ACC_ID_AFE, poss_buffer, 6, 0);
-	self->position[0]=(poss_buffer[0]<<8)| (poss_buffer[1]);
-	self->position[1]=(poss_buffer[2]<<8)| (poss_buffer[3]);
-	self->position[2]=(poss_buffer[6]<<8)| (poss_buffer[5]);
+	acc_DecodePoss(self, poss_buffer);
 	return self->position;
 }
 
@@ -150,6 +202,246 @@ uint8_t  acc_GetTap( struct acc_t *self )
 		return 0;
 }
 
+/**
+ * \brief Decodes direction of tap from single byte of Tap Application status.
+ *
+ * \param [in] Status byte, single or double tap register
+ * \param [in] Type of event which is decoded
+ * \param [out] Event to fill
+ */
+static void acc_DecodeTap(uint8_t status, acc_event_type_t type, struct acc_event_t *event)
+{
+	event->type=type;
+	event->x=ACC_TAP_NONE;
+	event->y=ACC_TAP_NONE;
+	event->z=ACC_TAP_NONE;
+
+	// DIR bit is placed directly above EV bit for each axis, so the same bits are used for single and double tap
+	if(status & (1<<ACC_TAPS_XEVENT))
+		event->x=(status & (1<<ACC_TAPS_XDIR)) ? ACC_TAP_NEGATIVE : ACC_TAP_POSITIVE;
+	if(status & (1<<ACC_TAPS_YEVENT))
+		event->y=(status & (1<<ACC_TAPS_YDIR)) ? ACC_TAP_NEGATIVE : ACC_TAP_POSITIVE;
+	if(status & (1<<ACC_TAPS_ZEVENT))
+		event->z=(status & (1<<ACC_TAPS_ZDIR)) ? ACC_TAP_NEGATIVE : ACC_TAP_POSITIVE;
+}
+
+enum Error acc_EnableEvents(struct acc_t *self, xQueueHandle queue)
+{
+	uint8_t conf[3], tap[2];
+
+	if(queue==NULL)
+		return ERROR_INVALID_ARGUMENT;
+
+	acc_eventQueue=queue;
+
+	if(acc_eventTaskHandle==NULL)
+	{
+		portBASE_TYPE ret = xTaskCreateStatic(acc_EventTask, (signed char* )"ACC EVT", ACC_TASK_STACK_SIZE, self,
+				ACC_TASK_PRIORITY, &acc_eventTaskHandle, acc_eventTaskStack, &acc_eventTaskBuffer);
+
+		enum Error error = errorConvert_portBASE_TYPE(ret);
+
+		if(error != ERROR_NONE)
+			return error;
+	}
+
+	// INT_O is driven by single tap event bit, double tap is always preceded by single tap so task reads both
+	conf[0]=ACC_ID_TAP;
+	conf[1]=(ACC_TAP_SINGLE_REG<<3) | ACC_TAPS_EVENT;
+	conf[2]=ACC_GPIO_POL_ACTIVE_LOW;
+	self->acc_MailboxSendConfig(self, ACC_ID_GPIO, conf, 3, ACC_GPIO_INTO_APP);
+
+	// read status once, so INT_O is released before EXTI is enabled
+	self->acc_MailboxReadData(self, ACC_ID_TAP, tap, 2, 0);
+
+	gpioConfigurePin(ACC_INT_GPIO, ACC_INT_PIN, ACC_INT_CONFIGURATION);
+
+	RCC->APB2ENR|=RCC_APB2ENR_SYSCFGEN;
+	SYSCFG->EXTICR[ACC_INT_EXTICR_index]=(SYSCFG->EXTICR[ACC_INT_EXTICR_index] & ~ACC_INT_EXTICR_mask) | ACC_INT_EXTICR;
+
+	EXTI->RTSR&= ~ACC_INT_EXTI_LINE;		// interrupt off at rising edge
+	EXTI->FTSR|=ACC_INT_EXTI_LINE;			// interrupt on at falling edge (INT_O active low)
+	EXTI->PR=ACC_INT_EXTI_LINE;				// clear pending request
+	EXTI->IMR|=ACC_INT_EXTI_LINE;
+
+	NVIC_SetPriority(ACC_INT_IRQn, ACC_INT_IRQ_PRIORITY);
+	NVIC_EnableIRQ(ACC_INT_IRQn);
+
+	return ERROR_NONE;
+}
+
+/**
+ * \brief Accelerometer event task.
+ *
+ * Sleeps until INT_O interrupt, then reads Tap Application once and sends decoded events to the event queue.
+ *
+ * \param [in] parameters is a pointer to driver structure
+ */
+static void acc_EventTask(void *parameters)
+{
+	struct acc_t *self=(struct acc_t *)parameters;
+	struct acc_event_t event;
+	uint8_t tap[2];
+
+	while(1)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);	// interrupts which came during reading are handled by one read
+
+		if(self->acc_MailboxReadData(self, ACC_ID_TAP, tap, 2, 0)==NULL || acc_eventQueue==NULL)
+			continue;
+
+		if(tap[0] & (1<<ACC_TAPS_EVENT))
+		{
+			acc_DecodeTap(tap[0], ACC_EVENT_SINGLE_TAP, &event);
+			xQueueSend(acc_eventQueue, &event, 0);
+		}
+		if(tap[1] & (1<<ACC_TAPD_EVENT))
+		{
+			acc_DecodeTap(tap[1], ACC_EVENT_DOUBLE_TAP, &event);
+			xQueueSend(acc_eventQueue, &event, 0);
+		}
+	}
+}
+
+/**
+ * \brief Checks if range a should be placed before range b in plan (sorting by application and offset).
+ */
+static bool acc_RangeBefore(const struct acc_read_range_t *a, const struct acc_read_range_t *b)
+{
+	if(a->app_id!=b->app_id)
+		return a->app_id<b->app_id;
+	return a->offset<b->offset;
+}
+
+enum Error acc_PlanRead(struct acc_t *self, struct acc_read_plan_t *plan, const struct acc_read_range_t *ranges,
+		uint8_t count)
+{
+	uint8_t order[ACC_PLAN_MAX_RANGES], i, j;
+
+	if(count>ACC_PLAN_MAX_RANGES)
+		return ERROR_BUFFER_OVERFLOW;
+
+	// sort ranges by application and offset (insertion sort, plans are small)
+	for(i=0;i<count;i++)
+	{
+		for(j=i;j>0 && acc_RangeBefore(&ranges[i], &ranges[order[j-1]]);j--)
+			order[j]=order[j-1];
+		order[j]=i;
+	}
+
+	plan->ranges=ranges;
+	plan->ranges_count=count;
+	plan->cycles_count=0;
+
+	for(i=0;i<count;i++)
+	{
+		const struct acc_read_range_t *range=&ranges[order[i]];
+		struct acc_read_cycle_t *cycle=&plan->cycles[plan->cycles_count];
+
+		if(range->size>ACC_MAILBOX_DATA_SIZE)
+			return ERROR_BUFFER_OVERFLOW;
+
+		if(plan->cycles_count!=0)
+		{
+			cycle--;								// try to extend last cycle
+			uint16_t end=range->offset+range->size;
+
+			// ranges are sorted, so the range starts in or after last cycle - a gap between them is read too,
+			// one mailbox request is cheaper than another ask/poll/read cycle
+			if(cycle->app_id==range->app_id && end-cycle->offset<=ACC_MAILBOX_DATA_SIZE)
+			{
+				if(end>cycle->offset+cycle->size)
+					cycle->size=end-cycle->offset;
+				plan->range_cycle[order[i]]=plan->cycles_count-1;
+				continue;
+			}
+
+			cycle++;								// doesn't fit - new cycle
+		}
+
+		cycle->app_id=range->app_id;
+		cycle->offset=range->offset;
+		cycle->size=range->size;
+		cycle->latency=0;
+		plan->range_cycle[order[i]]=plan->cycles_count++;
+	}
+
+	return ERROR_NONE;
+}
+
+enum Error acc_ExecutePlan(struct acc_t *self, struct acc_read_plan_t *plan)
+{
+	uint8_t response[ACC_MAILBOX_DATA_SIZE], i, j;
+	uint32_t start;
+
+	if(plan->cycles_count==0)
+		return ERROR_NONE;
+
+	CoreDebug->DEMCR|=CoreDebug_DEMCR_TRCENA_Msk;	// enable cycle counter for latency measurement
+	DWT->CTRL|=DWT_CTRL_CYCCNTENA_Msk;
+
+	start=DWT->CYCCNT;
+	self->acc_MailboxReadAsk(self, plan->cycles[0].app_id, plan->cycles[0].size, plan->cycles[0].offset);
+
+	for(i=0;i<plan->cycles_count;i++)
+	{
+		struct acc_read_cycle_t *cycle=&plan->cycles[i];
+
+		enum Error error=acc_MailboxTakeResponse(response, cycle->size);
+
+		cycle->latency=DWT->CYCCNT-start;
+
+		if(error!=ERROR_NONE)
+			return error;
+
+		// ask for the next cycle at once, ACC prepares it while data of this one is copied
+		if(i+1<plan->cycles_count)
+		{
+			start=DWT->CYCCNT;
+			self->acc_MailboxReadAsk(self, cycle[1].app_id, cycle[1].size, cycle[1].offset);
+		}
+
+		for(j=0;j<plan->ranges_count;j++)
+		{
+			const struct acc_read_range_t *range=&plan->ranges[j];
+
+			if(plan->range_cycle[j]==i)
+				memcpy(range->buffer, &response[range->offset-cycle->offset], range->size);
+		}
+	}
+
+	return ERROR_NONE;
+}
+
+const struct acc_read_plan_t * acc_ReadStatus(struct acc_t *self)
+{
+	uint8_t poss_buffer[6], frame_buffer[2];
+	const struct acc_read_range_t ranges[]=
+	{
+		{ACC_ID_AFE, 0, sizeof(poss_buffer), poss_buffer},
+		{ACC_ID_TAP, ACC_TAP_SINGLE_REG, sizeof(self->tap), self->tap},
+		{ACC_ID_FRAMEC, 0, sizeof(frame_buffer), frame_buffer},
+	};
+	static struct acc_read_plan_t plan;
+
+	// ranges point to buffers of this call, so the plan is prepared each time (three ranges, cheap)
+	enum Error error=self->acc_PlanRead(self, &plan, ranges, sizeof(ranges)/sizeof(ranges[0]));
+
+	if(error==ERROR_NONE)
+		error=self->acc_ExecutePlan(self, &plan);
+
+	plan.ranges=NULL;						// only cycles and their latency stay valid after return
+	plan.ranges_count=0;
+
+	if(error!=ERROR_NONE)
+		return NULL;
+
+	acc_DecodePoss(self, poss_buffer);
+	self->frame=(frame_buffer[0]<<8)| (frame_buffer[1]);
+
+	return &plan;
+}
+
 void
 acc_InitAFE(struct acc_t *self)
 {
@@ -305,6 +597,10 @@ struct acc_t * new_acc_driver(struct acc_config_t * config)
 		drv->acc_WakeUp = &acc_WakeUp;
 		drv->acc_GetPoss = &acc_GetPoss;
 		drv->acc_GetTap = &acc_GetTap;
+		drv->acc_EnableEvents = &acc_EnableEvents;
+		drv->acc_PlanRead = &acc_PlanRead;
+		drv->acc_ExecutePlan = &acc_ExecutePlan;
+		drv->acc_ReadStatus = &acc_ReadStatus;
 
 		drv->flush_buffer   = &flush_buffer;
 		drv->redirect_output= &redirect_output;
@@ -314,6 +610,29 @@ struct acc_t * new_acc_driver(struct acc_config_t * config)
 	return drv;
 }
 
+/*---------------------------------------------------------------------------------------------------------------------+
+| ISRs
++---------------------------------------------------------------------------------------------------------------------*/
 
+/**
+ * \brief ACC INT_O interrupt handler
+ *
+ * Wakes up acc_EventTask, reading of the ACC is not done in interrupt.
+ */
 
+extern "C" void ACC_INT_IRQHandler(void) __attribute__ ((interrupt));
+void ACC_INT_IRQHandler(void)
+{
+	struct RuntimeIsr isr;
+	signed portBASE_TYPE higher_priority_task_woken = pdFALSE;
+
+	runtimeIsrEnter(&isr);
+
+	EXTI->PR=ACC_INT_EXTI_LINE;				// clear pending request
 
+	vTaskNotifyGiveFromISR(acc_eventTaskHandle, &higher_priority_task_woken);
+
+	runtimeIsrExit(&isr, RUNTIME_ISR_GROUP_SENSORS);
+
+	portEND_SWITCHING_ISR(higher_priority_task_woken);
+}
@@ -1,6 +1,11 @@
 #ifndef ACC_H_
 #define ACC_H_
 
+#include "FreeRTOS.h"
+#include "queue.h"
+
+#include "error.h"
+
 /**
  * \brief Driver for ACC - MMA955xL
  *
@@ -17,6 +22,52 @@
 typedef enum {RANDOM, IMMEDIATE, SEARCH} strategy_t; // \todo Do czego ten typ?
 typedef enum {Female, Male} Gender_t;
 
+/// type of event sent by the driver to the event queue
+typedef enum {ACC_EVENT_SINGLE_TAP, ACC_EVENT_DOUBLE_TAP} acc_event_type_t;
+
+/// direction of tap detected on one axis
+typedef enum {ACC_TAP_NONE, ACC_TAP_POSITIVE, ACC_TAP_NEGATIVE} acc_tap_dir_t;
+
+/// event sent by the driver to the event queue, already decoded from Tap Application status
+struct acc_event_t
+{
+	acc_event_type_t type;
+	acc_tap_dir_t x;
+	acc_tap_dir_t y;
+	acc_tap_dir_t z;
+};
+
+
+/// maximal number of ranges in one read plan
+#define ACC_PLAN_MAX_RANGES		8
+
+/// one range of registers which user wants to read from ACC application
+struct acc_read_range_t
+{
+	uint8_t app_id;
+	uint8_t offset;
+	uint8_t size;
+	uint8_t *buffer;		///< destination of read data, at least size bytes
+};
+
+/// one mailbox read request (ask/poll/read cycle) created from merged ranges
+struct acc_read_cycle_t
+{
+	uint8_t app_id;
+	uint8_t offset;
+	uint8_t size;
+	uint32_t latency;		///< cycles of the core from ask to complete response, updated by each execution
+};
+
+/// read plan - ranges grouped into minimal set of mailbox requests
+struct acc_read_plan_t
+{
+	const struct acc_read_range_t *ranges;
+	uint8_t ranges_count;
+	uint8_t range_cycle[ACC_PLAN_MAX_RANGES];	///< index of cycle which delivers each range
+	struct acc_read_cycle_t cycles[ACC_PLAN_MAX_RANGES];
+	uint8_t cycles_count;
+};
 
 //Driver configuration
 
@@ -123,7 +174,7 @@ struct acc_config_t
      * \param [in] Size of buffer
      * \param [in] Reading register offset
      *
-     * \return Pointer to our buffer
+     * \return Pointer to our buffer, NULL if ACC didn't complete response (buffer is zeroed)
      * @todo errors
      * @todo opoznienie w odczycie, najlepiej na przerwaniach licznika, bd ustawienie
      * przerwania od ACC, ktre wiadczy o gotowoci danych
@@ -209,6 +260,63 @@ struct acc_config_t
     uint8_t  (* acc_GetTap) ( struct acc_t * );
 
 
+    /**
+     * \brief Enables interrupt driven tap detection.
+     * It maps Tap Application status to INT_O pin of ACC, configures EXTI line of this pin and
+     * starts driver task. Task reads Tap Application only after interrupt, decodes direction
+     * and sends struct acc_event_t for every detected single and double tap to the queue.
+     * After this acc_GetTap doesn't have to be polled.
+     * Orientation (Landscape/Portrait Application) is not delivered - INT_O is driven by
+     * a single status bit of one application, which is used by tap detection.
+     *
+     * \param [in] Queue for struct acc_event_t items, not NULL
+     *
+     * \return ERROR_NONE on success, ERROR_INVALID_ARGUMENT if queue is NULL, otherwise an error
+     * code defined in the file error.h
+     */
+    enum Error (* acc_EnableEvents) ( struct acc_t *, xQueueHandle queue );
+
+
+    /**
+     * \brief Prepares read plan for a few ranges of application registers.
+     * Ranges of the same application are merged into one mailbox request as long as it fits
+     * into mailbox, also when there is a gap between them (the gap is read and dropped).
+     * Plan can be executed many times.
+     *
+     * \param [out] Plan to prepare
+     * \param [in] Table of ranges, must be valid as long as plan is used
+     * \param [in] Number of ranges, max ACC_PLAN_MAX_RANGES
+     *
+     * \return ERROR_NONE on success, ERROR_BUFFER_OVERFLOW if ranges don't fit into plan or mailbox
+     */
+    enum Error (* acc_PlanRead) ( struct acc_t *, struct acc_read_plan_t *plan,
+    		const struct acc_read_range_t *ranges, uint8_t count );
+
+
+    /**
+     * \brief Executes read plan.
+     * Next request is sent to ACC just after the response for previous one is taken, so copying
+     * of data to ranges' buffers is done while ACC prepares the next response. Latency of each
+     * cycle (in core cycles) is stored in plan.
+     *
+     * \param [in] Prepared plan
+     *
+     * \return ERROR_NONE on success, ERROR_TIMEOUT if ACC didn't complete a response
+     */
+    enum Error (* acc_ExecutePlan) ( struct acc_t *, struct acc_read_plan_t *plan );
+
+
+    /**
+     * \brief Reads AFE position, tap status and frame count in one pipelined plan.
+     * It updates position, tap and frame of driver structure, like acc_GetPoss, acc_GetTap and
+     * acc_GetFarmeCount do.
+     *
+     * \return Pointer to plan used for reading, so latency of each cycle can be checked (its
+     * ranges are not valid after return), NULL if plan couldn't be prepared or executed
+     */
+    const struct acc_read_plan_t * (* acc_ReadStatus) ( struct acc_t * );
+
+
     /**
      *
      *
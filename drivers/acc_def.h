@@ -33,6 +33,17 @@
 #define ACC_ID_RESET_CLC	0x17
 #define ACC_ID_MAILCONF		0x18
 
+/*---------------------------------------------------------------------------------------------------------------------+
+| ACC GPIO Application Registers (INT_O pin mapping)
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define ACC_GPIO_INTO_APP		0x00	// ID of application which status drives INT_O pin
+#define ACC_GPIO_INTO_BIT		0x01	// status register offset (bits 7:3) and bit number (bits 2:0)
+#define ACC_GPIO_INTO_POL		0x02	// INT_O polarity
+// Bits definitions
+#define ACC_GPIO_POL_ACTIVE_LOW			0
+#define ACC_GPIO_POL_ACTIVE_HIGH		1
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | ACC I2C Transmission Commands
 +---------------------------------------------------------------------------------------------------------------------*/
@@ -111,6 +122,15 @@
 #define ACC_SPI_WRITE_ADDRESS				0x80
 #define ACC_SPI_READ_DEALY					36000
 
+ /*---------------------------------------------------------------------------------------------------------------------+
+ | ACC Mailbox
+ +---------------------------------------------------------------------------------------------------------------------*/
+
+#define ACC_MAILBOX_HEADER_SIZE				4		// app ID, COCO/error byte, count, requested count
+#define ACC_MAILBOX_DATA_SIZE				28		// 32 mailbox registers minus response header
+#define ACC_MAILBOX_COCO					0x80	// command complete flag in second byte of response
+#define ACC_MAILBOX_TIMEOUT_us				20000	// time of polling response header before the ACC is considered dead
+
 
 
 #endif /* ACC_DEF_H_ */
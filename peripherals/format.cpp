@@ -0,0 +1,221 @@
+/**
+ * \file format.cpp
+ * \brief Number formatting
+ *
+ * Integer-only formatting of scaled integers, Q-format numbers and time for LCD, UART and logs. Digits are split in
+ * pairs with a lookup table, no float and no library calls are used.
+ *
+ * prefix: format
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "format.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static char* _formatDigits(char* end, uint32_t value, uint8_t count);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// ASCII digits of all numbers 00 - 99, two chars per number
+static const char _digitPairs[200] =
+{
+	'0','0', '0','1', '0','2', '0','3', '0','4', '0','5', '0','6', '0','7', '0','8', '0','9',
+	'1','0', '1','1', '1','2', '1','3', '1','4', '1','5', '1','6', '1','7', '1','8', '1','9',
+	'2','0', '2','1', '2','2', '2','3', '2','4', '2','5', '2','6', '2','7', '2','8', '2','9',
+	'3','0', '3','1', '3','2', '3','3', '3','4', '3','5', '3','6', '3','7', '3','8', '3','9',
+	'4','0', '4','1', '4','2', '4','3', '4','4', '4','5', '4','6', '4','7', '4','8', '4','9',
+	'5','0', '5','1', '5','2', '5','3', '5','4', '5','5', '5','6', '5','7', '5','8', '5','9',
+	'6','0', '6','1', '6','2', '6','3', '6','4', '6','5', '6','6', '6','7', '6','8', '6','9',
+	'7','0', '7','1', '7','2', '7','3', '7','4', '7','5', '7','6', '7','7', '7','8', '7','9',
+	'8','0', '8','1', '8','2', '8','3', '8','4', '8','5', '8','6', '8','7', '8','8', '8','9',
+	'9','0', '9','1', '9','2', '9','3', '9','4', '9','5', '9','6', '9','7', '9','8', '9','9',
+};
+
+/// powers of 10 which fit in uint32_t
+static const uint32_t _powersOf10[10] =
+{
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Writes two decimal digits.
+ *
+ * \param [out] buffer is the place for two chars, no '\0' is written
+ * \param [in] value is the number to write, allowed values {0; 99}
+ *
+ * \return pointer to the char after written digits
+ */
+
+char* formatTwoDigits(char* buffer, uint8_t value)
+{
+	const char* pair = &_digitPairs[2 * (value % 100)];
+
+	buffer[0] = pair[0];
+	buffer[1] = pair[1];
+
+	return buffer + 2;
+}
+
+/**
+ * \brief Formats scaled integer as fixed point decimal number.
+ *
+ * Value is a number multiplied by 10^scale (e.g. hundredths of degree have scale 2). It is rounded to precision
+ * digits after the dot and written in the field of width digits before the dot. Leading zeros are replaced by spaces,
+ * minus sign takes place of the first space, so it needs one column of width. Values rounded to 0 have no sign. If the
+ * digits and the sign do not fit in width, all digits of the field are replaced by '-' (e.g. "--.-") and the length is
+ * the same.
+ *
+ * \param [out] buffer is the place for width + precision + 2 chars
+ * \param [in] value is the scaled integer
+ * \param [in] scale is the number of decimal fraction digits of value, allowed values {0; 9}
+ * \param [in] width is the number of digits before the dot, allowed values {1; 10}
+ * \param [in] precision is the number of digits after the dot (no dot if 0), allowed values {0; 9}
+ *
+ * \return number of chars written, without terminating '\0'
+ */
+
+size_t formatFixed(char* buffer, int32_t value, uint8_t scale, uint8_t width, uint8_t precision)
+{
+	uint32_t magnitude = (value < 0) ? -(uint32_t)value : (uint32_t)value;
+	size_t length = width + (precision != 0 ? precision + 1 : 0);
+	char* end = buffer + length;
+	char* first;
+
+	if (scale > precision)
+	{
+		uint32_t divider = _powersOf10[scale - precision];
+		magnitude = (magnitude + divider / 2) / divider;
+	}
+	else
+		magnitude *= _powersOf10[precision - scale];
+
+	uint32_t integer = magnitude / _powersOf10[precision];
+	bool negative = value < 0 && magnitude != 0;
+	uint8_t digits = 1;
+
+	while (digits < 10 && integer >= _powersOf10[digits])
+		digits++;
+
+	*end = '\0';
+
+	if (digits + negative > width)
+	{
+		for (char* ptr = buffer; ptr < end; ptr++)
+			*ptr = '-';
+
+		if (precision != 0)
+			buffer[width] = '.';
+
+		return length;
+	}
+
+	if (precision != 0)
+	{
+		end = _formatDigits(end, magnitude % _powersOf10[precision], precision);
+		*--end = '.';
+		magnitude /= _powersOf10[precision];
+	}
+
+	first = _formatDigits(end, magnitude, width);
+
+	// leading zeros to spaces, last digit before the dot stays
+	while (first < end - 1 && *first == '0')
+		*first++ = ' ';
+
+	if (negative == true)
+		first[-1] = '-';
+
+	return length;
+}
+
+/**
+ * \brief Formats Q-format fixed point number as decimal number.
+ *
+ * Number is converted to scaled integer with precision decimal digits (rounded) and written with formatFixed().
+ *
+ * \param [out] buffer is the place for width + precision + 2 chars
+ * \param [in] value is the Q-format number
+ * \param [in] fraction_bits is the number of fraction bits of value (e.g. 4 for Q8.4), allowed values {0; 31}
+ * \param [in] width is the number of digits before the dot, allowed values {1; 10}
+ * \param [in] precision is the number of digits after the dot (no dot if 0), allowed values {0; 9}
+ *
+ * \return number of chars written, without terminating '\0'
+ */
+
+size_t formatQ(char* buffer, int32_t value, uint8_t fraction_bits, uint8_t width, uint8_t precision)
+{
+	uint64_t magnitude = (value < 0) ? -(uint64_t)value : (uint64_t)value;
+	int32_t scaled;
+
+	magnitude *= _powersOf10[precision];
+	if (fraction_bits != 0)
+		magnitude = (magnitude + (1ULL << (fraction_bits - 1))) >> fraction_bits;
+
+	scaled = (int32_t)magnitude;
+
+	return formatFixed(buffer, (value < 0) ? -scaled : scaled, precision, width, precision);
+}
+
+/**
+ * \brief Formats time as "hh:mm:ss".
+ *
+ * \param [out] buffer is the place for FORMAT_TIME_LENGTH + 1 chars
+ * \param [in] time is the table with hours, minutes and seconds in binary format (not BCD)
+ *
+ * \return number of chars written, without terminating '\0'
+ */
+
+size_t formatTime(char* buffer, const uint8_t* time)
+{
+	char* ptr = buffer;
+
+	ptr = formatTwoDigits(ptr, time[0]);
+	*ptr++ = ':';
+	ptr = formatTwoDigits(ptr, time[1]);
+	*ptr++ = ':';
+	ptr = formatTwoDigits(ptr, time[2]);
+	*ptr = '\0';
+
+	return FORMAT_TIME_LENGTH;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Writes decimal digits backwards, two at a time.
+ *
+ * \param [in] end is the pointer after the last digit
+ * \param [in] value is the number to write, higher digits which do not fit in count are dropped
+ * \param [in] count is the number of digits, leading zeros are written
+ *
+ * \return pointer to the first digit
+ */
+
+static char* _formatDigits(char* end, uint32_t value, uint8_t count)
+{
+	while (count >= 2)
+	{
+		end -= 2;
+		formatTwoDigits(end, value % 100);
+		value /= 100;
+		count -= 2;
+	}
+
+	if (count != 0)
+		*--end = (char)('0' + value % 10);
+
+	return end;
+}
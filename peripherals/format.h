@@ -0,0 +1,30 @@
+/**
+ * \file format.h
+ * \brief Header for format.cpp
+ */
+
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global defines
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define FORMAT_TIME_LENGTH					8	///< length of "hh:mm:ss" without terminating '\0'
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+char* formatTwoDigits(char* buffer, uint8_t value);
+
+size_t formatFixed(char* buffer, int32_t value, uint8_t scale, uint8_t width, uint8_t precision);
+
+size_t formatQ(char* buffer, int32_t value, uint8_t fraction_bits, uint8_t width, uint8_t precision);
+
+size_t formatTime(char* buffer, const uint8_t* time);
+
+#endif /* FORMAT_H_ */
@@ -18,16 +18,6 @@
 
 #include "gpio.h"
 
-/*---------------------------------------------------------------------------------------------------------------------+
-| local defines
-+---------------------------------------------------------------------------------------------------------------------*/
-
-#define GPIO_GET_MODER(combination)			(((combination) & 0xF) >> 0)
-#define GPIO_GET_OTYPER(combination)		(((combination) & 0xF0) >> 4)
-#define GPIO_GET_OSPEEDR(combination)		(((combination) & 0xF00) >> 8)
-#define GPIO_GET_PUPDR(combination)			(((combination) & 0xF000) >> 12)
-#define GPIO_GET_AFR(combination)			(((combination) & 0xF0000) >> 16)
-
 /*---------------------------------------------------------------------------------------------------------------------+
 | global functions
 +---------------------------------------------------------------------------------------------------------------------*/
@@ -153,3 +143,67 @@ void gpioConfigurePort(GPIO_TypeDef *port, enum GpioConfiguration configuration)
 
 }
 
+/**
+ * \brief Configures many pins of one port.
+ *
+ * Configures all pins selected by mask with the same configuration. Each register of the port is written once.
+ *
+ * \param [in] port points to the configuration structure of desired port
+ * \param [in] pins is the mask of pins, bit n selects pin n, use GPIO_PIN_MASK()
+ * \param [in] configuration is a combined value of MODER, OTYPER, OSPEEDR, PUPDR and AFRx register bitfields, allowed
+ * values as for gpioConfigurePin()
+ */
+
+void gpioConfigurePins(GPIO_TypeDef *port, uint16_t pins, enum GpioConfiguration configuration)
+{
+	const struct GpioPinGroup group = GPIO_PIN_GROUP(port, pins, configuration);
+
+	gpioConfigurePinGroups(&group, 1);
+}
+
+/**
+ * \brief Configures groups of pins.
+ *
+ * Register values of the groups are usually computed at compile time with GPIO_PIN_GROUP(). Consecutive groups of the
+ * same port are merged, so each register of the port is written once - list groups of one port together.
+ *
+ * \param [in] groups points to the table of groups
+ * \param [in] count is the number of groups in the table
+ */
+
+void gpioConfigurePinGroups(const struct GpioPinGroup *groups, size_t count)
+{
+	while (count != 0)
+	{
+		GPIO_TypeDef *port = groups->port;
+		uint32_t pins = 0, mask2 = 0, mask_afrl = 0, mask_afrh = 0;
+		uint32_t moder = 0, otyper = 0, ospeedr = 0, pupdr = 0, afrl = 0, afrh = 0;
+
+		do									// merge groups of the same port
+		{
+			pins |= groups->pins;
+			mask2 |= groups->mask2;
+			mask_afrl |= groups->maskAfr[0];
+			mask_afrh |= groups->maskAfr[1];
+			moder |= groups->moder;
+			otyper |= groups->otyper;
+			ospeedr |= groups->ospeedr;
+			pupdr |= groups->pupdr;
+			afrl |= groups->afr[0];
+			afrh |= groups->afr[1];
+
+			groups++;
+			count--;
+		} while (count != 0 && groups->port == port);
+
+		port->MODER = (port->MODER & ~mask2) | moder;
+		port->OTYPER = (port->OTYPER & ~pins) | otyper;
+		port->OSPEEDR = (port->OSPEEDR & ~mask2) | ospeedr;
+		port->PUPDR = (port->PUPDR & ~mask2) | pupdr;
+
+		if (mask_afrl != 0)
+			port->AFR[0] = (port->AFR[0] & ~mask_afrl) | afrl;
+		if (mask_afrh != 0)
+			port->AFR[1] = (port->AFR[1] & ~mask_afrh) | afrh;
+	}
+}
@@ -9,6 +9,9 @@
 #ifndef GPIO_H_
 #define GPIO_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "stm32l152xb.h"
 
 #include "hdr/hdr_gpio.h"
@@ -19,6 +22,21 @@
 
 #define GPIO_COMBINE(moder, otyper, ospeedr, pupdr, afr)	((moder) | ((otyper) << 4) | ((ospeedr) << 8) | ((pupdr) << 12) | ((afr) << 16))
 
+#define GPIO_GET_MODER(combination)			(((combination) & 0xF) >> 0)
+#define GPIO_GET_OTYPER(combination)		(((combination) & 0xF0) >> 4)
+#define GPIO_GET_OSPEEDR(combination)		(((combination) & 0xF00) >> 8)
+#define GPIO_GET_PUPDR(combination)			(((combination) & 0xF000) >> 12)
+#define GPIO_GET_AFR(combination)			(((combination) & 0xF0000) >> 16)
+
+#define GPIO_PIN_MASK(pin)					(1U << (pin))	///< bit of the pin in the mask of pins
+
+/// register values for pins of one port with the same configuration, computed at compile time for constant arguments
+#define GPIO_PIN_GROUP(port, pins, configuration)	{(port), (uint32_t)(pins), gpioSpread2(pins) * GPIO_MODER_mask, \
+		{gpioSpread4((pins) & 0xFF) * GPIO_AFRx_mask, gpioSpread4((pins) >> 8) * GPIO_AFRx_mask}, \
+		gpioSpread2(pins) * GPIO_GET_MODER(configuration), (uint32_t)(pins) * GPIO_GET_OTYPER(configuration), \
+		gpioSpread2(pins) * GPIO_GET_OSPEEDR(configuration), gpioSpread2(pins) * GPIO_GET_PUPDR(configuration), \
+		{gpioSpread4((pins) & 0xFF) * GPIO_GET_AFR(configuration), gpioSpread4((pins) >> 8) * GPIO_GET_AFR(configuration)}}
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | global variables' types
 +---------------------------------------------------------------------------------------------------------------------*/
@@ -471,6 +489,20 @@ enum GpioConfiguration
 	GPIO_ANALOG = GPIO_COMBINE(GPIO_MODER_ANALOG_value, 0, 0, GPIO_PUPDR_FLOATING_value, 0),
 };
 
+/// pins of one port with the same configuration, fields are created with GPIO_PIN_GROUP()
+struct GpioPinGroup
+{
+	GPIO_TypeDef *port;						///< port of the pins
+	uint32_t pins;							///< mask of pins, also mask of OTYPER
+	uint32_t mask2;							///< mask of MODER, OSPEEDR and PUPDR
+	uint32_t maskAfr[2];					///< masks of AFRL and AFRH
+	uint32_t moder;							///< values of register fields of the pins
+	uint32_t otyper;
+	uint32_t ospeedr;
+	uint32_t pupdr;
+	uint32_t afr[2];
+};
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | global functions' declarations
 +---------------------------------------------------------------------------------------------------------------------*/
@@ -478,5 +510,130 @@ enum GpioConfiguration
 void gpioInitialize(void);
 void gpioConfigurePin(GPIO_TypeDef *port_ptr, enum GpioPin pin, enum GpioConfiguration configuration);
 void gpioConfigurePort(GPIO_TypeDef *port, enum GpioConfiguration configuration);
+void gpioConfigurePins(GPIO_TypeDef *port, uint16_t pins, enum GpioConfiguration configuration);
+void gpioConfigurePinGroups(const struct GpioPinGroup *groups, size_t count);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Shifts the bits of a 16-bit pin mask apart by one bit, evaluated at compile time for constant mask.
+ */
+
+constexpr uint32_t gpioSpreadStep(uint32_t value, uint8_t shift, uint32_t mask)
+{
+	return (value | (value << shift)) & mask;
+}
+
+/**
+ * \brief Converts mask of pins to mask with bit 2 * n set for each pin n (MODER, OSPEEDR, PUPDR layout).
+ */
+
+constexpr uint32_t gpioSpread2(uint32_t pins)
+{
+	return gpioSpreadStep(gpioSpreadStep(gpioSpreadStep(gpioSpreadStep(pins & 0xFFFF, 8, 0x00FF00FF), 4, 0x0F0F0F0F),
+			2, 0x33333333), 1, 0x55555555);
+}
+
+/**
+ * \brief Converts mask of 8 pins to mask with bit 4 * n set for each pin n (AFRL, AFRH layout).
+ */
+
+constexpr uint32_t gpioSpread4(uint32_t pins)
+{
+	return gpioSpreadStep(gpioSpreadStep(gpioSpreadStep(pins & 0xFF, 12, 0x000F000F), 6, 0x03030303), 3, 0x11111111);
+}
+
+/**
+ * \brief Checks whether the address is the base address of a GPIO port.
+ */
+
+constexpr bool gpioIsPort(uint32_t base)
+{
+	return base == GPIOA_BASE || base == GPIOB_BASE || base == GPIOC_BASE || base == GPIOD_BASE || base == GPIOE_BASE ||
+			base == GPIOH_BASE;
+}
+
+/**
+ * \brief Pin known at compile time.
+ *
+ * Each operation compiles to a single access to BSRR or IDR of the port, no read-modify-write is needed. Port and pin
+ * are checked at compile time.
+ *
+ * \tparam base is the base address of the port (GPIOx_BASE)
+ * \tparam pin is the pin number
+ */
+
+template<uint32_t base, enum GpioPin pin>
+struct Pin
+{
+	static_assert(gpioIsPort(base), "base is not the base address of a GPIO port");
+	static_assert(pin <= GPIO_PIN_15, "invalid pin number");
+
+	static constexpr uint32_t portBase = base;	///< base address of the port
+	static constexpr uint16_t mask = GPIO_PIN_MASK(pin);	///< bit of the pin in port registers
+
+	/// \return pointer to the port of the pin
+	static GPIO_TypeDef* port() { return reinterpret_cast<GPIO_TypeDef*>(base); }
+
+	/// \brief Sets output of the pin to high level.
+	static void set() { port()->BSRR = mask; }
+
+	/// \brief Sets output of the pin to low level.
+	static void clear() { port()->BSRR = static_cast<uint32_t>(mask) << 16; }
+
+	/// \brief Sets output of the pin to given level.
+	static void write(bool level) { port()->BSRR = level == true ? static_cast<uint32_t>(mask) : static_cast<uint32_t>(mask) << 16; }
+
+	/// \return input level of the pin
+	static bool read() { return (port()->IDR & mask) != 0; }
+
+	/// \brief Configures the pin, see gpioConfigurePin().
+	static void configure(enum GpioConfiguration configuration) { gpioConfigurePin(port(), pin, configuration); }
+};
+
+/**
+ * \brief Pins of one port, changed together with a single write to BSRR.
+ *
+ * \tparam First is the first pin, Pin<>
+ * \tparam Others are other pins, all of them must be in the port of the first pin
+ */
+
+template<typename First, typename... Others>
+struct PinSet
+{
+	static constexpr uint32_t portBase = First::portBase;	///< base address of the port
+	static constexpr uint16_t mask = First::mask | PinSet<Others...>::mask;	///< bits of the pins in port registers
+
+	static_assert(PinSet<Others...>::portBase == portBase, "pins of PinSet must belong to one port");
+	static_assert((First::mask & PinSet<Others...>::mask) == 0, "pins of PinSet must not repeat");
+
+	/// \return pointer to the port of the pins
+	static GPIO_TypeDef* port() { return First::port(); }
+
+	/// \brief Sets outputs of all pins to high level.
+	static void set() { port()->BSRR = mask; }
+
+	/// \brief Sets outputs of all pins to low level.
+	static void clear() { port()->BSRR = static_cast<uint32_t>(mask) << 16; }
+
+	/// \brief Sets outputs of the pins to the levels of corresponding bits of the value (bit n - pin n), atomically.
+	static void write(uint16_t value) { port()->BSRR = (value & mask) | (static_cast<uint32_t>(~value & mask) << 16); }
+
+	/// \return input levels of the pins (bit n - pin n), other bits are cleared
+	static uint16_t read() { return port()->IDR & mask; }
+
+	/// \brief Configures all pins, see gpioConfigurePins().
+	static void configure(enum GpioConfiguration configuration) { gpioConfigurePins(port(), mask, configuration); }
+};
+
+/// one pin as the last element of PinSet
+template<typename Last>
+struct PinSet<Last>
+{
+	static constexpr uint32_t portBase = Last::portBase;
+	static constexpr uint16_t mask = Last::mask;
+};
 
 #endif /* GPIO_H_ */
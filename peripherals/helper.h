@@ -1,6 +1,6 @@
 /**
  * \file helper.h
- * \brief Helper macros and header for helper.cpp
+ * \brief Helper macros
  * \author: Mazeryt Freager
  * \date 2014-07-20
  */
@@ -24,24 +24,4 @@
 #define ASSERT(message, assertion)			do { if (!(assertion)) \
 											PLATFORM_ASSERT(message); } while (0)
 
-/*---------------------------------------------------------------------------------------------------------------------+
-| global variables
-+---------------------------------------------------------------------------------------------------------------------*/
-
-extern volatile uint16_t tim6OverflowCount;
-
-/*---------------------------------------------------------------------------------------------------------------------+
-| global functions' prototypes
-+---------------------------------------------------------------------------------------------------------------------*/
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-void configureTimerForRuntimestats(void);
-
-#ifdef __cplusplus
-}
-#endif
-
 #endif /* HELPER_H_ */
@@ -23,6 +23,25 @@
 #include "gpio.h"
 #include "rcc.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static void _clockPreChange(uint32_t frequency);
+static void _clockPostChange(uint32_t frequency);
+static void _setTimings(uint32_t frequency);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+static xSemaphoreHandle _lock;				///< lock of the bus, held for transactions and changes of core frequency
+static xStaticQueue _lockBuffer;
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | global functions
 +---------------------------------------------------------------------------------------------------------------------*/
@@ -30,25 +49,55 @@
 /**
  * \brief Initializes I2C module
  *
- * Configures I/Os of I2C, enable clock for I2C module and configures it.
+ * Configures I/Os of I2C, enable clock for I2C module and configures it. Each driver of a chip on the bus calls it,
+ * the lock of the bus is created only once.
  */
 
 void i2cInitialize(void)
 {
-	gpioConfigurePin(I2Cx_SCL_GPIO, I2Cx_SCL_PIN, I2Cx_SCL_CONFIGURATION);
-	gpioConfigurePin(I2Cx_SDA_GPIO, I2Cx_SDA_PIN, I2Cx_SDA_CONFIGURATION);
+	if (_lock == NULL)
+		_lock = xSemaphoreCreateMutexStatic(&_lockBuffer);
 
-	RCC_APBxENR_I2CxEN_bb = 1;				// enable clock for I2C module
+	static const struct GpioPinGroup pins[] =
+	{
+			GPIO_PIN_GROUP(I2Cx_SCL_GPIO, GPIO_PIN_MASK(I2Cx_SCL_PIN), I2Cx_SCL_CONFIGURATION),
+			GPIO_PIN_GROUP(I2Cx_SDA_GPIO, GPIO_PIN_MASK(I2Cx_SDA_PIN), I2Cx_SDA_CONFIGURATION),
+	};
 
-	uint32_t frequency = rccGetCoreFrequency();
+	gpioConfigurePinGroups(pins, sizeof(pins) / sizeof(pins[0]));
+
+	RCC_APBxENR_I2CxEN_bb = 1;				// enable clock for I2C module
 
 	I2Cx_CR1_SWRST_bb(I2Cx) = 1;			// force software reset of I2C peripheral
 	I2Cx_CR1_SWRST_bb(I2Cx) = 0;
 
-	I2Cx->TRISE = frequency / 1000000 + 1;	// limit slope (standard mode)
-	I2Cx->CCR = frequency / I2C_FREQUENCY / 2;	// setup clock
-	I2Cx->CR2 = (frequency / 1000000) << I2C_CR2_FREQ_bit;	// config I2C module's frequency
-	I2Cx_CR1_PE_bb(I2Cx) = 1;				// enable peripheral
+	_setTimings(rccGetCoreFrequency());		// setup timings and enable peripheral
+
+	rccRegisterClockCallbacks(_clockPreChange, _clockPostChange);
+}
+
+/**
+ * \brief Locks the bus for a transaction.
+ *
+ * Transaction (e.g. i2cWriteOneByteWhithoutStop() followed by i2cRead()) must be done with the bus locked, so no other
+ * task interleaves its transfers and the core frequency doesn't change in the middle - rccSetClock() holds the lock from
+ * the notification before the change till the one after it. Does nothing when the scheduler is not running.
+ */
+
+void i2cLock(void)
+{
+	if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+		xSemaphoreTake(_lock, portMAX_DELAY);
+}
+
+/**
+ * \brief Unlocks the bus locked with i2cLock().
+ */
+
+void i2cUnlock(void)
+{
+	if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+		xSemaphoreGive(_lock);
 }
 
 /**
@@ -144,9 +193,55 @@ void i2cWriteOneByteWhithoutStop(uint8_t address, uint8_t data)
 	while (I2Cx_SR1_TxE_bb(I2Cx) == 0 || I2Cx_SR1_BTF_bb(I2Cx) == 1);	// wait for bus not-busy
 }
 
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
 
+/**
+ * \brief Locks the bus and waits for it to be free before the change of core frequency.
+ *
+ * The lock is held till _clockPostChange(), so no transaction is started with timings of the old frequency.
+ *
+ * \param [in] frequency is the new frequency of the core in Hz
+ */
 
+static void _clockPreChange(uint32_t frequency)
+{
+	(void) frequency;						// suppress warning
 
+	i2cLock();
 
+	while (I2Cx_SR2_BUSY_bb(I2Cx) == 1);	// wait for bus not-busy
+}
+
+/**
+ * \brief Sets I2C timings for new core frequency and unlocks the bus locked by _clockPreChange().
+ *
+ * \param [in] frequency is the new frequency of the core in Hz
+ */
+
+static void _clockPostChange(uint32_t frequency)
+{
+	_setTimings(frequency);
 
+	i2cUnlock();
+}
+
+/**
+ * \brief Sets I2C timings for the frequency of the core.
+ *
+ * The peripheral is disabled while timings are changed. I2C needs at least 2MHz of core frequency.
+ *
+ * \param [in] frequency is the frequency of the core in Hz
+ */
+
+static void _setTimings(uint32_t frequency)
+{
+	I2Cx_CR1_PE_bb(I2Cx) = 0;				// timings can be changed only when peripheral is disabled
+
+	I2Cx->TRISE = frequency / 1000000 + 1;	// limit slope (standard mode)
+	I2Cx->CCR = frequency / I2C_FREQUENCY / 2;	// setup clock
+	I2Cx->CR2 = (frequency / 1000000) << I2C_CR2_FREQ_bit;	// config I2C module's frequency
+	I2Cx_CR1_PE_bb(I2Cx) = 1;				// enable peripheral
+}
 
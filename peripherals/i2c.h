@@ -16,6 +16,8 @@
 +---------------------------------------------------------------------------------------------------------------------*/
 
 void i2cInitialize(void);
+void i2cLock(void);
+void i2cUnlock(void);
 uint8_t* i2cRead(uint8_t address, uint8_t *data, size_t length);
 void i2cWrite(uint8_t address, const uint8_t *data, size_t length);
 void i2cWriteOneByteWhithoutStop(uint8_t address, uint8_t data);
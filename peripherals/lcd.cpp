@@ -9,8 +9,11 @@
 #include "gpio.h"
 #include "lcd.h"
 #include "bsp.h"
+#include "config.h"
+#include "rtc.h"
+#include "runtime.h"
+#include "format.h"
 #include <string.h>
-#include <stdlib.h>
 
 /**
   @verbatim
@@ -47,12 +50,86 @@ MSB   { 1 , 1 , 0 , 0   }
   @endverbatim
 */
 
+/*---------------------------------------------------------------------------------------------------------------------+
+ | local functions' declarations
+ +---------------------------------------------------------------------------------------------------------------------*/
+
+static void LCD_ComposeChar(char ch, bool point, bool column, uint8_t position);
+static void LCD_ComposeWord(uint8_t index, uint32_t word);
+static void LCD_CommitFrame(void);
+static void LCD_CopyFrame(void);
+static void LCD_ModifyFCR(uint32_t clear, uint32_t set);
+static void LCD_ScrollStep(void);
+
 /*---------------------------------------------------------------------------------------------------------------------+
  | local variables
  +---------------------------------------------------------------------------------------------------------------------*/
 
+static uint32_t _frame[LCD_FRAME_WORDS];	///< frame being composed, only even words (COM0 - COM3, SEG0 - SEG31) are used
+static volatile uint8_t _dirty;				///< bit n set if _frame[n] was changed since the last commit
+static uint32_t _committed[LCD_FRAME_WORDS];	///< frame committed by LCD_Commit(), the only source of LCD RAM
+static volatile uint8_t _pending;			///< bit n set if _committed[n] has to be written to LCD RAM
+static uint32_t _blank = 0xFFFFFFFF;		///< mask clearing digits in the off phase of blinking, applied to LCD RAM
+
+// animation engine, driven by start of frame interrupt
+static char _scrollText[LCD_SCROLL_MAX_LENGTH + LCD_NUMBER_OF_DIGITS];	///< text followed by blank digits
+static volatile uint8_t _scrollLength;		///< length of _scrollText, 0 if scrolling is off
+static uint8_t _scrollOffset;				///< index of char shown on the first digit
+static uint8_t _scrollPeriod;				///< frames between steps of scrolling
+static uint8_t _scrollCounter;				///< frames left to next step of scrolling
+static volatile uint8_t _blinkDigits;		///< bit n - 1 set if digit n blinks, 0 if software blinking is off
+static uint8_t _blinkPeriod;				///< frames of one phase of blinking
+static uint8_t _blinkCounter;				///< frames left to next phase of blinking
+static uint32_t _blinkMask;					///< mask clearing all blinking digits
+
+/**
+ * \brief Returns mask of the pin if it is connected to the port, evaluated at compile time.
+ *
+ * \param [in] pin_base is the base address of the port of the pin, LCD_*_GPIO_BASE from bsp.h
+ * \param [in] pin is the pin number
+ * \param [in] base is the base address of the port
+ */
+constexpr uint32_t LCD_Pin(uint32_t pin_base, enum GpioPin pin, uint32_t base)
+{
+	return (pin_base == base) ? GPIO_PIN_MASK(pin) : 0;
+}
+
+/// masks of commons and segments connected to the port, built from bsp.h
+#define LCD_COM_PINS(base)	(LCD_Pin(LCD_COM0_GPIO_BASE, LCD_COM0_pin, base) | \
+		LCD_Pin(LCD_COM1_GPIO_BASE, LCD_COM1_pin, base) | LCD_Pin(LCD_COM2_GPIO_BASE, LCD_COM2_pin, base) | \
+		LCD_Pin(LCD_COM3_GPIO_BASE, LCD_COM3_pin, base))
+#define LCD_SEG_PINS(base)	(LCD_Pin(LCD_SEG0_GPIO_BASE, LCD_SEG0_pin, base) | \
+		LCD_Pin(LCD_SEG1_GPIO_BASE, LCD_SEG1_pin, base) | LCD_Pin(LCD_SEG2_GPIO_BASE, LCD_SEG2_pin, base) | \
+		LCD_Pin(LCD_SEG3_GPIO_BASE, LCD_SEG3_pin, base) | LCD_Pin(LCD_SEG4_GPIO_BASE, LCD_SEG4_pin, base) | \
+		LCD_Pin(LCD_SEG5_GPIO_BASE, LCD_SEG5_pin, base) | LCD_Pin(LCD_SEG6_GPIO_BASE, LCD_SEG6_pin, base) | \
+		LCD_Pin(LCD_SEG7_GPIO_BASE, LCD_SEG7_pin, base) | LCD_Pin(LCD_SEG8_GPIO_BASE, LCD_SEG8_pin, base) | \
+		LCD_Pin(LCD_SEG9_GPIO_BASE, LCD_SEG9_pin, base) | LCD_Pin(LCD_SEG10_GPIO_BASE, LCD_SEG10_pin, base) | \
+		LCD_Pin(LCD_SEG11_GPIO_BASE, LCD_SEG11_pin, base) | LCD_Pin(LCD_SEG12_GPIO_BASE, LCD_SEG12_pin, base) | \
+		LCD_Pin(LCD_SEG13_GPIO_BASE, LCD_SEG13_pin, base) | LCD_Pin(LCD_SEG14_GPIO_BASE, LCD_SEG14_pin, base) | \
+		LCD_Pin(LCD_SEG15_GPIO_BASE, LCD_SEG15_pin, base) | LCD_Pin(LCD_SEG16_GPIO_BASE, LCD_SEG16_pin, base) | \
+		LCD_Pin(LCD_SEG17_GPIO_BASE, LCD_SEG17_pin, base) | LCD_Pin(LCD_SEG18_GPIO_BASE, LCD_SEG18_pin, base) | \
+		LCD_Pin(LCD_SEG19_GPIO_BASE, LCD_SEG19_pin, base) | LCD_Pin(LCD_SEG20_GPIO_BASE, LCD_SEG20_pin, base) | \
+		LCD_Pin(LCD_SEG21_GPIO_BASE, LCD_SEG21_pin, base) | LCD_Pin(LCD_SEG22_GPIO_BASE, LCD_SEG22_pin, base) | \
+		LCD_Pin(LCD_SEG23_GPIO_BASE, LCD_SEG23_pin, base))
+
+/// LCD pins grouped by port, so each GPIO register is written once per port
+static const struct GpioPinGroup _lcdPins[] =
+{
+		GPIO_PIN_GROUP(GPIOA, LCD_COM_PINS(GPIOA_BASE), GPIO_COM_CONFIGURATION),
+		GPIO_PIN_GROUP(GPIOA, LCD_SEG_PINS(GPIOA_BASE), GPIO_SEG_CONFIGURATION),
+		GPIO_PIN_GROUP(GPIOB, LCD_COM_PINS(GPIOB_BASE), GPIO_COM_CONFIGURATION),
+		GPIO_PIN_GROUP(GPIOB, LCD_SEG_PINS(GPIOB_BASE), GPIO_SEG_CONFIGURATION),
+		GPIO_PIN_GROUP(GPIOC, LCD_COM_PINS(GPIOC_BASE), GPIO_COM_CONFIGURATION),
+		GPIO_PIN_GROUP(GPIOC, LCD_SEG_PINS(GPIOC_BASE), GPIO_SEG_CONFIGURATION),
+};
+
+static_assert(__builtin_popcount(LCD_COM_PINS(GPIOA_BASE)) + __builtin_popcount(LCD_COM_PINS(GPIOB_BASE)) +
+		__builtin_popcount(LCD_COM_PINS(GPIOC_BASE)) == 4, "LCD commons must be connected to ports A, B or C!");
+static_assert(__builtin_popcount(LCD_SEG_PINS(GPIOA_BASE)) + __builtin_popcount(LCD_SEG_PINS(GPIOB_BASE)) +
+		__builtin_popcount(LCD_SEG_PINS(GPIOC_BASE)) == 24, "LCD segments must be connected to ports A, B or C!");
+
 /* Constant table for cap characters 'A' --> 'Z' */
-const uint16_t CapLetterMap[26]=
+constexpr uint16_t CapLetterMap[26]=
 {
     /* A      B      C      D      E      F      G      H      I  */
     0xFE00,0x6714,0x1d00,0x4714,0x9d00,0x9c00,0x3f00,0xfa00,0x0014,
@@ -63,12 +140,123 @@ const uint16_t CapLetterMap[26]=
 };
 
 /* Constant table for number '0' --> '9' */
-const uint16_t NumberMap[10]=
+constexpr uint16_t NumberMap[10]=
 {
 	/* 0      1      2      3      4      5      6      7      8      9  */
     0x5F00,0x4200,0xF500,0x6700,0xEa00,0xAF00,0xBF00,0x04600,0xFF00,0xEF00
 };
 
+#define LCD_CODE_MINUS		0xA000	///< G and M segments, char '-'
+
+/**
+ * Mapping of the glass: bit of LCD RAM word driven by each bit of a character nibble, for each digit position. Nibble
+ * n of the character code (n = 0 for bits 15:12) goes to LCD RAM word 2 * n (COMn), the same bits in each word.
+ *
+ *  position	bit 0 (E, D, P, N)	bit 1 (M, C, COL, DP)	bit 2 (B, A, K, J)	bit 3 (G, F, Q, H)
+ */
+constexpr uint8_t _glassMap[LCD_NUMBER_OF_DIGITS][4]=
+{
+	{ 0,	 1,		28,		29 },
+	{ 2,	 7,		26,		27 },
+	{ 8,	 9,		24,		25 },
+	{10,	11,		20,		21 },
+	{12,	13,		18,		19 },
+	{14,	15,		17,		16 },
+};
+
+/// nibble bits connected on the glass for COM0 - COM3, digits 5 and 6 have no colon and no point
+constexpr uint8_t _glassConnected[LCD_NUMBER_OF_DIGITS][4]=
+{
+	{0xF, 0xF, 0xF, 0xF},
+	{0xF, 0xF, 0xF, 0xF},
+	{0xF, 0xF, 0xF, 0xF},
+	{0xF, 0xF, 0xF, 0xF},
+	{0xF, 0xF, 0xD, 0xD},
+	{0xF, 0xF, 0xD, 0xD},
+};
+
+/// precomputed contribution of one digit position to LCD RAM words
+struct LCD_Digit
+{
+	uint32_t clear;				///< mask clearing all segments of the digit
+	uint8_t connected[4];		///< nibble bits connected for COM0 - COM3
+	uint32_t segments[16];		///< LCD RAM bits for each nibble value
+};
+
+/// list of indexes used to expand tables at compile time
+template<uint8_t... I> struct LCD_Indexes {};
+
+template<uint8_t N, uint8_t... I> struct LCD_MakeIndexes : LCD_MakeIndexes<N - 1, N - 1, I...> {};
+
+template<uint8_t... I> struct LCD_MakeIndexes<0, I...>
+{
+	typedef LCD_Indexes<I...> type;
+};
+
+/**
+ * \brief Returns LCD RAM bits driven by a nibble on a digit position, evaluated at compile time.
+ */
+constexpr uint32_t LCD_Segments(uint8_t position, uint8_t nibble)
+{
+	return ((nibble & 1) ? 1UL << _glassMap[position][0] : 0) | ((nibble & 2) ? 1UL << _glassMap[position][1] : 0) |
+			((nibble & 4) ? 1UL << _glassMap[position][2] : 0) | ((nibble & 8) ? 1UL << _glassMap[position][3] : 0);
+}
+
+/**
+ * \brief Expands one digit position, evaluated at compile time.
+ */
+template<uint8_t... N>
+constexpr LCD_Digit LCD_MakeDigit(uint8_t position, LCD_Indexes<N...>)
+{
+	return LCD_Digit{~LCD_Segments(position, 0xF),
+		{_glassConnected[position][0], _glassConnected[position][1], _glassConnected[position][2],
+				_glassConnected[position][3]},
+		{LCD_Segments(position, N)...}};
+}
+
+/**
+ * \brief Returns segment code of a char, evaluated at compile time. Unknown chars are blank.
+ */
+constexpr uint16_t LCD_CharCode(uint8_t c)
+{
+	return (c == '-') ? LCD_CODE_MINUS :
+			(c >= '0' && c <= '9') ? NumberMap[c - '0'] :
+			(c >= 'A' && c <= 'Z') ? CapLetterMap[c - 'A'] :
+			(c >= 'a' && c <= 'z') ? CapLetterMap[c - 'a'] : 0;
+}
+
+/**
+ * \brief Expands segment codes of all ASCII chars, evaluated at compile time.
+ */
+template<uint8_t... C>
+struct LCD_CharTable
+{
+	static constexpr uint16_t codes[sizeof...(C)] = {LCD_CharCode(C)...};
+};
+
+template<uint8_t... C>
+constexpr uint16_t LCD_CharTable<C...>::codes[sizeof...(C)];
+
+template<uint8_t... C>
+constexpr LCD_CharTable<C...> LCD_MakeCharTable(LCD_Indexes<C...>)
+{
+	return LCD_CharTable<C...>();
+}
+
+typedef LCD_MakeIndexes<16>::type LCD_NibbleIndexes;
+typedef decltype(LCD_MakeCharTable(LCD_MakeIndexes<128>::type())) LCD_AsciiTable;
+
+/// segment contributions of all digit positions
+constexpr LCD_Digit _digits[LCD_NUMBER_OF_DIGITS]=
+{
+	LCD_MakeDigit(0, LCD_NibbleIndexes()), LCD_MakeDigit(1, LCD_NibbleIndexes()),
+	LCD_MakeDigit(2, LCD_NibbleIndexes()), LCD_MakeDigit(3, LCD_NibbleIndexes()),
+	LCD_MakeDigit(4, LCD_NibbleIndexes()), LCD_MakeDigit(5, LCD_NibbleIndexes()),
+};
+
+#define LCD_CODE_POINT		0x0002	///< DP segment in char code
+#define LCD_CODE_COLON		0x0020	///< COL segment in char code
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | local functions
 +---------------------------------------------------------------------------------------------------------------------*/
@@ -81,59 +269,17 @@ const uint16_t NumberMap[10]=
  */
 void LCD_Init()
 {
-   	// getting access to RCC registers
-	PWR->CR |= PWR_CR_DBP;
-
-	// select the RTC clock source
-	RCC->CSR |= (RCC_CSR_RTCSEL_LSE | RCC_CSR_RTCEN | RCC_CSR_LSEON);
-
 	// Enable rcc clock fot gpio
 	RCC->AHBENR |= RCC_AHBENR_GPIOAEN | RCC_AHBENR_GPIOBEN | RCC_AHBENR_GPIOCEN;
 
 	// Enable rcc clock for lcd
 	RCC->APB1ENR|=RCC_APB1ENR_LCDEN;
 
-	// RTC and LCD clock source selection
-	// 00 - noclock
-	// 01 - LSE     RCC_CSR_RTCSEL_LSE
-	// 10 - LSI     RCC_CSR_RTCSEL_LSI
-	// 11 - HSE		RCC_CSR_RTCSEL_HSE
-
-	// enabling RTC clock
-	RCC->CSR |= (RCC_CSR_RTCSEL_LSI | RCC_CSR_RTCEN);
-
-	// Configure the LCD GPIO pins as alternate functions
-	// Comons
-	gpioConfigurePin(LCD_COM0_GPIO, LCD_COM0_pin, GPIO_COM_CONFIGURATION);
-	gpioConfigurePin(LCD_COM1_GPIO, LCD_COM1_pin, GPIO_COM_CONFIGURATION);
-	gpioConfigurePin(LCD_COM2_GPIO, LCD_COM2_pin, GPIO_COM_CONFIGURATION);
-	gpioConfigurePin(LCD_COM3_GPIO, LCD_COM3_pin, GPIO_COM_CONFIGURATION);
-
-	// Segments
-	gpioConfigurePin(LCD_SEG0_GPIO, LCD_SEG0_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG1_GPIO, LCD_SEG1_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG2_GPIO, LCD_SEG2_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG3_GPIO, LCD_SEG3_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG4_GPIO, LCD_SEG4_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG5_GPIO, LCD_SEG5_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG6_GPIO, LCD_SEG6_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG7_GPIO, LCD_SEG7_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG8_GPIO, LCD_SEG8_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG9_GPIO, LCD_SEG9_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG10_GPIO, LCD_SEG10_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG11_GPIO, LCD_SEG11_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG12_GPIO, LCD_SEG12_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG13_GPIO, LCD_SEG13_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG14_GPIO, LCD_SEG14_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG15_GPIO, LCD_SEG15_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG16_GPIO, LCD_SEG16_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG17_GPIO, LCD_SEG17_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG18_GPIO, LCD_SEG18_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG19_GPIO, LCD_SEG19_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG20_GPIO, LCD_SEG20_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG21_GPIO, LCD_SEG21_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG22_GPIO, LCD_SEG22_pin, GPIO_SEG_CONFIGURATION);
-	gpioConfigurePin(LCD_SEG23_GPIO, LCD_SEG23_pin, GPIO_SEG_CONFIGURATION);
+	// LCD is clocked from RTC clock (LSE, or LSI if LSE does not start)
+	rtcInitialize();
+
+	// Configure the LCD GPIO pins (commons and segments) as alternate functions
+	gpioConfigurePinGroups(_lcdPins, sizeof(_lcdPins) / sizeof(_lcdPins[0]));
 
 	// multiplexed pin enabled
 	LCD->CR|=LCD_CR_MUX_SEG;
@@ -166,6 +312,18 @@ void LCD_Init()
 
 	// pulse on duration 4
 	LCD->FCR|=LCD_FCR_PON_2;
+
+	// update display done interrupt, commits the shadow framebuffer
+	LCD_ModifyFCR(0, LCD_FCR_UDDIE);
+
+	memset(_frame, 0, sizeof(_frame));
+	memset(_committed, 0, sizeof(_committed));
+	_dirty = LCD_FRAME_DIRTY_ALL;
+
+	NVIC_SetPriority(LCD_IRQn, LCD_IRQ_PRIORITY);
+	NVIC_EnableIRQ(LCD_IRQn);
+
+	LCD_Commit();
 }
 
 /**
@@ -177,62 +335,42 @@ void LCD_Deinit()
 }
 
 /**
- * \brief Converts char to digit on the LCD.
+ * \brief  Composes a char in the shadow framebuffer. LCD RAM is not touched, words which were changed are marked as
+ * 		dirty and committed by LCD_Commit(). Uses only tables generated at compile time.
  *
- * \param [in] Char to convert
+ * \param [in] Char to display
  * \param [in] Point display enable. Values 0 or 1.
  * \param [in] Colon display enable. Values 0 or 1.
  * \param [in] Digit number. Values from 1 to 6.
  *
  */
-static void LCD_Conv_Char_Seg(char c,bool point,bool column, uint8_t* digit)
-{
-    uint16_t ch = 0 ;
-    uint8_t i,j;
-
-    switch (c)
-    {
-        case ' ' :
-        	ch = 0x00;
-        	break;
-        case '0':
-        case '1':
-        case '2':
-        case '3':
-        case '4':
-        case '5':
-        case '6':
-        case '7':
-        case '8':
-        case '9':
-        	ch = NumberMap[c-0x30];
-        	break;
-
-        default:
-        	/* The character c is one letter in upper case*/
-        	if ( (c < 0x5b) && (c > 0x40) ){
-        	   	ch = CapLetterMap[c-'A'];
-        	}
-        	/* The character c is one letter in lower case*/
-        	if ( (c <0x7b) && ( c> 0x60) ){
-        		ch = CapLetterMap[c-'a'];
-        	}
-        	break;
-    }
-
-    /* Set the digital point can be displayed if the point is on */
-    if (point){
-    	ch |= 0x0002;
-    }
-
-    /* Set the "COL" segment in the character that can be displayed if the column is on */
-    if (column){
-    	ch |= 0x0020;
-    }
-
-    for (i = 12,j=0 ;j<4; i-=4,j++){
-    	digit[j] = (ch >> i) & 0x0f; //To isolate the less signifiant dibit
-    }
+static void LCD_ComposeChar(char ch, bool point, bool column, uint8_t position)
+{
+	if((uint8_t)(position - 1) >= LCD_NUMBER_OF_DIGITS)
+		return;
+
+	const LCD_Digit& digit = _digits[position - 1];
+	uint16_t code = LCD_AsciiTable::codes[(uint8_t)ch & 0x7F] | (point * LCD_CODE_POINT) | (column * LCD_CODE_COLON);
+
+	LCD_ComposeWord(0, (_frame[0] & digit.clear) | digit.segments[(code >> 12) & digit.connected[0]]);
+	LCD_ComposeWord(2, (_frame[2] & digit.clear) | digit.segments[(code >> 8) & digit.connected[1]]);
+	LCD_ComposeWord(4, (_frame[4] & digit.clear) | digit.segments[(code >> 4) & digit.connected[2]]);
+	LCD_ComposeWord(6, (_frame[6] & digit.clear) | digit.segments[code & digit.connected[3]]);
+}
+
+/**
+ * \brief  Stores a word in the shadow framebuffer and marks it as dirty if it was changed.
+ *
+ * \param [in] index is the index of the word in the framebuffer
+ * \param [in] word is the new value of the word
+ */
+static void LCD_ComposeWord(uint8_t index, uint32_t word)
+{
+	if(_frame[index] == word)
+		return;
+
+	_frame[index] = word;
+	_dirty |= 1 << index;
 }
 
 /**
@@ -246,109 +384,116 @@ static void LCD_Conv_Char_Seg(char c,bool point,bool column, uint8_t* digit)
  */
 void LCD_WriteChar(char ch, bool point, bool column, uint8_t position)
 {
-    uint8_t digit[4];     /* Digit frame buffer */
-
-    /* To convert displayed character in segment in array digit */
-    LCD_Conv_Char_Seg(ch,point,column,digit);
-
-    while((LCD->SR&LCD_SR_UDR)!=0);
-
-    switch (position)
-    {
-      /* Position 1 on LCD (Digit1)*/
-      case 1:
-    	LCD->RAM[0] &= 0xcffffffc;
-    	LCD->RAM[2] &= 0xcffffffc;
-    	LCD->RAM[4] &= 0xcffffffc;
-    	LCD->RAM[6] &= 0xcffffffc;
-
-    	LCD->RAM[0] |= ((digit[0]& 0x0c) << 26 ) | (digit[0]& 0x03) ; // 1G 1B 1M 1E
-   		LCD->RAM[2] |= ((digit[1]& 0x0c) << 26 ) | (digit[1]& 0x03) ; // 1F 1A 1C 1D
-   		LCD->RAM[4] |= ((digit[2]& 0x0c) << 26 ) | (digit[2]& 0x03) ; // 1Q 1K 1Col 1P
-   		LCD->RAM[6] |= ((digit[3]& 0x0c) << 26 ) | (digit[3]& 0x03) ; // 1H 1J 1DP 1N
-
-   		break;
-
-   	  /* Position 2 on LCD (Digit2)*/
-      case 2:
-    	LCD->RAM[0] &= 0xf3ffff03;
-   		LCD->RAM[2] &= 0xf3ffff03;
-   		LCD->RAM[4] &= 0xf3ffff03;
-   		LCD->RAM[6] &= 0xf3ffff03;
-
-    	LCD->RAM[0] |= ((digit[0]& 0x0c) << 24 )|((digit[0]& 0x02) << 6 )|((digit[0]& 0x01) << 2 ) ; // 2G 2B 2M 2E
-   		LCD->RAM[2] |= ((digit[1]& 0x0c) << 24 )|((digit[1]& 0x02) << 6 )|((digit[1]& 0x01) << 2 ) ; // 2F 2A 2C 2D
-   		LCD->RAM[4] |= ((digit[2]& 0x0c) << 24 )|((digit[2]& 0x02) << 6 )|((digit[2]& 0x01) << 2 ) ; // 2Q 2K 2Col 2P
-   		LCD->RAM[6] |= ((digit[3]& 0x0c) << 24 )|((digit[3]& 0x02) << 6 )|((digit[3]& 0x01) << 2 ) ; // 2H 2J 2DP 2N
-
-    	break;
-
-      /* Position 3 on LCD (Digit3)*/
-      case 3:
-    	LCD->RAM[0] &= 0xfcfffcff;
-   		LCD->RAM[2] &= 0xfcfffcff;
-   		LCD->RAM[4] &= 0xfcfffcff;
-   		LCD->RAM[6] &= 0xfcfffcff;
-
-    	LCD->RAM[0] |= ((digit[0]& 0x0c) << 22 ) | ((digit[0]& 0x03) << 8 ) ; // 3G 3B 3M 3E
-    	LCD->RAM[2] |= ((digit[1]& 0x0c) << 22 ) | ((digit[1]& 0x03) << 8 ) ; // 3F 3A 3C 3D
-   		LCD->RAM[4] |= ((digit[2]& 0x0c) << 22 ) | ((digit[2]& 0x03) << 8 ) ; // 3Q 3K 3Col 3P
-   		LCD->RAM[6] |= ((digit[3]& 0x0c) << 22 ) | ((digit[3]& 0x03) << 8 ) ; // 3H 3J 3DP 3N
-
-   		break;
-
-      /* Position 4 on LCD (Digit4)*/
-      case 4:
-    	LCD->RAM[0] &= 0xffcff3ff;
-   		LCD->RAM[2] &= 0xffcff3ff;
-   		LCD->RAM[4] &= 0xffcff3ff;
-   		LCD->RAM[6] &= 0xffcff3ff;
-
-    	LCD->RAM[0] |= ((digit[0]& 0x0c) << 18 ) | ((digit[0]& 0x03) << 10 ) ; // 4G 4B 4M 4E
-   		LCD->RAM[2] |= ((digit[1]& 0x0c) << 18 ) | ((digit[1]& 0x03) << 10 ) ; // 4F 4A 4C 4D
-   		LCD->RAM[4] |= ((digit[2]& 0x0c) << 18 ) | ((digit[2]& 0x03) << 10 ) ; // 4Q 4K 4Col 4P
-   		LCD->RAM[6] |= ((digit[3]& 0x0c) << 18 ) | ((digit[3]& 0x03) << 10 ) ; // 4H 4J 4DP 4N
-
-   		break;
-
-      /* Position 5 on LCD (Digit5)*/
-      case 5:
-        LCD->RAM[0] &= 0xfff3cfff;
-    	LCD->RAM[2] &= 0xfff3cfff;
-    	LCD->RAM[4] &= 0xfff3efff;
-    	LCD->RAM[6] &= 0xfff3efff;
-
-    	LCD->RAM[0] |= ((digit[0]& 0x0c) << 16 ) | ((digit[0]& 0x03) << 12 ) ; // 5G 5B 5M 5E
-    	LCD->RAM[2] |= ((digit[1]& 0x0c) << 16 ) | ((digit[1]& 0x03) << 12 ) ; // 5F 5A 5C 5D
-    	LCD->RAM[4] |= ((digit[2]& 0x0c) << 16 ) | ((digit[2]& 0x01) << 12 ) ; // 5Q 5K   5P
-    	LCD->RAM[6] |= ((digit[3]& 0x0c) << 16 ) | ((digit[3]& 0x01) << 12 ) ; // 5H 5J   5N
-
-    	break;
-
-      /* Position 6 on LCD (Digit6)*/
-      case 6:
-    	LCD->RAM[0] &= 0xfffc3fff;
-    	LCD->RAM[2] &= 0xfffc3fff;
-    	LCD->RAM[4] &= 0xfffc3fff;
-    	LCD->RAM[6] &= 0xfffc3fff;
-
-    	LCD->RAM[0] |= ((digit[0]& 0x04) << 15 ) | ((digit[0]& 0x08) << 13 ) | ((digit[0]& 0x03) << 14 ) ; // 6B 6G 6M 6E
-    	LCD->RAM[2] |= ((digit[1]& 0x04) << 15 ) | ((digit[1]& 0x08) << 13 ) | ((digit[1]& 0x03) << 14 ) ; // 6A 6F 6C 6D
-    	LCD->RAM[4] |= ((digit[2]& 0x04) << 15 ) | ((digit[2]& 0x08) << 13 ) | ((digit[2]& 0x01) << 14 ) ; // 6K 6Q    6P
-    	LCD->RAM[6] |= ((digit[3]& 0x04) << 15 ) | ((digit[3]& 0x08) << 13 ) | ((digit[3]& 0x01) << 14 ) ; // 6J 6H   6N
-
-    	break;
-
-      default:
-    	break;
-    }
-
-    // Sending update display request
-    LCD->SR|=LCD_SR_UDR;
+	LCD_ComposeChar(ch, point, column, position);
+
+	LCD_Commit();
+}
+
+/**
+ * \brief  Commits dirty words of the shadow framebuffer, writes them to LCD RAM and requests update of the display. If
+ * 		previous update is still in progress LCD RAM is write protected, so the words are written from UDD interrupt
+ * 		when the update is done. Never waits for the LCD. Only committed frames are copied by the interrupt, so chars
+ * 		composed after this call are not shown until the next one.
+ */
+void LCD_Commit(void)
+{
+	NVIC_DisableIRQ(LCD_IRQn);
+
+	LCD_CommitFrame();
+
+	NVIC_EnableIRQ(LCD_IRQn);
+}
+
+/**
+ * \brief  Starts scrolling of text from right to left. Text is shifted by one digit every frames_per_step LCD frames
+ * 		from the start of frame interrupt, so no task has to wake up. After the last char the display is blank for
+ * 		one screen and the text starts again. LCD_WriteChar() and LCD_WriteString() should not be used while scrolling.
+ *
+ * \param [in] text is the text to scroll, up to LCD_SCROLL_MAX_LENGTH chars, copied
+ * \param [in] frames_per_step is the number of LCD frames between steps, at least 1
+ */
+void LCD_StartScroll(const char* text, uint8_t frames_per_step)
+{
+	uint8_t length = 0;
+
+	LCD_StopScroll();
+
+	while(text[length] != '\0' && length < LCD_SCROLL_MAX_LENGTH)
+	{
+		_scrollText[length] = text[length];
+		length++;
+	}
+
+	memset(&_scrollText[length], ' ', LCD_NUMBER_OF_DIGITS);
+
+	_scrollOffset = 0;
+	_scrollPeriod = (frames_per_step != 0) ? frames_per_step : 1;
+	_scrollCounter = _scrollPeriod;
+
+	NVIC_DisableIRQ(LCD_IRQn);
+	_scrollLength = length + LCD_NUMBER_OF_DIGITS;
+	LCD_ScrollStep();
+	NVIC_EnableIRQ(LCD_IRQn);
+
+	LCD_ModifyFCR(0, LCD_FCR_SOFIE);
+}
+
+/**
+ * \brief  Stops scrolling. Last shown text stays on the display.
+ */
+void LCD_StopScroll(void)
+{
+	_scrollLength = 0;
+
+	if(_blinkDigits == 0)
+		LCD_ModifyFCR(LCD_FCR_SOFIE, 0);
+}
+
+/**
+ * \brief  Blinks selected digits from the start of frame interrupt. Digits are blanked only in LCD RAM, so the text
+ * 		written to them is kept and can be changed while blinking.
+ *
+ * \param [in] digits has bit n - 1 set for each digit n to blink, 0 stops blinking
+ * \param [in] frames_per_phase is the number of LCD frames of each phase (on and off), at least 1
+ */
+void LCD_BlinkDigits(uint8_t digits, uint8_t frames_per_phase)
+{
+	NVIC_DisableIRQ(LCD_IRQn);
+
+	_blinkMask = 0xFFFFFFFF;
+	for(uint8_t i=0; i<LCD_NUMBER_OF_DIGITS; i++)
+		if(digits & (1 << i))
+			_blinkMask &= _digits[i].clear;
+
+	_blinkDigits = digits;
+	_blinkPeriod = (frames_per_phase != 0) ? frames_per_phase : 1;
+	_blinkCounter = _blinkPeriod;
+	_blank = 0xFFFFFFFF;
+	_pending |= LCD_FRAME_DIRTY_ALL;
+
+	LCD_CopyFrame();
+
+	NVIC_EnableIRQ(LCD_IRQn);
+
+	if(digits != 0)
+		LCD_ModifyFCR(0, LCD_FCR_SOFIE);
+	else if(_scrollLength == 0)
+		LCD_ModifyFCR(LCD_FCR_SOFIE, 0);
+}
+
+/**
+ * \brief  Configures hardware blinking. Does not use any interrupt.
+ *
+ * \param [in] mode selects blinking pixels
+ * \param [in] frequency selects blink frequency ck_div / 2^(frequency + 3), allowed values {0; 7}
+ */
+void LCD_SetBlink(enum LCD_BlinkMode mode, uint8_t frequency)
+{
+	LCD_ModifyFCR(LCD_FCR_BLINK | LCD_FCR_BLINKF, mode | ((frequency << 13) & LCD_FCR_BLINKF));
 }
 
 /**
- * \brief  Displays a string on the LCD.
+ * \brief  Displays a string on the LCD. Whole string is composed in the shadow framebuffer and committed once.
  *
  * \param [in] Char table to display
  *
@@ -360,123 +505,185 @@ void LCD_WriteString(char* s)
 	for(i=0;*s!='\0' && i<LCD_NUMBER_OF_DIGITS+kropki;i++)
 	{
 		if(*(s+1)=='.'){
-			LCD_WriteChar(*s,1,0,i+1);
+			LCD_ComposeChar(*s,1,0,i+1);
 			kropki++;
 			s++;
 		}
 		else if(*(s+1)==':'){
-			LCD_WriteChar(*s,0,1,i+1);
+			LCD_ComposeChar(*s,0,1,i+1);
 			kropki++;
 			s++;
 		}
 		else
 		{
-			LCD_WriteChar(*s,0,0,i+1);
+			LCD_ComposeChar(*s,0,0,i+1);
 		}
 		s++;
 	}
 	while(i<LCD_NUMBER_OF_DIGITS+kropki)
 	{
-		LCD_WriteChar(' ',0,0,i+1);
+		LCD_ComposeChar(' ',0,0,i+1);
 		i++;
 	}
+
+	LCD_Commit();
 }
 
 /**
-  * \brief  Converts float to char table with designed precision.
-  *
-  * \param  *ptr   - Pointer to char table.
-  * \param  number - Number to convert.
-  * \param  d 	   - Number of digits before dot.
-  * \param  p	   - Number of digits after dot.
-  */
-static void floatToChar(char *ptr, float number, uint8_t d, uint8_t p)
-{
-	int i;
-	for(i=0;i<p;i++){
-		number*=10;
-	}
+ * \brief	Writes fixed point number on LCD with designed precision.
+ *
+ * \param 	value - Number multiplied by 10^scale, e.g. hundredths of degree.
+ * \param 	scale - Number of decimal fraction digits of value.
+ * \param 	d - Number of digits before dot.
+ * \param 	p - Number of digits after dot.
+ */
+void LCD_WriteFixed(int32_t value, uint8_t scale, uint8_t d, uint8_t p)
+{
+	char tab[LCD_NUMBER_OF_DIGITS + 6];		// d + p up to 10 digits, dot and '\0'
 
-	int number_int=(int)(number);
+	if((size_t)d + p + 2 > sizeof(tab))
+		return;
 
-	ptr = ptr + p + d + 1;
-	*ptr = '\0';
-	ptr--;
+	formatFixed(tab, value, scale, d, p);
 
-	// Convert number: ones, tens, hundreds...
-	i= p + d;
+	LCD_WriteString(tab);
+}
 
-	do
-	{
-		if(p && i==d){
-			*ptr='.';
-			ptr--;
-		}
-		*ptr-- = abs(number_int % 10) + '0';
-		number_int /= 10;
-	}
-	while(--i);
+/**
+ * \brief	Writing on LCD time
+ *
+ * \param time	Pointer to table which contains number of hours, minutes and seconds in normal format (non BCD)
+ */
+void LCD_WriteTime(uint8_t* time)
+{
+	char text[FORMAT_TIME_LENGTH + 1];
 
-	ptr++;
-	while(i<d-1)
-	{
-		if(*ptr != '0')
-		{
-			break;
-		}
-		else *ptr=' ';
-		ptr++;
-		i++;
-	}
+	formatTime(text, time);
+
+	LCD_WriteString(text);
 }
 
+/**
+ * \brief	Copies dirty words of the shadow framebuffer to the committed frame and writes them to LCD RAM, called with
+ * 			LCD interrupt disabled or from it.
+ */
+static void LCD_CommitFrame(void)
+{
+	uint8_t dirty = _dirty;
+
+	for(uint8_t i=0; i<LCD_FRAME_WORDS; i++)
+		if(dirty & (1 << i))
+			_committed[i] = _frame[i];
+
+	_dirty = 0;
+	_pending |= dirty;
+
+	LCD_CopyFrame();
+}
 
 /**
- * \brief	Writes float on LCD with designed precision.
+ * \brief	Copies pending words of the committed frame to LCD RAM and requests update of the display. Does nothing if
+ * 			LCD RAM is write protected (UDR set), the words stay pending until UDD interrupt.
+ */
+static void LCD_CopyFrame(void)
+{
+	uint8_t pending = _pending;
+
+	if(pending == 0 || (LCD->SR & LCD_SR_UDR) != 0)
+		return;
+
+	for(uint8_t i=0; i<LCD_FRAME_WORDS; i++)
+		if(pending & (1 << i))
+			LCD->RAM[i] = _committed[i] & _blank;
+
+	_pending = 0;
+
+	// Sending update display request
+	LCD->SR|=LCD_SR_UDR;
+}
+
+/**
+ * \brief	Modifies LCD_FCR. The register is synchronized to LCD clock, so previous write has to be finished.
  *
- * \param 	f - Pointer to number in float
- * \param 	d - Number of digits before dot.
- * \param 	p - Number of digits after dot.
+ * \param clear	Bits to clear
+ * \param set		Bits to set
  */
-void LCD_WriteFloat(float* f, uint8_t d, uint8_t p)
+static void LCD_ModifyFCR(uint32_t clear, uint32_t set)
 {
-	char tab[10];
+	while((LCD->SR & LCD_SR_FCRSR) == 0);
 
-	floatToChar(tab,*f,d,p);
+	LCD->FCR = (LCD->FCR & ~clear) | set;
+}
 
-	LCD_WriteString(tab);
+/**
+ * \brief	Composes current step of scrolling in the shadow framebuffer and commits it, called with LCD interrupt
+ * 			disabled or from it.
+ */
+static void LCD_ScrollStep(void)
+{
+	uint8_t length = _scrollLength;
+	uint8_t index = _scrollOffset;
+
+	for(uint8_t i=0; i<LCD_NUMBER_OF_DIGITS; i++)
+	{
+		LCD_ComposeChar(_scrollText[index], 0, 0, i + 1);
+
+		if(++index >= length)
+			index = 0;
+	}
+
+	if(++_scrollOffset >= length)
+		_scrollOffset = 0;
+
+	LCD_CommitFrame();
 }
 
+/*---------------------------------------------------------------------------------------------------------------------+
+| ISRs
++---------------------------------------------------------------------------------------------------------------------*/
+
 /**
- * \brief	Writing on LCD time
+ * \brief LCD interrupt handler
  *
- * \param time	Pointer to table which contains number of hours, minutes and seconds in normal format (non BCD)
+ * Update display done - LCD RAM is writable again, changes committed during the update are written now. Start of
+ * frame - steps of scrolling and blinking are counted.
  */
-void LCD_WriteTime(uint8_t* time)
+
+extern "C" void LCD_IRQHandler(void) __attribute__ ((interrupt));
+void LCD_IRQHandler(void)
 {
-	char text[9];
+	struct RuntimeIsr isr;
 
-	// Hours
-	text[0]=(char)( ( *time / 10 ) + 48 );
-	text[1]=(char)( ( *time % 10 ) + 48 );
-	text[2]=':';
+	runtimeIsrEnter(&isr);
 
-	time++;
+	uint32_t sr = LCD->SR;
 
-	// Minutes
-	text[3]=(char)( ( *time / 10 ) + 48 );
-	text[4]=(char)( ( *time % 10 ) + 48 );
-	text[5]=':';
+	if(sr & LCD_SR_SOF)
+	{
+		LCD->CLR = LCD_CLR_SOFC;
 
-	time++;
+		if(_scrollLength != 0 && --_scrollCounter == 0)
+		{
+			_scrollCounter = _scrollPeriod;
+			LCD_ScrollStep();
+		}
 
-	// Seconds
-	text[6]=(char)( ( *time / 10 ) + 48 );
-	text[7]=(char)( ( *time % 10 ) + 48 );
+		if(_blinkDigits != 0 && --_blinkCounter == 0)
+		{
+			_blinkCounter = _blinkPeriod;
+			_blank = (_blank == 0xFFFFFFFF) ? _blinkMask : 0xFFFFFFFF;
+			_pending |= LCD_FRAME_DIRTY_ALL;
 
-	text[8]='\0';
+			LCD_CopyFrame();
+		}
+	}
 
-	LCD_WriteString(text);
-}
+	if(sr & LCD_SR_UDD)
+	{
+		LCD->CLR = LCD_CLR_UDDC;
 
+		LCD_CopyFrame();
+	}
 
+	runtimeIsrExit(&isr, RUNTIME_ISR_GROUP_LCD);
+}
@@ -15,6 +15,24 @@
 #define GPIO_COM_CONFIGURATION GPIO_AF11_PP_40MHz
 #define GPIO_SEG_CONFIGURATION GPIO_AF11_PP_40MHz
 
+#define LCD_FRAME_WORDS		8		///< words of LCD RAM used by 4 commons
+#define LCD_FRAME_DIRTY_ALL	0x55	///< dirty flags of all used words (0, 2, 4, 6)
+
+#define LCD_SCROLL_MAX_LENGTH	32	///< longest text scrolled by LCD_StartScroll()
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// hardware blink modes, BLINK bits of LCD_FCR
+enum LCD_BlinkMode
+{
+	LCD_BLINK_OFF = 0,
+	LCD_BLINK_SEG0_COM0 = LCD_FCR_BLINK_0,						///< one pixel, SEG0 on COM0
+	LCD_BLINK_SEG0_ALL_COM = LCD_FCR_BLINK_1,					///< SEG0 on all commons
+	LCD_BLINK_ALL = LCD_FCR_BLINK_0 | LCD_FCR_BLINK_1,			///< all segments
+};
+
 
 /*---------------------------------------------------------------------------------------------------------------------+
 | global functions' declarations
@@ -24,15 +42,21 @@ void LCD_Init();
 
 void LCD_Deinit();
 
-static void LCD_Conv_Char_Seg(char c,bool point,bool column, uint8_t* digit);
-
 void LCD_WriteChar(char ch, bool point, bool column, uint8_t position);
 
 void LCD_WriteString(char* s);
 
-void LCD_WriteFloat(float* f, uint8_t d, uint8_t p);
+void LCD_Commit(void);
+
+void LCD_StartScroll(const char* text, uint8_t frames_per_step);
+
+void LCD_StopScroll(void);
+
+void LCD_BlinkDigits(uint8_t digits, uint8_t frames_per_phase);
+
+void LCD_SetBlink(enum LCD_BlinkMode mode, uint8_t frequency);
 
-static void floatToChar(char *ptr, float number, uint8_t d, uint8_t p);
+void LCD_WriteFixed(int32_t value, uint8_t scale, uint8_t d, uint8_t p);
 
 void LCD_WriteTime(uint8_t* time);
 
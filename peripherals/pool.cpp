@@ -0,0 +1,194 @@
+/**
+ * \file pool.cpp
+ * \brief Fixed-block memory pools
+ *
+ * Pools of fixed-size blocks in static storage. Free blocks form a stack linked through their first word. Allocation
+ * and free are lock-free - the head of the stack and counters are updated with LDREX/STREX, so they may be used from
+ * tasks and ISRs of any priority, and they don't disable interrupts. Any exception entry or return clears the exclusive
+ * monitor, so a preempted update is retried and a block taken and returned by an ISR can't corrupt the stack (no ABA
+ * problem on a single core).
+ *
+ * chip: STM32L1xx; prefix: pool
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stm32l152xb.h"
+
+#include "pool.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static uint32_t _atomicAdd(volatile uint32_t *value, int32_t delta);
+static void _atomicMax(volatile uint32_t *value, uint32_t candidate);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Initializes a pool.
+ *
+ * Initializes a pool - links all blocks of storage into the free stack. Must be called before the pool is used by
+ * other tasks or ISRs.
+ *
+ * \param [out] pool is the pool
+ * \param [in] storage is the storage, it must have POOL_STORAGE_WORDS(block_size, count) words
+ * \param [in] block_size is the size of objects in the pool, in bytes
+ * \param [in] count is the number of blocks
+ */
+
+void poolInitialize(struct Pool *pool, uint32_t *storage, size_t block_size, uint32_t count)
+{
+	block_size = POOL_BLOCK_SIZE(block_size);
+
+	if (block_size == 0)					// the link has to fit
+		block_size = sizeof(uint32_t);
+
+	pool->start = (uint8_t*)storage;
+	pool->end = pool->start + block_size * count;
+	pool->blockSize = block_size;
+	pool->count = count;
+	pool->used = 0;
+	pool->highWater = 0;
+	pool->failures = 0;
+	pool->free = 0;
+
+	for (uint32_t i = count; i > 0; i--)	// push blocks from the end, so they are allocated in order
+	{
+		uint32_t *block = (uint32_t*)(pool->start + block_size * (i - 1));
+
+		*block = pool->free;
+		pool->free = (uint32_t)block;
+	}
+}
+
+/**
+ * \brief Allocates a block from a pool.
+ *
+ * Allocates a block from a pool. May be called from tasks and ISRs.
+ *
+ * \param [in] pool is the pool
+ *
+ * \return pointer to the block, NULL if the pool is empty
+ */
+
+void* poolAllocate(struct Pool *pool)
+{
+	uint32_t block;
+
+	do
+	{
+		block = __LDREXW(&pool->free);
+
+		if (block == 0)						// pool empty?
+		{
+			__CLREX();
+			_atomicAdd(&pool->failures, 1);
+			return NULL;
+		}
+	} while (__STREXW(*(uint32_t*)block, &pool->free) != 0);	// pop, retry if preempted
+
+	_atomicMax(&pool->highWater, _atomicAdd(&pool->used, 1));
+
+	return (void*)block;
+}
+
+/**
+ * \brief Returns a block to a pool.
+ *
+ * Returns a block to a pool. May be called from tasks and ISRs.
+ *
+ * \param [in] pool is the pool
+ * \param [in] block is the block allocated from this pool, NULL is ignored
+ */
+
+void poolFree(struct Pool *pool, void *block)
+{
+	if (block == NULL)
+		return;
+
+	do
+	{
+		*(volatile uint32_t*)block = __LDREXW(&pool->free);
+	} while (__STREXW((uint32_t)block, &pool->free) != 0);	// push, retry if preempted
+
+	_atomicAdd(&pool->used, -1);
+}
+
+/**
+ * \brief Checks whether a block belongs to a pool.
+ *
+ * \param [in] pool is the pool
+ * \param [in] block is the pointer to check
+ *
+ * \return true if block is in storage of the pool, false otherwise
+ */
+
+bool poolContains(const struct Pool *pool, const void *block)
+{
+	return (const uint8_t*)block >= pool->start && (const uint8_t*)block < pool->end;
+}
+
+/**
+ * \brief Reads statistics of a pool.
+ *
+ * \param [in] pool is the pool
+ * \param [out] statistics is the buffer for statistics
+ */
+
+void poolGetStatistics(const struct Pool *pool, struct PoolStatistics *statistics)
+{
+	statistics->blockSize = pool->blockSize;
+	statistics->count = pool->count;
+	statistics->used = pool->used;
+	statistics->highWater = pool->highWater;
+	statistics->failures = pool->failures;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Adds a value to a variable atomically.
+ *
+ * \param [in,out] value is the variable
+ * \param [in] delta is the value to add
+ *
+ * \return new value of the variable
+ */
+
+static uint32_t _atomicAdd(volatile uint32_t *value, int32_t delta)
+{
+	uint32_t result;
+
+	do
+	{
+		result = __LDREXW(value) + delta;
+	} while (__STREXW(result, value) != 0);
+
+	return result;
+}
+
+/**
+ * \brief Raises a variable to a value atomically.
+ *
+ * \param [in,out] value is the variable
+ * \param [in] candidate is the new value, used if it is higher than the current one
+ */
+
+static void _atomicMax(volatile uint32_t *value, uint32_t candidate)
+{
+	do
+	{
+		if (__LDREXW(value) >= candidate)
+		{
+			__CLREX();
+			return;
+		}
+	} while (__STREXW(candidate, value) != 0);
+}
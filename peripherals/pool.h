@@ -0,0 +1,62 @@
+/**
+ * \file pool.h
+ * \brief Header for pool.cpp
+ */
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global defines
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// size of a block able to hold an object of given size - free blocks keep a link in the first word
+#define POOL_BLOCK_SIZE(size)				((((size) + sizeof(uint32_t) - 1) / sizeof(uint32_t)) * sizeof(uint32_t))
+
+/// number of words of storage for count objects of given size
+#define POOL_STORAGE_WORDS(size, count)		(POOL_BLOCK_SIZE(size) / sizeof(uint32_t) * (count))
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// pool of fixed-size blocks
+struct Pool {
+	volatile uint32_t free;					///< address of the first free block, 0 if the pool is empty
+	uint8_t *start;							///< start of storage
+	uint8_t *end;							///< end of storage
+	size_t blockSize;						///< size of one block, in bytes
+	uint32_t count;							///< number of blocks
+	volatile uint32_t used;					///< number of allocated blocks
+	volatile uint32_t highWater;			///< highest number of allocated blocks
+	volatile uint32_t failures;				///< number of allocations from empty pool
+};
+
+/// statistics of a pool
+struct PoolStatistics {
+	size_t blockSize;						///< size of one block, in bytes
+	uint32_t count;							///< number of blocks
+	uint32_t used;							///< number of allocated blocks
+	uint32_t highWater;						///< highest number of allocated blocks
+	uint32_t failures;						///< number of allocations from empty pool
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+void poolInitialize(struct Pool *pool, uint32_t *storage, size_t block_size, uint32_t count);
+
+void* poolAllocate(struct Pool *pool);
+
+void poolFree(struct Pool *pool, void *block);
+
+bool poolContains(const struct Pool *pool, const void *block);
+
+void poolGetStatistics(const struct Pool *pool, struct PoolStatistics *statistics);
+
+#endif /* POOL_H_ */
@@ -0,0 +1,296 @@
+/**
+ * \file power.cpp
+ * \brief Low-power modes
+ *
+ * Tickless idle of FreeRTOS. When all tasks are blocked, SysTick is stopped and the core sleeps until the next task
+ * has to be unblocked, using the RTC wakeup timer as time base. STOP mode is used, unless some driver holds a no-stop
+ * lock (its peripheral needs clocks which are stopped in STOP mode), then SLEEP mode is used.
+ *
+ * The wakeup timer of this RTC can't be read, so the sleep is split into periods of at most POWER_TICKLESS_PERIOD_ms.
+ * When the core is woken up by other interrupt, the tick count is corrected with completed periods only - it never
+ * passes the time of the next unblocked task, but may lag behind by less than one period. To keep that lag small when
+ * interrupts are frequent, the period is halved after each early wake-up and doubled after each completed one. When it
+ * drops below one tick, the core sleeps with SysTick running (no lag at all) for POWER_TICKLESS_PERIOD_ms, then
+ * tickless sleep is tried again with one tick period.
+ *
+ * Lost periods would add up, so after early wake-ups the tick count is compared with the calendar of the RTC, which
+ * counts also during them. The calendar has no subsecond part, so the difference is known with accuracy of one second
+ * and only a lag above one second is corrected - the tick count never lags behind by more than two seconds.
+ *
+ * chip: STM32L1xx; prefix: power
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stm32l152xb.h"
+
+#include "config.h"
+
+#include "rcc.h"
+#include "rtc.h"
+#include "power.h"
+#include "runtime.h"
+#include "trace.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static void _sleep(bool stop);
+static uint32_t _calendarLag(portTickType ticks, uint32_t max_ticks);
+static void _calendarReference(portTickType ticks);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+static volatile uint32_t _stopLocks;		///< number of held no-stop locks
+
+/// max period of tickless sleep, shortened after early wake-ups, 0 - sleep with SysTick running
+static uint32_t _periodTicks = POWER_TICKLESS_PERIOD_ms / portTICK_RATE_MS;
+static portTickType _tickedSince;			///< tick count when sleep with SysTick running was selected
+
+static bool _calendarValid;					///< reference point of the calendar was taken
+static bool _calendarCheck;					///< periods were lost since the last comparison with the calendar
+static uint32_t _calendarSeconds;			///< second of day of the calendar at the reference point
+static portTickType _calendarTicks;			///< tick count at the reference point
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Sleeps with suppressed tick.
+ *
+ * Implementation of portSUPPRESS_TICKS_AND_SLEEP(), called by the idle task with the scheduler suspended. The core
+ * sleeps for at most expected_idle_time - 1 ticks (the current tick is partially elapsed), then the tick count is
+ * corrected with vTaskStepTick() and SysTick is restarted. Interrupt which woke the core up is handled on return. If
+ * RTC is not initialized, the core just sleeps till the next interrupt with SysTick running.
+ *
+ * \param [in] expected_idle_time is the time till the next unblocked task, in ticks
+ */
+
+void powerSuppressTicksAndSleep(uint32_t expected_idle_time)
+{
+	uint32_t frequency = rtcGetWakeupFrequency();
+
+	if (frequency == 0)						// no time base for tickless sleep?
+	{
+		_sleep(false);
+		return;
+	}
+
+	if (_periodTicks == 0)					// woken up early by frequent interrupts? keep SysTick running for a while
+	{
+		if (xTaskGetTickCount() - _tickedSince < POWER_TICKLESS_PERIOD_ms / portTICK_RATE_MS)
+		{
+			_sleep(false);
+			return;
+		}
+
+		_periodTicks = 1;
+	}
+
+	__disable_irq();
+
+	SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+
+	if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0 || eTaskConfirmSleepModeStatus() == eAbortSleep)
+	{
+		SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;	// continue current tick
+		__enable_irq();
+		return;
+	}
+
+	if (_calendarValid == false)
+		_calendarReference(xTaskGetTickCount());
+
+	bool stop = _stopLocks == 0;
+	uint32_t max_ticks = expected_idle_time - 1;
+	uint32_t slept_ticks = 0;
+	uint32_t period_ticks = 0;
+
+	while (slept_ticks < max_ticks)
+	{
+		uint32_t ticks = max_ticks - slept_ticks;
+
+		if (ticks > _periodTicks)
+			ticks = _periodTicks;
+
+		if (ticks != period_ticks)			// timer is periodic, restart it only if the period changes
+		{
+			rtcStartWakeupTimer(ticks * frequency / configTICK_RATE_HZ - 1);
+			period_ticks = ticks;
+		}
+
+		_sleep(stop);
+
+		if (rtcClearWakeupFlag() == false)	// woken up by other interrupt? this period is lost, next one is shorter
+		{
+			_periodTicks = ticks / 2;
+			_calendarCheck = true;
+			break;
+		}
+
+		slept_ticks += ticks;
+
+		if (ticks == _periodTicks && _periodTicks < POWER_TICKLESS_PERIOD_ms / portTICK_RATE_MS)
+		{
+			_periodTicks *= 2;
+
+			if (_periodTicks > POWER_TICKLESS_PERIOD_ms / portTICK_RATE_MS)
+				_periodTicks = POWER_TICKLESS_PERIOD_ms / portTICK_RATE_MS;
+		}
+	}
+
+	rtcStopWakeupTimer();
+
+	if (stop == true)
+	{
+		rccRestoreClock();
+		runtimeAddStoppedTime(slept_ticks);	// run-time counter doesn't count in STOP mode
+		traceRecord(TRACE_EVENT_STOP, 0, slept_ticks < 0xFFFF ? slept_ticks : 0xFFFF);	// neither does DWT
+	}
+
+	if (_calendarCheck == true)
+		slept_ticks += _calendarLag(xTaskGetTickCount() + slept_ticks, max_ticks - slept_ticks);
+
+	vTaskStepTick(slept_ticks);
+
+	if (_periodTicks == 0)					// sleep with SysTick running from now on
+		_tickedSince = xTaskGetTickCount();
+
+	SysTick->VAL = 0;						// start new tick
+	SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+	__enable_irq();
+}
+
+/**
+ * \brief Takes no-stop lock.
+ *
+ * Drivers hold the lock while their peripheral works in background and needs clocks stopped in STOP mode (DMA
+ * transfers, USB connection). Locks are counted, each call must be paired with powerUnlockStop(). Can be used in
+ * interrupts.
+ */
+
+void powerLockStop(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	_stopLocks++;
+
+	__set_PRIMASK(primask);
+}
+
+/**
+ * \brief Releases no-stop lock taken with powerLockStop(). Can be used in interrupts.
+ */
+
+void powerUnlockStop(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (_stopLocks != 0)
+		_stopLocks--;
+
+	__set_PRIMASK(primask);
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Enters SLEEP or STOP mode till the next interrupt.
+ *
+ * Interrupt wakes the core up also when it is masked with PRIMASK. STOP mode uses low-power regulator with VREFINT
+ * disabled, the core wakes up with MSI clock.
+ *
+ * \param [in] stop selects STOP mode if true, SLEEP mode otherwise
+ */
+
+static void _sleep(bool stop)
+{
+	if (stop == true)
+	{
+		PWR->CR = (PWR->CR & ~PWR_CR_PDDS) | PWR_CR_LPSDSR | PWR_CR_ULP | PWR_CR_FWU | PWR_CR_CWUF;
+		SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+	}
+
+	__DSB();
+	__WFI();
+
+	if (stop == true)
+	{
+		SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+		PWR->CR &= ~PWR_CR_LPSDSR;			// low-power regulator in SLEEP mode would need low MSI range
+	}
+}
+
+/**
+ * \brief Compares the tick count with the calendar of the RTC.
+ *
+ * The calendar is read with an unknown subsecond part both at the reference point and now, so the tick count surely
+ * lags if it counted less than calendar seconds minus one. If the calendar counted less than the tick count (it was
+ * reset by switch of RTC clock, or SysTick ran fast) or the tick count is close to its overflow since the reference
+ * point, the reference point is taken again.
+ *
+ * \param [in] ticks is the tick count after the sleep
+ * \param [in] max_ticks is the highest correction which doesn't pass the time of the next unblocked task
+ *
+ * \return number of lost ticks to add to the tick count
+ */
+
+static uint32_t _calendarLag(portTickType ticks, uint32_t max_ticks)
+{
+	uint32_t seconds = rtcGetSecondOfDay();
+	portTickType elapsed = ticks - _calendarTicks;
+	int32_t counted = elapsed / configTICK_RATE_HZ;	// whole seconds counted by ticks since the reference point
+
+	// seconds counted by the calendar minus counted, the calendar wraps at midnight
+	int32_t difference = (int32_t)((seconds + 2 * 86400 - _calendarSeconds - counted % 86400) % 86400);
+
+	if (difference >= 86400 / 2)
+		difference -= 86400;
+
+	if (difference < -2 || elapsed > portMAX_DELAY / 2)
+	{
+		_calendarReference(ticks);
+		_calendarCheck = false;
+		return 0;
+	}
+
+	int64_t lag = (int64_t)(counted + difference - 1) * configTICK_RATE_HZ - elapsed;
+
+	if (lag <= 0)
+	{
+		_calendarCheck = false;
+		return 0;
+	}
+
+	if (lag > max_ticks)					// the rest is corrected after next sleep
+		return max_ticks;
+
+	_calendarCheck = false;
+	return lag;
+}
+
+/**
+ * \brief Takes the reference point for _calendarLag().
+ *
+ * \param [in] ticks is the current tick count
+ */
+
+static void _calendarReference(portTickType ticks)
+{
+	_calendarSeconds = rtcGetSecondOfDay();
+	_calendarTicks = ticks;
+	_calendarValid = true;
+}
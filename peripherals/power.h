@@ -0,0 +1,29 @@
+/**
+ * \file power.h
+ * \brief Header for power.cpp
+ */
+
+#ifndef POWER_H_
+#define POWER_H_
+
+#include <stdint.h>
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void powerSuppressTicksAndSleep(uint32_t expected_idle_time);
+
+#ifdef __cplusplus
+}
+#endif
+
+void powerLockStop(void);
+
+void powerUnlockStop(void);
+
+#endif /* POWER_H_ */
@@ -21,17 +21,62 @@
 
 #include "rcc.h"
 
+#include "FreeRTOS.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// configuration of system clock
+struct _ClockConfiguration {
+	uint32_t frequency;						///< frequency of the core, in Hz
+	uint8_t range;							///< lowest allowed VOS range, 1 - 1.8V, 2 - 1.5V, 3 - 1.2V
+};
+
+/// callbacks of one driver
+struct _ClockCallbacks {
+	rccClockCallback preChange;				///< called before the change, may be nullptr
+	rccClockCallback postChange;			///< called after the change, may be nullptr
+};
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | local functions' declarations
 +---------------------------------------------------------------------------------------------------------------------*/
 
-static void _flashLatency(uint32_t frequency);
+static uint32_t _findPll(enum rccPllInput pll_input, uint32_t input_frequency, uint32_t output_frequency, uint8_t range,
+		uint32_t *cfgr);
+static uint32_t _findSystemPll(uint8_t range, uint32_t *cfgr);
+static void _startPll(uint32_t cfgr);
+static void _stopPreparation(void);
+static void _switchClock(uint32_t sw, uint32_t sws);
+static uint32_t _flashWaitStates(uint32_t frequency, uint8_t range);
+static void _flashLatency(uint32_t wait_states);
+static void _setRange(uint8_t range);
+static void _retimeSysTick(uint32_t frequency);
 
 /*---------------------------------------------------------------------------------------------------------------------+
 | local variables
 +---------------------------------------------------------------------------------------------------------------------*/
 
+/// configurations of system clock, indexed with enum rccClock
+static const struct _ClockConfiguration _clocks[] =
+{
+		{65536, 3}, {131072, 3}, {262144, 3}, {524288, 3}, {1048000, 3}, {2097000, 3}, {4194000, 3},	// MSI
+		{16000000, 2},						// HSI16
+		{FREQUENCY, 1},						// PLL32
+};
+
+static_assert(sizeof(_clocks) / sizeof(_clocks[0]) == RCC_CLOCK_PLL32 + 1, "_clocks doesn't match enum rccClock!");
+static_assert(RCC_CLOCK_MSI_65kHz == 0 && RCC_CLOCK_MSI_4MHz == 6, "MSI clocks must match values of MSIRANGE!");
+
 static uint32_t _coreFrequency = 2097000;	///< frequency of the core
+static enum rccClock _clock = RCC_CLOCK_MSI_2MHz;	///< current clock, MSI range 5 after reset
+static uint8_t _range = 2;					///< current VOS range, range 2 after reset
+
+static struct _ClockCallbacks _callbacks[RCC_CLOCK_CALLBACKS];	///< drivers notified about changes of core frequency
+static uint8_t _callbacksCount;				///< number of used elements in _callbacks
+
+static volatile uint8_t _floorLocks[RCC_CLOCK_PLL32 + 1];	///< number of held clock floor locks, indexed with enum rccClock
 
 /*---------------------------------------------------------------------------------------------------------------------+
 | global functions
@@ -56,6 +101,7 @@ uint32_t rccGetCoreFrequency(void)
  * Configures and enables PLL to achieve some frequency with some input frequency. The clock source must be enabled and
  * running! Before the speed change Flash latency is configured via _flashLatency(). PLL parameters are based on
  * function parameters. The PLL is set up, started and connected. Clock ratios are set to 1:1 for APB1, APB2 and AHB.
+ * Doesn't change VOS range and doesn't notify drivers - use rccSetClock() at runtime.
  *
  * \param [in] pll_input selects the source of PLL input clock, allowed values {RCC_PLL_INPUT_HSI, RCC_PLL_INPUT_HSE}
  * \param [in] input_frequency is the input frequency for the PLL in Hz
@@ -66,16 +112,349 @@ uint32_t rccGetCoreFrequency(void)
 
 uint32_t rccStartPll(enum rccPllInput pll_input, uint32_t input_frequency, uint32_t output_frequency)
 {
-#if DEVICE_VCORE_mV == 1800
-	static const uint32_t pllvco_max = 96000000;
-#elif DEVICE_VCORE_mV == 1500
-	static const uint32_t pllvco_max = 48000000;
-#elif DEVICE_VCORE_mV == 1200
-	static const uint32_t pllvco_max = 24000000;
+	uint32_t cfgr;
+	uint32_t frequency = _findPll(pll_input, input_frequency, output_frequency, _range, &cfgr);
+
+	_startPll(cfgr);
+	while (RCC_CR_PLLRDY_bb == 0);			// wait for stabilization
+
+	_flashLatency(_flashWaitStates(frequency, _range));	// configure flash latency using found frequency
+
+	RCC->CFGR &= ~(RCC_CFGR_HPRE | RCC_CFGR_PPRE1 | RCC_CFGR_PPRE2);	// AHB, APB1 and APB2 at 1:1
+
+	_switchClock(RCC_CFGR_SW_PLL, RCC_CFGR_SWS_PLL);	// change SYSCLK to PLL
+
+	_coreFrequency = frequency;
+
+	RCC->APB2ENR |= (RCC_APB2ENR_SYSCFGEN);
+
+	return frequency;
+}
+
+/**
+ * \brief Starts oscillators of a system clock in the background.
+ *
+ * Raises VOS range and enables oscillators needed by the clock without waiting for them. For RCC_CLOCK_PLL32 the PLL is
+ * configured and started from RCC interrupt as soon as its source is ready, so following rccSetClock() only switches
+ * SYSCLK (waiting for the rest of PLL lock, if needed). Meanwhile the core keeps running from MSI. Doesn't use any
+ * variables, so it may be called from low_level_init_0(), before .data and .bss are initialized.
+ *
+ * \param [in] clock is the system clock which will be set with rccSetClock()
+ */
+
+void rccPrepareClock(enum rccClock clock)
+{
+	if (clock < RCC_CLOCK_HSI16)			// MSI is always running
+		return;
+
+	RCC_APB1ENR_PWREN_bb = 1;
+	while ((PWR->CSR & PWR_CSR_VOSF) != 0);	// VOS can be changed only when regulator is ready
+
+	if (_clocks[clock].range < (PWR->CR & PWR_CR_VOS) / PWR_CR_VOS_0)	// raise voltage, but don't wait for it
+		PWR->CR = (PWR->CR & (~PWR_CR_VOS)) | (_clocks[clock].range * PWR_CR_VOS_0);
+
+	if (clock == RCC_CLOCK_HSI16)
+	{
+		RCC_CR_HSION_bb = 1;
+		return;
+	}
+
+	NVIC_SetPriority(RCC_IRQn, RCC_IRQ_PRIORITY);
+	NVIC_EnableIRQ(RCC_IRQn);
+
+#if CLOCK_SOURCE == USING_HSE
+	RCC->CIR |= RCC_CIR_HSERDYIE;			// interrupt enabled first, so the ready event can't be missed
+	RCC_CR_HSEON_bb = 1;
+#else
+	RCC->CIR |= RCC_CIR_HSIRDYIE;
+	RCC_CR_HSION_bb = 1;
+#endif
+}
+
+/**
+ * \brief Changes the system clock at runtime.
+ *
+ * Switches the core to the selected clock together with the matching VOS range and Flash latency. The voltage is raised
+ * before and lowered after the frequency change, Flash latency is changed on the safe side of the switch. Clocks which
+ * are no longer needed (PLL, HSE, HSI) are stopped. SysTick is re-timed to keep the tick period. Registered drivers are
+ * notified before and after the change, see rccRegisterClockCallbacks(). Oscillators started with rccPrepareClock()
+ * are used as they are.
+ *
+ * Must be called from a task (callbacks may block) or before the scheduler is started. Drivers of buses (I2C, SPI)
+ * take their bus lock in the callback before the change and release it in the one after, so no transfer is started
+ * with settings of the old frequency while the core is switched. USB works only with RCC_CLOCK_PLL32, I2C needs at
+ * least RCC_CLOCK_MSI_2MHz.
+ *
+ * \param [in] clock is the new system clock
+ *
+ * \return new frequency of the core in Hz
+ */
+
+uint32_t rccSetClock(enum rccClock clock)
+{
+	if (clock == _clock)
+		return _coreFrequency;
+
+	const struct _ClockConfiguration *configuration = &_clocks[clock];
+	uint8_t i;
+
+	_stopPreparation();
+
+	for (i = 0; i < _callbacksCount; i++)
+		if (_callbacks[i].preChange != nullptr)
+			_callbacks[i].preChange(configuration->frequency);
+
+	if (configuration->range < _range)		// higher voltage needed? raise it before the frequency
+		_setRange(configuration->range);
+
+	uint32_t wait_states = _flashWaitStates(configuration->frequency, _range);
+
+	if (wait_states > (FLASH->ACR & FLASH_ACR_LATENCY))	// more wait states needed? set them before the switch
+		_flashLatency(wait_states);
+
+	uint32_t frequency = configuration->frequency;
+	uint32_t sw, sws;
+
+	if (clock == RCC_CLOCK_PLL32)			// oscillators are started outside of the critical section
+	{
+#if CLOCK_SOURCE == USING_HSE
+		RCC_CR_HSEON_bb = 1;				// enable HSE oscillator
+		while (RCC_CR_HSERDY_bb == 0);		// wait till READY
 #else
-	#error "Invalid value of DEVICE_VCORE_mV!"
+		RCC_CR_HSION_bb = 1;				// enable HSI oscillator
+		while (RCC_CR_HSIRDY_bb == 0);		// wait till READY
 #endif
+		uint32_t cfgr;
+
+		frequency = _findSystemPll(_range, &cfgr);
+		_startPll(cfgr);					// no-op if already started by rccPrepareClock()
+		while (RCC_CR_PLLRDY_bb == 0);		// wait for stabilization
+
+		_flashLatency(_flashWaitStates(frequency, _range));
+		sw = RCC_CFGR_SW_PLL;
+		sws = RCC_CFGR_SWS_PLL;
+	}
+	else if (clock == RCC_CLOCK_HSI16)
+	{
+		RCC_CR_HSION_bb = 1;				// enable HSI oscillator
+		while (RCC_CR_HSIRDY_bb == 0);		// wait till READY
+		sw = RCC_CFGR_SW_HSI;
+		sws = RCC_CFGR_SWS_HSI;
+	}
+	else
+	{
+		RCC_CR_MSION_bb = 1;				// enable MSI oscillator
+		while (RCC_CR_MSIRDY_bb == 0);		// wait till READY
+		sw = RCC_CFGR_SW_MSI;
+		sws = RCC_CFGR_SWS_MSI;
+	}
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (sw == RCC_CFGR_SW_MSI)				// MSI range (clock enum matches MSIRANGE) can be changed when MSI is ready
+		RCC->ICSCR = (RCC->ICSCR & ~RCC_ICSCR_MSIRANGE) | (clock << RCC_ICSCR_MSIRANGE_bit);
+
+	_switchClock(sw, sws);
+	_coreFrequency = frequency;
+	_clock = clock;
+	_retimeSysTick(frequency);
+
+	__set_PRIMASK(primask);
+
+	_flashLatency(_flashWaitStates(frequency, configuration->range));	// final latency, valid also in lower range
+
+	if (configuration->range > _range)		// lower voltage allowed? lower it after the frequency
+		_setRange(configuration->range);
+
+	if (clock != RCC_CLOCK_PLL32)			// stop oscillators which are not used
+	{
+		RCC_CR_PLLON_bb = 0;
+#if CLOCK_SOURCE == USING_HSE
+		RCC_CR_HSEON_bb = 0;
+#endif
+	}
+
+#if CLOCK_SOURCE == USING_HSE
+	if (clock != RCC_CLOCK_HSI16)
+#else
+	if (clock != RCC_CLOCK_HSI16 && clock != RCC_CLOCK_PLL32)
+#endif
+		RCC_CR_HSION_bb = 0;
+
+	for (i = 0; i < _callbacksCount; i++)
+		if (_callbacks[i].postChange != nullptr)
+			_callbacks[i].postChange(frequency);
+
+	return frequency;
+}
+
+/**
+ * \brief Restores the system clock after STOP mode.
+ *
+ * The core wakes up from STOP mode with MSI, while HSE, HSI and PLL are stopped. Oscillators of current clock are
+ * started again and SYSCLK is switched back. Configuration of MSI range, PLL, VOS range and Flash latency is kept in
+ * STOP mode. Drivers are not notified, as frequency of the core is the same as before STOP mode.
+ */
+
+void rccRestoreClock(void)
+{
+	if (_clock < RCC_CLOCK_HSI16)			// MSI is already used
+		return;
+
+	if (_clock == RCC_CLOCK_HSI16)
+	{
+		RCC_CR_HSION_bb = 1;				// enable HSI oscillator
+		while (RCC_CR_HSIRDY_bb == 0);		// wait till READY
+		_switchClock(RCC_CFGR_SW_HSI, RCC_CFGR_SWS_HSI);
+		return;
+	}
+
+#if CLOCK_SOURCE == USING_HSE
+	RCC_CR_HSEON_bb = 1;					// enable HSE oscillator
+	while (RCC_CR_HSERDY_bb == 0);			// wait till READY
+#else
+	RCC_CR_HSION_bb = 1;					// enable HSI oscillator
+	while (RCC_CR_HSIRDY_bb == 0);			// wait till READY
+#endif
+
+	RCC_CR_PLLON_bb = 1;					// enable PLL and wait for stabilization
+	while (RCC_CR_PLLRDY_bb == 0);
+
+	_switchClock(RCC_CFGR_SW_PLL, RCC_CFGR_SWS_PLL);
+}
+
+/**
+ * \brief Returns current system clock.
+ *
+ * \return current system clock set with rccSetClock()
+ */
+
+enum rccClock rccGetClock(void)
+{
+	return _clock;
+}
+
+/**
+ * \brief Returns frequency of the core for a system clock.
+ *
+ * \param [in] clock is the system clock
+ *
+ * \return frequency of the core with the clock, in Hz
+ */
+
+uint32_t rccGetClockFrequency(enum rccClock clock)
+{
+	return _clocks[clock].frequency;
+}
+
+/**
+ * \brief Takes clock floor lock.
+ *
+ * Drivers hold the lock while their peripheral needs at least some system clock (USB needs RCC_CLOCK_PLL32 from reset
+ * till suspend). The lock doesn't change the clock - whoever selects the clock at runtime (the governor) must not go
+ * below rccGetClockFloor(). Locks are counted, each call must be paired with rccUnlockClockFloor(). Can be used in
+ * interrupts.
+ *
+ * \param [in] clock is the slowest system clock allowed while the lock is held
+ */
+
+void rccLockClockFloor(enum rccClock clock)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	_floorLocks[clock]++;
+
+	__set_PRIMASK(primask);
+}
 
+/**
+ * \brief Releases clock floor lock taken with rccLockClockFloor(). Can be used in interrupts.
+ *
+ * \param [in] clock is the same clock which was given to rccLockClockFloor()
+ */
+
+void rccUnlockClockFloor(enum rccClock clock)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (_floorLocks[clock] != 0)
+		_floorLocks[clock]--;
+
+	__set_PRIMASK(primask);
+}
+
+/**
+ * \brief Returns the slowest system clock allowed by held clock floor locks.
+ *
+ * \return the fastest clock with a held floor lock, RCC_CLOCK_MSI_65kHz if no lock is held
+ */
+
+enum rccClock rccGetClockFloor(void)
+{
+	uint8_t clock = RCC_CLOCK_PLL32;
+
+	while (clock > RCC_CLOCK_MSI_65kHz && _floorLocks[clock] == 0)
+		clock--;
+
+	return (enum rccClock)clock;
+}
+
+/**
+ * \brief Registers callbacks notified about changes of core frequency.
+ *
+ * Drivers which derive dividers from core frequency (baudrates, bus timings) should register here during
+ * initialization, registering the same pair again has no effect. pre_change should finish or hold ongoing transfers, post_change should recompute the dividers. Both
+ * get the new frequency of the core.
+ *
+ * \param [in] pre_change is called before the change, may be nullptr
+ * \param [in] post_change is called after the change, may be nullptr
+ *
+ * \return true if callbacks were registered, false if there is no space (see RCC_CLOCK_CALLBACKS)
+ */
+
+bool rccRegisterClockCallbacks(rccClockCallback pre_change, rccClockCallback post_change)
+{
+	uint8_t i;
+
+	for (i = 0; i < _callbacksCount; i++)	// already registered (driver initialized again)?
+		if (_callbacks[i].preChange == pre_change && _callbacks[i].postChange == post_change)
+			return true;
+
+	if (_callbacksCount >= RCC_CLOCK_CALLBACKS)
+		return false;
+
+	_callbacks[_callbacksCount].preChange = pre_change;
+	_callbacks[_callbacksCount].postChange = post_change;
+	_callbacksCount++;
+
+	return true;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Finds PLL configuration.
+ *
+ * Finds PLL parameters that achieve the highest frequency not above output_frequency, preferring 48MHz for USB.
+ *
+ * \param [in] pll_input selects the source of PLL input clock, allowed values {RCC_PLL_INPUT_HSI, RCC_PLL_INPUT_HSE}
+ * \param [in] input_frequency is the input frequency for the PLL in Hz
+ * \param [in] output_frequency is the desired target frequency
+ * \param [in] range is the VOS range, 1 - 1.8V, 2 - 1.5V, 3 - 1.2V
+ * \param [out] cfgr is the value of PLLDIV, PLLMUL and PLLSRC fields in RCC_CFGR
+ *
+ * \return real frequency of PLL output
+ */
+
+static uint32_t _findPll(enum rccPllInput pll_input, uint32_t input_frequency, uint32_t output_frequency, uint8_t range,
+		uint32_t *cfgr)
+{
+	static const uint32_t pllvco_max[] = {96000000, 48000000, 24000000};	// for VOS range 1, 2, 3
 	static const uint8_t muls[] = {3, 4, 6, 8, 12, 16, 24, 32, 48};	// allowed values of PLL multiplier
 	uint32_t mul_i;
 	uint32_t best_frequency = 0, best_mul_i = 0, best_div = 0;
@@ -84,7 +463,7 @@ uint32_t rccStartPll(enum rccPllInput pll_input, uint32_t input_frequency, uint3
 	{
 		uint32_t pllvco = input_frequency * muls[mul_i];
 
-		if (pllvco > pllvco_max)			// internal PLL frequency out of valid range?
+		if (pllvco > pllvco_max[range - 1])	// internal PLL frequency out of valid range?
 			continue;
 
 		uint32_t div;
@@ -109,51 +488,168 @@ uint32_t rccStartPll(enum rccPllInput pll_input, uint32_t input_frequency, uint3
 
 	}
 
-	_flashLatency(best_frequency);			// configure flash latency using found frequency
+	*cfgr = ((best_div - 1) << RCC_CFGR_PLLDIV_bit) | (best_mul_i << RCC_CFGR_PLLMUL_bit) |
+			(pll_input << RCC_CFGR_PLLSRC_bit);
+
+	return best_frequency;
+}
 
-	RCC->CFGR = ((best_div - 1) << RCC_CFGR_PLLDIV_bit) | (best_mul_i << RCC_CFGR_PLLMUL_bit) |
-			(pll_input << RCC_CFGR_PLLSRC_bit);	// set PLL
+/**
+ * \brief Finds configuration of the PLL used for RCC_CLOCK_PLL32.
+ *
+ * \param [in] range is the VOS range, 1 - 1.8V, 2 - 1.5V, 3 - 1.2V
+ * \param [out] cfgr is the value of PLLDIV, PLLMUL and PLLSRC fields in RCC_CFGR
+ *
+ * \return real frequency of PLL output
+ */
 
-	RCC_CR_PLLON_bb = 1;					// enable PLL and wait for stabilization
-	while (RCC_CR_PLLRDY_bb == 0);
+static uint32_t _findSystemPll(uint8_t range, uint32_t *cfgr)
+{
+#if CLOCK_SOURCE == USING_HSE
+	return _findPll(RCC_PLL_INPUT_HSE, HSE_FREQUENCY, FREQUENCY, range, cfgr);
+#else
+	return _findPll(RCC_PLL_INPUT_HSI, _clocks[RCC_CLOCK_HSI16].frequency, FREQUENCY, range, cfgr);
+#endif
+}
+
+/**
+ * \brief Starts the PLL.
+ *
+ * The PLL is stopped, reconfigured and started, unless it already runs with the same configuration. Doesn't wait for
+ * PLL lock and doesn't change SYSCLK. The clock source must be enabled and running!
+ *
+ * \param [in] cfgr is the value of PLLDIV, PLLMUL and PLLSRC fields in RCC_CFGR
+ */
 
-	RCC->CFGR |= RCC_CFGR_SW_PLL;			// change SYSCLK to PLL
-	while (((RCC->CFGR) & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL);	// wait for switch
+static void _startPll(uint32_t cfgr)
+{
+	const uint32_t mask = RCC_CFGR_PLLDIV | RCC_CFGR_PLLMUL | RCC_CFGR_PLLSRC;
 
-	_coreFrequency = best_frequency;
+	if (RCC_CR_PLLON_bb == 1 && (RCC->CFGR & mask) == cfgr)
+		return;
 
-	RCC->APB2ENR |= (RCC_APB2ENR_SYSCFGEN);
+	RCC_CR_PLLON_bb = 0;					// PLL can be configured only when it is disabled
+	while (RCC_CR_PLLRDY_bb == 1);
 
-	return best_frequency;
+	RCC->CFGR = (RCC->CFGR & ~mask) | cfgr;	// set PLL
+
+	RCC_CR_PLLON_bb = 1;
 }
 
-/*---------------------------------------------------------------------------------------------------------------------+
-| local functions
-+---------------------------------------------------------------------------------------------------------------------*/
+/**
+ * \brief Stops background start of oscillators.
+ *
+ * Disables RCC interrupt used by rccPrepareClock() and updates VOS range which could be raised there.
+ */
+
+static void _stopPreparation(void)
+{
+	NVIC_DisableIRQ(RCC_IRQn);
+	RCC->CIR &= ~(RCC_CIR_HSERDYIE | RCC_CIR_HSIRDYIE);
+
+	if (RCC_APB1ENR_PWREN_bb == 0)			// rccPrepareClock() or _setRange() were never used
+		return;
+
+	while ((PWR->CSR & PWR_CSR_VOSF) != 0);	// wait for regulator ready
+	_range = (PWR->CR & PWR_CR_VOS) / PWR_CR_VOS_0;
+}
+
+/**
+ * \brief Switches SYSCLK.
+ *
+ * \param [in] sw is the new value of SW field in RCC_CFGR (RCC_CFGR_SW_...)
+ * \param [in] sws is the expected value of SWS field in RCC_CFGR (RCC_CFGR_SWS_...)
+ */
+
+static void _switchClock(uint32_t sw, uint32_t sws)
+{
+	RCC->CFGR = (RCC->CFGR & ~RCC_CFGR_SW) | sw;
+	while ((RCC->CFGR & RCC_CFGR_SWS) != sws);	// wait for switch
+}
+
+/**
+ * \brief Calculates Flash wait-states.
+ *
+ * \param [in] frequency defines the frequency of the core
+ * \param [in] range is the VOS range, 1 - 1.8V, 2 - 1.5V, 3 - 1.2V
+ *
+ * \return number of wait-states needed for the frequency in the range
+ */
+
+static uint32_t _flashWaitStates(uint32_t frequency, uint8_t range)
+{
+	static const uint32_t zero_wait_states_max[] = {16000000, 8000000, 2100000};	// for VOS range 1, 2, 3
+
+	return frequency > zero_wait_states_max[range - 1] ? 1 : 0;
+}
 
 /**
  * \brief Configures Flash latency.
  *
- * Configures Flash latency (wait-states) which allows the chip to run at higher speeds.
+ * Configures Flash latency (wait-states) which allows the chip to run at higher speeds. 64-bit access and prefetch
+ * are always enabled.
  *
- * \param [in] frequency defines the target frequency of the core
+ * \param [in] wait_states is the number of wait-states, 0 or 1
  */
 
-static void _flashLatency(uint32_t frequency)
+static void _flashLatency(uint32_t wait_states)
 {
-#if DEVICE_VCORE_mV == 1800
+	FLASH->ACR |= FLASH_ACR_ACC64;
+	FLASH->ACR = (FLASH->ACR & (~FLASH_ACR_LATENCY)) | FLASH_ACR_PRFTEN | wait_states;
+	while ((FLASH->ACR & FLASH_ACR_LATENCY) != wait_states);	// wait until new latency is used
+}
 
-	uint32_t wait_states;
+/**
+ * \brief Changes VCORE voltage range.
+ *
+ * \param [in] range is the VOS range, 1 - 1.8V, 2 - 1.5V, 3 - 1.2V
+ */
 
-	if (frequency > 16000000)
-		wait_states = 1;
-	else
-		wait_states = 0;
+static void _setRange(uint8_t range)
+{
+	RCC_APB1ENR_PWREN_bb = 1;
+	while ((PWR->CSR & PWR_CSR_VOSF) != 0);	// VOS can be changed only when regulator is ready
+	PWR->CR = (PWR->CR & (~PWR_CR_VOS)) | (range * PWR_CR_VOS_0);	// value of VOS field is equal to range
+	while ((PWR->CSR & PWR_CSR_VOSF) != 0);	// wait for regulator ready
+	_range = range;
+}
 
-    FLASH->ACR |= FLASH_ACR_ACC64;
-    FLASH->ACR = (FLASH->ACR & (~FLASH_ACR_LATENCY)) | FLASH_ACR_PRFTEN | wait_states;
+/**
+ * \brief Re-times running SysTick after the change of core frequency.
+ *
+ * \param [in] frequency is the new frequency of the core in Hz
+ */
 
-#else
-	#error "Invalid flash latency configuration for device's VCORE!"
-#endif
+static void _retimeSysTick(uint32_t frequency)
+{
+	if ((SysTick->CTRL & SysTick_CTRL_ENABLE_Msk) == 0)
+		return;
+
+	SysTick->LOAD = (frequency + configTICK_RATE_HZ / 2) / configTICK_RATE_HZ - 1;
+	SysTick->VAL = 0;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| ISRs
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief RCC interrupt handler
+ *
+ * Source of the PLL started by rccPrepareClock() is ready - the PLL is configured for current VOS range and started.
+ * Doesn't use any variables, see rccPrepareClock() - that's also why its run time is not accounted and it's not traced,
+ * it may run before .data and .bss are initialized.
+ */
+
+extern "C" void RCC_IRQHandler(void) __attribute__ ((interrupt));
+void RCC_IRQHandler(void)
+{
+	RCC->CIR = (RCC->CIR & ~(RCC_CIR_HSERDYIE | RCC_CIR_HSIRDYIE)) | RCC_CIR_HSERDYC | RCC_CIR_HSIRDYC;
+
+	while ((PWR->CSR & PWR_CSR_VOSF) != 0);	// wait for VOS range set by rccPrepareClock()
+
+	uint32_t cfgr;
+
+	_findSystemPll((PWR->CR & PWR_CR_VOS) / PWR_CR_VOS_0, &cfgr);
+	_startPll(cfgr);
 }
@@ -8,6 +8,7 @@
 #ifndef RCC_H_
 #define RCC_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "hdr/hdr_rcc.h"
@@ -22,11 +23,37 @@ enum rccPllInput
 	RCC_PLL_INPUT_HSI = RCC_CFGR_PLLSRC_HSI_value, RCC_PLL_INPUT_HSE = RCC_CFGR_PLLSRC_HSE_value,
 };
 
+/// enum that lists all system clock configurations selectable with rccSetClock(), from the slowest
+enum rccClock
+{
+	RCC_CLOCK_MSI_65kHz,					///< MSI range 0, 65.536 kHz, VOS range 3
+	RCC_CLOCK_MSI_131kHz,					///< MSI range 1, 131.072 kHz, VOS range 3
+	RCC_CLOCK_MSI_262kHz,					///< MSI range 2, 262.144 kHz, VOS range 3
+	RCC_CLOCK_MSI_524kHz,					///< MSI range 3, 524.288 kHz, VOS range 3
+	RCC_CLOCK_MSI_1MHz,						///< MSI range 4, 1.048 MHz, VOS range 3
+	RCC_CLOCK_MSI_2MHz,						///< MSI range 5, 2.097 MHz, VOS range 3 (reset configuration)
+	RCC_CLOCK_MSI_4MHz,						///< MSI range 6, 4.194 MHz, VOS range 3
+	RCC_CLOCK_HSI16,						///< HSI, 16 MHz, VOS range 2
+	RCC_CLOCK_PLL32,						///< PLL from CLOCK_SOURCE, FREQUENCY (32 MHz), VOS range 1, needed for USB
+};
+
+/// type of callback notified about the change of core frequency, frequency is the new frequency in Hz
+typedef void (*rccClockCallback)(uint32_t frequency);
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | global functions' declarations
 +---------------------------------------------------------------------------------------------------------------------*/
 
 uint32_t rccStartPll(enum rccPllInput pll_input, uint32_t input_frequency, uint32_t output_frequency);
+void rccPrepareClock(enum rccClock clock);
+uint32_t rccSetClock(enum rccClock clock);
+void rccRestoreClock(void);
+enum rccClock rccGetClock(void);
+uint32_t rccGetClockFrequency(enum rccClock clock);
+void rccLockClockFloor(enum rccClock clock);
+void rccUnlockClockFloor(enum rccClock clock);
+enum rccClock rccGetClockFloor(void);
+bool rccRegisterClockCallbacks(rccClockCallback pre_change, rccClockCallback post_change);
 
 #ifdef __cplusplus
 extern "C" {
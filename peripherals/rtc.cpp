@@ -0,0 +1,398 @@
+/**
+ * \file rtc.cpp
+ * \brief RTC driver
+ *
+ * Clocking of the internal RTC, its 1 Hz alarm interrupt and the wakeup timer. The calendar of the internal RTC is used
+ * only as a time base of tickless idle, wall-clock time is kept by the external M41T56C64.
+ *
+ * chip: STM32L1xx; prefix: rtc
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "stm32l152xb.h"
+
+#include "config.h"
+
+#include "rtc.h"
+#include "runtime.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static void _selectClock(void);
+static void _setPrescalers(void);
+static void _writeProtection(bool enable);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+static uint32_t _rtcFrequency;				///< frequency of RTCCLK, 0 if RTC was not initialized
+static rtcSecondCallback _secondCallback;	///< function called every second from RTC alarm interrupt
+static bool _lseRestarting;					///< backup domain was reset to select LSE, which is not ready again yet
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Starts LSE in the background
+ *
+ * Enables access to backup domain and starts LSE without waiting for it, so the crystal starts up while memory is
+ * initialized and early init runs. LSE is started also when the RTC already runs from LSI, so rtcSwitchToLse() can
+ * select it later. Doesn't use any variables, so it may be called from low_level_init_0(), before .data and .bss are
+ * initialized.
+ */
+
+void rtcPrepareClock(void)
+{
+	RCC->APB1ENR |= RCC_APB1ENR_PWREN;
+	PWR->CR |= PWR_CR_DBP;					// access to RTC and RCC_CSR backup domain bits
+
+	RCC->CSR |= RCC_CSR_LSEON;				// no effect if LSE already runs
+}
+
+/**
+ * \brief Initializes clock of the RTC
+ *
+ * Clocks the RTC from LSE started by rtcPrepareClock(). If LSE is not ready within RTC_LSE_STARTUP_LOOPS, LSI is used
+ * instead, so a cold start of the crystal (up to a few seconds) doesn't delay the boot - LSE keeps starting in the
+ * background and rtcSwitchToLse() selects it when it is ready. Prescalers are set so the calendar clock (ck_spre) has
+ * 1 Hz. If the RTC is already running (after reset of the core only), its configuration is kept.
+ *
+ * \return frequency of RTCCLK in Hz
+ */
+
+uint32_t rtcInitialize(void)
+{
+	if (_rtcFrequency != 0 || _lseRestarting == true)
+		return _rtcFrequency;
+
+	rtcPrepareClock();						// LSEON is already set if it was called at boot
+
+	if ((RCC->CSR & RCC_CSR_RTCEN) != 0 && (RCC->CSR & RCC_CSR_RTCSEL) != RCC_CSR_RTCSEL_NOCLOCK)
+	{
+		_rtcFrequency = ((RCC->CSR & RCC_CSR_RTCSEL) == RCC_CSR_RTCSEL_LSE) ? RTC_LSE_FREQUENCY : RTC_LSI_FREQUENCY;
+		return _rtcFrequency;
+	}
+
+	_selectClock();
+	_setPrescalers();
+
+	return _rtcFrequency;
+}
+
+/**
+ * \brief Moves the RTC from LSI to LSE
+ *
+ * Has to be called periodically from a task while the RTC runs from LSI selected by rtcInitialize(), it does nothing
+ * otherwise. Once LSE is ready, the backup domain is reset, because RTCSEL can't be changed in any other way. That
+ * stops LSE too, so it is enabled again and selected right away - the RTC (and the LCD) stand still until LSE is ready
+ * again, which is waited for at most RTC_LSE_STARTUP_LOOPS, or completed by the next call. Then the prescalers and the
+ * second interrupt are configured again. The wakeup timer is not available in the meantime (rtcGetWakeupFrequency()
+ * returns 0), so this must not be called while it runs.
+ *
+ * \return frequency of RTCCLK in Hz, RTC_LSE_FREQUENCY once the switch is complete, 0 while LSE restarts
+ */
+
+uint32_t rtcSwitchToLse(void)
+{
+	if (_rtcFrequency == RTC_LSI_FREQUENCY && (RCC->CSR & RCC_CSR_LSERDY) != 0)
+	{
+		uint32_t csr = RCC->CSR & ~RCC_CSR_RTCSEL;	// LSEON is cleared by the reset of backup domain
+
+		_rtcFrequency = 0;
+		_lseRestarting = true;
+
+		RCC->CSR |= RCC_CSR_RTCRST;
+		RCC->CSR &= ~RCC_CSR_RTCRST;
+		RCC->CSR = csr;
+		RCC->CSR |= RCC_CSR_RTCSEL_LSE | RCC_CSR_RTCEN;	// RTC starts counting when LSE is ready
+
+		for (uint32_t i = 0; i < RTC_LSE_STARTUP_LOOPS && (RCC->CSR & RCC_CSR_LSERDY) == 0; i++);
+	}
+
+	if (_lseRestarting == true && (RCC->CSR & RCC_CSR_LSERDY) != 0)
+	{
+		_lseRestarting = false;
+		_rtcFrequency = RTC_LSE_FREQUENCY;
+		_setPrescalers();
+
+		if (_secondCallback != NULL)
+			rtcEnableSecondInterrupt(_secondCallback);
+	}
+
+	return _rtcFrequency;
+}
+
+/**
+ * \brief Enables interrupt every second
+ *
+ * Alarm A is configured with all fields masked, so it matches every second. Alarm is routed to EXTI line 17.
+ *
+ * \param [in] callback is the function called from interrupt every second
+ */
+
+void rtcEnableSecondInterrupt(rtcSecondCallback callback)
+{
+	rtcInitialize();
+
+	_secondCallback = callback;
+
+	_writeProtection(false);
+
+	RTC->CR &= ~(RTC_CR_ALRAE | RTC_CR_ALRAIE);
+	while ((RTC->ISR & RTC_ISR_ALRAWF) == 0);
+
+	RTC->ALRMAR = RTC_ALRMAR_MSK4 | RTC_ALRMAR_MSK3 | RTC_ALRMAR_MSK2 | RTC_ALRMAR_MSK1;
+	RTC->ISR = ~RTC_ISR_ALRAF & ~RTC_ISR_INIT;	// rc_w0 flags, INIT is not set
+	RTC->CR |= RTC_CR_ALRAE | RTC_CR_ALRAIE;
+
+	_writeProtection(true);
+
+	EXTI->RTSR |= EXTI_IMR_MR17;			// RTC alarm event is connected to rising edge of line 17
+	EXTI->PR = EXTI_IMR_MR17;
+	EXTI->IMR |= EXTI_IMR_MR17;
+
+	NVIC_SetPriority(RTC_Alarm_IRQn, RTC_ALARM_IRQ_PRIORITY);
+	NVIC_EnableIRQ(RTC_Alarm_IRQn);
+}
+
+/**
+ * \brief Disables interrupt every second
+ */
+
+void rtcDisableSecondInterrupt(void)
+{
+	NVIC_DisableIRQ(RTC_Alarm_IRQn);
+	EXTI->IMR &= ~EXTI_IMR_MR17;
+
+	_writeProtection(false);
+	RTC->CR &= ~(RTC_CR_ALRAE | RTC_CR_ALRAIE);
+	_writeProtection(true);
+
+	_secondCallback = NULL;
+}
+
+/**
+ * \brief Returns frequency of the wakeup timer
+ *
+ * The wakeup timer is clocked from RTCCLK / 2, which gives resolution of 61 us and maximum period of 4 s with LSE.
+ *
+ * \return frequency of the wakeup timer in Hz, 0 if RTC was not initialized or rtcSwitchToLse() waits for LSE
+ */
+
+uint32_t rtcGetWakeupFrequency(void)
+{
+	return _rtcFrequency / 2;
+}
+
+/**
+ * \brief Reads time of the calendar
+ *
+ * The calendar counts from 00:00:00 set at the initialization of the RTC. Shadow registers are not updated in STOP
+ * mode, so their synchronization is waited for (up to two periods of RTCCLK). This RTC has no subsecond register.
+ * RTC must be initialized.
+ *
+ * \return seconds since midnight of the calendar, {0; 86399}
+ */
+
+uint32_t rtcGetSecondOfDay(void)
+{
+	_writeProtection(false);
+	RTC->ISR = ~RTC_ISR_RSF & ~RTC_ISR_INIT;	// rc_w0 flags, INIT is not set
+	_writeProtection(true);
+
+	while ((RTC->ISR & RTC_ISR_RSF) == 0);
+
+	uint32_t tr = RTC->TR;
+	(void) RTC->DR;							// reading TR locks shadow registers until DR is read
+
+	uint32_t hours = ((tr & RTC_TR_HT) >> 20) * 10 + ((tr & RTC_TR_HU) >> 16);
+	uint32_t minutes = ((tr & RTC_TR_MNT) >> 12) * 10 + ((tr & RTC_TR_MNU) >> 8);
+	uint32_t seconds = ((tr & RTC_TR_ST) >> 4) * 10 + (tr & RTC_TR_SU);
+
+	return (hours * 60 + minutes) * 60 + seconds;
+}
+
+/**
+ * \brief Starts periodic wakeup timer
+ *
+ * The timer sets its flag every (reload + 1) periods of rtcGetWakeupFrequency(). Wakeup event is routed to EXTI line
+ * 20, so it wakes the core up also from STOP mode. The interrupt is enabled in NVIC, but the flag is expected to be
+ * checked with rtcClearWakeupFlag() by the code which waits for it, the handler only clears it. RTC must be initialized.
+ *
+ * \param [in] reload is the value of the auto-reload register
+ */
+
+void rtcStartWakeupTimer(uint16_t reload)
+{
+	_writeProtection(false);
+
+	RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+	while ((RTC->ISR & RTC_ISR_WUTWF) == 0);
+
+	RTC->WUTR = reload;
+	RTC->CR = (RTC->CR & ~RTC_CR_WUCKSEL) | RTC_CR_WUCKSEL_1 | RTC_CR_WUCKSEL_0;	// RTCCLK / 2
+	RTC->ISR = ~RTC_ISR_WUTF & ~RTC_ISR_INIT;	// rc_w0 flags, INIT is not set
+	RTC->CR |= RTC_CR_WUTE | RTC_CR_WUTIE;
+
+	_writeProtection(true);
+
+	EXTI->RTSR |= EXTI_IMR_MR20;			// RTC wakeup event is connected to rising edge of line 20
+	EXTI->PR = EXTI_IMR_MR20;
+	EXTI->IMR |= EXTI_IMR_MR20;
+
+	NVIC_SetPriority(RTC_WKUP_IRQn, RTC_WAKEUP_IRQ_PRIORITY);
+	NVIC_ClearPendingIRQ(RTC_WKUP_IRQn);
+	NVIC_EnableIRQ(RTC_WKUP_IRQn);
+}
+
+/**
+ * \brief Stops wakeup timer
+ */
+
+void rtcStopWakeupTimer(void)
+{
+	NVIC_DisableIRQ(RTC_WKUP_IRQn);
+	EXTI->IMR &= ~EXTI_IMR_MR20;
+
+	_writeProtection(false);
+	RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+	_writeProtection(true);
+
+	rtcClearWakeupFlag();
+}
+
+/**
+ * \brief Checks and clears flag of the wakeup timer
+ *
+ * \return true if the wakeup timer elapsed since the previous check, false otherwise
+ */
+
+bool rtcClearWakeupFlag(void)
+{
+	bool elapsed = (RTC->ISR & RTC_ISR_WUTF) != 0;
+
+	RTC->ISR = ~RTC_ISR_WUTF & ~RTC_ISR_INIT;	// rc_w0 flags, INIT is not set
+	EXTI->PR = EXTI_IMR_MR20;
+	NVIC_ClearPendingIRQ(RTC_WKUP_IRQn);
+
+	return elapsed;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Selects clock of the RTC
+ *
+ * LSE is selected if it gets ready within RTC_LSE_STARTUP_LOOPS, otherwise LSI is started and selected. LSE is left
+ * enabled in that case. RTC must not be clocked yet.
+ */
+
+static void _selectClock(void)
+{
+	for (uint32_t i = 0; i < RTC_LSE_STARTUP_LOOPS && (RCC->CSR & RCC_CSR_LSERDY) == 0; i++);
+
+	if ((RCC->CSR & RCC_CSR_LSERDY) != 0)
+	{
+		RCC->CSR = (RCC->CSR & ~RCC_CSR_RTCSEL) | RCC_CSR_RTCSEL_LSE | RCC_CSR_RTCEN;
+		_rtcFrequency = RTC_LSE_FREQUENCY;
+	}
+	else
+	{
+		RCC->CSR |= RCC_CSR_LSION;
+		while ((RCC->CSR & RCC_CSR_LSIRDY) == 0);
+
+		RCC->CSR = (RCC->CSR & ~RCC_CSR_RTCSEL) | RCC_CSR_RTCSEL_LSI | RCC_CSR_RTCEN;
+		_rtcFrequency = RTC_LSI_FREQUENCY;
+	}
+}
+
+/**
+ * \brief Sets prescalers of the RTC, so the calendar clock (ck_spre) has 1 Hz with the selected RTCCLK
+ */
+
+static void _setPrescalers(void)
+{
+	// ck_spre = RTCCLK / (PREDIV_A + 1) / (PREDIV_S + 1) = 1 Hz
+	uint32_t prediv_s = _rtcFrequency / (RTC_PREDIV_A + 1) - 1;
+
+	_writeProtection(false);
+
+	RTC->ISR |= RTC_ISR_INIT;
+	while ((RTC->ISR & RTC_ISR_INITF) == 0);
+
+	RTC->PRER = prediv_s;					// synchronous prescaler has to be written first
+	RTC->PRER = (RTC_PREDIV_A << 16) | prediv_s;
+
+	RTC->ISR &= ~RTC_ISR_INIT;
+
+	_writeProtection(true);
+}
+
+/**
+ * \brief Enables or disables write protection of RTC registers
+ *
+ * \param [in] enable true to lock the registers, false to unlock them
+ */
+
+static void _writeProtection(bool enable)
+{
+	if (enable == true)
+		RTC->WPR = 0xFF;
+	else
+	{
+		RTC->WPR = 0xCA;
+		RTC->WPR = 0x53;
+	}
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| ISRs
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief RTC alarm interrupt handler
+ *
+ * Clears alarm A flag and calls the function given to rtcEnableSecondInterrupt().
+ */
+
+extern "C" void RTC_Alarm_IRQHandler(void) __attribute__ ((interrupt));
+void RTC_Alarm_IRQHandler(void)
+{
+	struct RuntimeIsr isr;
+
+	runtimeIsrEnter(&isr);
+
+	RTC->ISR = ~RTC_ISR_ALRAF & ~RTC_ISR_INIT;	// rc_w0 flags, INIT is not set
+	EXTI->PR = EXTI_IMR_MR17;
+
+	if (_secondCallback != NULL)
+		_secondCallback();
+
+	runtimeIsrExit(&isr, RUNTIME_ISR_GROUP_RTC);
+}
+
+/**
+ * \brief RTC wakeup interrupt handler
+ *
+ * Clears the flag of the wakeup timer, which was not checked with rtcClearWakeupFlag().
+ */
+
+extern "C" void RTC_WKUP_IRQHandler(void) __attribute__ ((interrupt));
+void RTC_WKUP_IRQHandler(void)
+{
+	struct RuntimeIsr isr;
+
+	runtimeIsrEnter(&isr);
+
+	rtcClearWakeupFlag();
+
+	runtimeIsrExit(&isr, RUNTIME_ISR_GROUP_RTC);
+}
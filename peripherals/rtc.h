@@ -0,0 +1,43 @@
+/**
+ * \file rtc.h
+ * \brief Header for rtc.cpp
+ */
+
+#ifndef RTC_H_
+#define RTC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// function called from RTC interrupt every second
+typedef void (*rtcSecondCallback)(void);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+void rtcPrepareClock(void);
+
+uint32_t rtcInitialize(void);
+
+uint32_t rtcSwitchToLse(void);
+
+void rtcEnableSecondInterrupt(rtcSecondCallback callback);
+
+void rtcDisableSecondInterrupt(void);
+
+uint32_t rtcGetWakeupFrequency(void);
+
+uint32_t rtcGetSecondOfDay(void);
+
+void rtcStartWakeupTimer(uint16_t reload);
+
+void rtcStopWakeupTimer(void);
+
+bool rtcClearWakeupFlag(void);
+
+#endif /* RTC_H_ */
@@ -0,0 +1,295 @@
+/**
+ * \file runtime.cpp
+ * \brief Run-time counter for FreeRTOS statistics and ISR accounting
+ *
+ * 32-bit run-time counter with RUNTIME_FREQUENCY resolution - TIM6 counts the low half, its overflow interrupt adds
+ * the high half. The prescaler is recalculated when the core frequency changes, and time spent in STOP mode (when TIM6
+ * is stopped) is added by tickless idle, so the counter measures time regardless of the clock. It is used by FreeRTOS
+ * (portGET_RUN_TIME_COUNTER_VALUE()) to account run time of tasks.
+ *
+ * Run time of ISRs is accounted in groups, between runtimeIsrEnter() and runtimeIsrExit(), excluding nested ISRs. ISRs
+ * shorter than the resolution are accounted statistically - the difference of two samples of the counter is on average
+ * equal to the duration. Accounting is enabled only while somebody reads it, otherwise both calls return at once.
+ * Run time of tasks includes ISRs which preempted them. Both calls also record entry and exit of the ISR in the trace
+ * recorder, regardless of accounting.
+ *
+ * chip: STM32L1xx; prefix: runtime
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stm32l152xb.h"
+
+#include "config.h"
+
+#include "hdr/hdr_rcc.h"
+
+#include "rcc.h"
+#include "runtime.h"
+#include "trace.h"
+
+#include "FreeRTOS.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static void _clockPostChange(uint32_t frequency);
+static uint16_t _prescaler(uint32_t frequency);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+static volatile uint32_t _base;				///< value of the counter when TIM6->CNT was 0
+
+static volatile bool _isrAccounting;		///< ISR accounting enabled
+static volatile uint32_t _isrNested;		///< run time of ISRs nested in the current one
+static volatile uint32_t _isrCounters[RUNTIME_ISR_GROUP_COUNT];	///< run time of groups of ISRs
+
+/// names of groups of ISRs
+static const char * const _isrGroupNames[RUNTIME_ISR_GROUP_COUNT] =
+{
+#define RUNTIME_ISR_GROUP_NAME(name)		#name,
+	RUNTIME_ISR_GROUP_TABLE(RUNTIME_ISR_GROUP_NAME)
+#undef RUNTIME_ISR_GROUP_NAME
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Starts the run-time counter.
+ *
+ * Starts the run-time counter. Implementation of portCONFIGURE_TIMER_FOR_RUN_TIME_STATS(), called by FreeRTOS when the
+ * scheduler is started.
+ */
+
+void runtimeInitialize(void)
+{
+	RCC_APB1ENR_TIM6EN_bb = 1;				// enable timer
+
+	DBGMCU->APB1FZ |= DBGMCU_APB1_FZ_DBG_TIM6_STOP;
+
+	TIM6->CNT = 0;							// clear the timer
+	TIM6->PSC = _prescaler(rccGetCoreFrequency());
+	TIM6->ARR = 0xFFFF;						// max autoreload
+	TIM6->CR1 = TIM_CR1_URS;				// only overflow generates update interrupt, UG doesn't
+	TIM6->EGR = TIM_EGR_UG;					// load the prescaler
+	TIM6->SR = 0;
+	TIM6->DIER = TIM_DIER_UIE;				// enable update interrupt
+	TIM6->CR1 = TIM_CR1_URS | TIM_CR1_CEN;	// enable timer
+
+	_base = 0;
+
+	NVIC_SetPriority(TIM6_IRQn, TIM6_IRQ_PRIORITY);
+	NVIC_EnableIRQ(TIM6_IRQn);
+
+	rccRegisterClockCallbacks(nullptr, _clockPostChange);
+}
+
+/**
+ * \brief Reads the run-time counter.
+ *
+ * Reads the run-time counter. Implementation of portGET_RUN_TIME_COUNTER_VALUE(), may be called from tasks and ISRs,
+ * also with interrupts masked (overflow not handled yet is detected with UIF flag).
+ *
+ * \return current value of the counter, in 1 / RUNTIME_FREQUENCY s
+ */
+
+uint32_t runtimeGetCounter(void)
+{
+	uint32_t base;
+	uint32_t count;
+
+	do
+	{
+		base = _base;
+		count = TIM6->CNT;
+
+		if ((TIM6->SR & TIM_SR_UIF) != 0)	// overflow not handled yet? read CNT again, it surely is after overflow
+			count = TIM6->CNT + 0x10000;
+	} while (base != _base);				// retry if overflow was handled meanwhile
+
+	return base + count;
+}
+
+/**
+ * \brief Adds time spent in STOP mode to the run-time counter.
+ *
+ * Adds time spent in STOP mode (in which TIM6 doesn't count) to the run-time counter, so it is accounted to the idle
+ * task. Called by tickless idle with interrupts disabled.
+ *
+ * \param [in] ticks is the time spent in STOP mode, in ticks
+ */
+
+void runtimeAddStoppedTime(uint32_t ticks)
+{
+	_base += ((uint64_t)ticks * RUNTIME_FREQUENCY) / configTICK_RATE_HZ;
+}
+
+/**
+ * \brief Enables or disables accounting of ISRs.
+ *
+ * \param [in] enable selects whether runtimeIsrEnter() and runtimeIsrExit() account run time of ISRs
+ */
+
+void runtimeEnableIsrAccounting(bool enable)
+{
+	_isrAccounting = enable;
+}
+
+/**
+ * \brief Starts accounting of ISR.
+ *
+ * Starts accounting of ISR, must be paired with runtimeIsrExit() at the end of the ISR.
+ *
+ * \param [out] isr is the state of this execution of ISR, local variable of the ISR
+ */
+
+void runtimeIsrEnter(struct RuntimeIsr *isr)
+{
+	traceRecord(TRACE_EVENT_ISR_ENTER, __get_IPSR(), 0);
+
+	isr->active = _isrAccounting;
+
+	if (isr->active == false)
+		return;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	isr->start = runtimeGetCounter();
+	isr->nested = _isrNested;				// save time of ISRs nested in the preempted one
+	_isrNested = 0;
+
+	__set_PRIMASK(primask);
+}
+
+/**
+ * \brief Ends accounting of ISR.
+ *
+ * Ends accounting of ISR - adds its run time, excluding nested ISRs, to the group. The whole run time is added to
+ * nested time of the preempted ISR.
+ *
+ * \param [in] isr is the state passed to runtimeIsrEnter()
+ * \param [in] group is the group of the ISR
+ */
+
+void runtimeIsrExit(struct RuntimeIsr *isr, enum RuntimeIsrGroup group)
+{
+	traceRecord(TRACE_EVENT_ISR_EXIT, __get_IPSR(), 0);
+
+	if (isr->active == false)
+		return;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	uint32_t elapsed = runtimeGetCounter() - isr->start;
+
+	_isrCounters[group] += elapsed - _isrNested;
+	_isrNested = isr->nested + elapsed;
+
+	__set_PRIMASK(primask);
+}
+
+/**
+ * \brief Reads run time of a group of ISRs.
+ *
+ * \param [in] group is the group of ISRs
+ *
+ * \return run time of the group, in 1 / RUNTIME_FREQUENCY s, counted only while accounting was enabled
+ */
+
+uint32_t runtimeGetIsrCounter(enum RuntimeIsrGroup group)
+{
+	return _isrCounters[group];
+}
+
+/**
+ * \brief Gets name of a group of ISRs.
+ *
+ * \param [in] group is the group of ISRs
+ *
+ * \return name of the group, as in RUNTIME_ISR_GROUP_TABLE
+ */
+
+const char* runtimeGetIsrGroupName(enum RuntimeIsrGroup group)
+{
+	return _isrGroupNames[group];
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Recalculates the prescaler of TIM6 after the change of core frequency.
+ *
+ * Recalculates the prescaler of TIM6 after the change of core frequency (APB1 runs at core frequency). The prescaler is
+ * loaded at once with UG, which clears the counter, so its value is moved to _base.
+ *
+ * \param [in] frequency is the new frequency of the core, in Hz
+ */
+
+static void _clockPostChange(uint32_t frequency)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	uint32_t counter = runtimeGetCounter();
+
+	TIM6->PSC = _prescaler(frequency);
+	TIM6->EGR = TIM_EGR_UG;					// load the prescaler, clear the counter
+	TIM6->SR = 0;							// pending overflow is already in counter
+	NVIC_ClearPendingIRQ(TIM6_IRQn);
+
+	_base = counter;
+
+	__set_PRIMASK(primask);
+}
+
+/**
+ * \brief Calculates the prescaler of TIM6.
+ *
+ * \param [in] frequency is the frequency of the core, in Hz
+ *
+ * \return value of TIM6->PSC giving the frequency closest to RUNTIME_FREQUENCY, slower MSI ranges give up to 7% error
+ */
+
+static uint16_t _prescaler(uint32_t frequency)
+{
+	uint32_t divider = (frequency + RUNTIME_FREQUENCY / 2) / RUNTIME_FREQUENCY;
+
+	if (divider == 0)
+		divider = 1;
+
+	return divider - 1;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| ISRs
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief TIM6_IRQHandler
+ *
+ * TIM6_IRQHandler - adds the overflow of TIM6 to the run-time counter.
+ */
+
+extern "C" void TIM6_IRQHandler(void) __attribute__ ((interrupt));
+void TIM6_IRQHandler(void)
+{
+	__disable_irq();						// _base and UIF are changed together for runtimeGetCounter() in other ISRs
+
+	if ((TIM6->SR & TIM_SR_UIF) != 0)		// not handled by _clockPostChange() already?
+	{
+		_base += 0x10000;
+		TIM6->SR = 0;						// clear UIF which is only bit in this register
+	}
+
+	__enable_irq();
+}
@@ -0,0 +1,61 @@
+/**
+ * \file runtime.h
+ * \brief Header for runtime.cpp
+ */
+
+#ifndef RUNTIME_H_
+#define RUNTIME_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// groups of ISRs with accounted run time, see RUNTIME_ISR_GROUP_TABLE in config.h
+enum RuntimeIsrGroup {
+#define RUNTIME_ISR_GROUP_ENUM(name)		RUNTIME_ISR_GROUP_##name,
+	RUNTIME_ISR_GROUP_TABLE(RUNTIME_ISR_GROUP_ENUM)
+#undef RUNTIME_ISR_GROUP_ENUM
+	RUNTIME_ISR_GROUP_COUNT
+};
+
+/// state of one execution of ISR, kept on its stack between runtimeIsrEnter() and runtimeIsrExit()
+struct RuntimeIsr {
+	uint32_t start;							///< run-time counter at entry
+	uint32_t nested;						///< run time of nested ISRs of the preempted ISR
+	bool active;							///< ISR accounting was enabled at entry
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void runtimeInitialize(void);
+
+uint32_t runtimeGetCounter(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+void runtimeAddStoppedTime(uint32_t ticks);
+
+void runtimeEnableIsrAccounting(bool enable);
+
+void runtimeIsrEnter(struct RuntimeIsr *isr);
+
+void runtimeIsrExit(struct RuntimeIsr *isr, enum RuntimeIsrGroup group);
+
+uint32_t runtimeGetIsrCounter(enum RuntimeIsrGroup group);
+
+const char* runtimeGetIsrGroupName(enum RuntimeIsrGroup group);
+
+#endif /* RUNTIME_H_ */
@@ -32,6 +32,13 @@
 #include "helper.h"
 #include "error.h"
 
+/*---------------------------------------------------------------------------------------------------------------------+
+ | local functions' declarations
+ +---------------------------------------------------------------------------------------------------------------------*/
+
+static void _clockPreChange(uint32_t frequency);
+static void _clockPostChange(uint32_t frequency);
+
 
 /**
  * \brief Initializes USART
@@ -46,8 +53,7 @@
 enum Error serialInitialize(void)
 {
 	RCC->APB1ENR |= RCC_APB1ENR_USART2EN;
-	gpioConfigurePin(GPIOA, GPIO_PIN_2, GPIO_AF7_PP_40MHz_PULL_UP);
-	gpioConfigurePin(GPIOA, GPIO_PIN_3, GPIO_AF7_PP_40MHz_PULL_UP);
+	gpioConfigurePins(GPIOA, GPIO_PIN_MASK(GPIO_PIN_2) | GPIO_PIN_MASK(GPIO_PIN_3), GPIO_AF7_PP_40MHz_PULL_UP);
 
 	RCC_APB1ENR_USART2EN_bb = 1;			// enable USART in RCC
 
@@ -55,6 +61,9 @@ enum Error serialInitialize(void)
 	// enable peripheral, transmitter and receiver, enable RXNE interrupt
 	USART2->CR1 = USART_CR1_UE | USART_CR1_TE | USART_CR1_RE;
 
+	rccRegisterClockCallbacks(_clockPreChange, _clockPostChange);
+
+	return ERROR_NONE;
 }
 
 /**
@@ -80,3 +89,32 @@ void serialSendString(char *s)
 		s++;
 	}
 }
+
+/*---------------------------------------------------------------------------------------------------------------------+
+ | local functions
+ +---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Waits for the end of transmission before the change of core frequency.
+ *
+ * \param [in] frequency is the new frequency of the core in Hz
+ */
+
+static void _clockPreChange(uint32_t frequency)
+{
+	(void) frequency;						// suppress warning
+
+	while (USARTx_SR_TC_bb(SERIALx) == 0);	// wait for transmission complete
+}
+
+/**
+ * \brief Sets baudrate for new core frequency.
+ *
+ * \param [in] frequency is the new frequency of the core in Hz
+ */
+
+static void _clockPostChange(uint32_t frequency)
+{
+	SERIALx->BRR = (frequency + SERIALx_BAUDRATE / 2) / SERIALx_BAUDRATE;	// calculate baudrate (with rounding)
+}
+
@@ -24,6 +24,31 @@
 #include "rcc.h"
 #include "spi.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static void _clockPreChange(uint32_t frequency);
+static void _clockPostChange(uint32_t frequency);
+static void _lock(void);
+static void _unlock(void);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+static uint32_t _baudRate = SPIx_BOUDRATE;	///< baud rate requested with spiSetBaudRate()
+
+static xSemaphoreHandle _transferLock;		///< held by transfers and by changes of core frequency
+static xStaticQueue _transferLockBuffer;
+
+static xSemaphoreHandle _busLock;			///< held by a slave from its selection till its deselection
+static xStaticQueue _busLockBuffer;
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | global functions
 +---------------------------------------------------------------------------------------------------------------------*/
@@ -36,24 +61,37 @@
 
 void spiInitialize(void)
 {
-	gpioConfigurePin(SPIx_MISO_GPIO, SPIx_MISO_PIN, SPIx_MISO_CONFIGURATION);
-	gpioConfigurePin(SPIx_MOSI_GPIO, SPIx_MOSI_PIN, SPIx_MOSI_CONFIGURATION);
-	gpioConfigurePin(SPIx_SCK_GPIO, SPIx_SCK_PIN, SPIx_SCK_CONFIGURATION);
-	gpioConfigurePin(SPIx_SSB_GPIO, SPIx_SSB_PIN, SPIx_SSB_CONFIGURATION);
+	if (_transferLock == NULL)				// initialized again by the driver of memory card?
+	{
+		_transferLock = xSemaphoreCreateMutexStatic(&_transferLockBuffer);
+		_busLock = xSemaphoreCreateMutexStatic(&_busLockBuffer);
+	}
+
+	static const struct GpioPinGroup pins[] =
+	{
+			GPIO_PIN_GROUP(SPIx_MISO_GPIO, GPIO_PIN_MASK(SPIx_MISO_PIN), SPIx_MISO_CONFIGURATION),
+			GPIO_PIN_GROUP(SPIx_MOSI_GPIO, GPIO_PIN_MASK(SPIx_MOSI_PIN), SPIx_MOSI_CONFIGURATION),
+			GPIO_PIN_GROUP(SPIx_SCK_GPIO, GPIO_PIN_MASK(SPIx_SCK_PIN), SPIx_SCK_CONFIGURATION),
+			GPIO_PIN_GROUP(SPIx_SSB_GPIO, GPIO_PIN_MASK(SPIx_SSB_PIN), SPIx_SSB_CONFIGURATION),
+	};
 
-	SPIx_SSB_bb=SPIx_SSB_END;
+	gpioConfigurePinGroups(pins, sizeof(pins) / sizeof(pins[0]));
+
+	SPIx_SSB_Pin::write(SPIx_SSB_END);
 
 	RCC_APBxENR_SPIxEN_bb = 1;
 
 	SPIx->CR1 = SPI_CR1_SSM | SPI_CR1_SSI | SPI_CR1_SPE | SPI_CR1_MSTR;	// software slave management, enable SPI, master mode
 
 	spiSetBaudRate(SPIx_BOUDRATE);
+
+	rccRegisterClockCallbacks(_clockPreChange, _clockPostChange);
 }
 
 /**
  * \brief Sets SPI baud rate.
  *
- * Sets SPI baud rate.
+ * Sets SPI baud rate. The baud rate is kept when the core frequency changes.
  *
  * \param [in] baud_rate is desired baud rate in Hz
  *
@@ -62,6 +100,8 @@ void spiInitialize(void)
 
 uint32_t spiSetBaudRate(uint32_t baud_rate)
 {
+	_baudRate = baud_rate;					// remembered for changes of core frequency
+
 	uint32_t real_baud_rate = rccGetCoreFrequency() / 2;	// max baud rate is f_PCLK / 2
 	uint32_t br = 0;
 
@@ -79,7 +119,8 @@ uint32_t spiSetBaudRate(uint32_t baud_rate)
 /**
  * \brief Transfers data through SPI.
  *
- * Bidirectional transfer of data through SPI (simultaneous tx and rx).
+ * Bidirectional transfer of data through SPI (simultaneous tx and rx). Core frequency doesn't change during the
+ * transfer, so the whole transfer has the baud rate set with spiSetBaudRate().
  *
  * \param [in] tx is the pointer to transferred data buffer, nullptr if blank bytes should be transferred (0xFF)
  * \param [out] rx is the pointer to received data buffer, nullptr if received data should be discarded
@@ -93,6 +134,8 @@ size_t spiTransfer(const uint8_t *tx, uint8_t *rx, size_t length)
 	size_t rx_length = 0;
 	uint8_t tx_byte = 0xFF;
 
+	_lock();
+
 	while(length--)
 	{
 		if (tx != nullptr)					// should data be transfered?
@@ -105,15 +148,109 @@ size_t spiTransfer(const uint8_t *tx, uint8_t *rx, size_t length)
 		rx_length++;						// increment counter
 	}
 
+	_unlock();
+
 	return rx_length;
 }
 
-void spiStart(void) {
-	while(SPIx_SSB_bb != SPIx_SSB_START)
-		SPIx_SSB_bb = SPIx_SSB_START;
+/**
+ * \brief Locks the bus for a transaction of one slave.
+ *
+ * Slaves have their own chip selects, so the lock has to be held from the selection of the slave till its
+ * deselection, otherwise transfers of another slave could be interleaved. Does nothing when the scheduler is not
+ * running.
+ */
+
+void spiLock(void)
+{
+	if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+		xSemaphoreTake(_busLock, portMAX_DELAY);
+}
+
+/**
+ * \brief Unlocks the bus locked with spiLock().
+ */
+
+void spiUnlock(void)
+{
+	if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+		xSemaphoreGive(_busLock);
+}
+
+/**
+ * \brief Locks the bus and selects the slave (drives SSB active) with a single write to BSRR.
+ */
+
+void spiStart(void)
+{
+	spiLock();
+	SPIx_SSB_Pin::write(SPIx_SSB_START);
+}
+
+/**
+ * \brief Deselects the slave (drives SSB inactive) with a single write to BSRR and unlocks the bus locked by
+ * spiStart().
+ */
+
+void spiStop(void)
+{
+	SPIx_SSB_Pin::write(SPIx_SSB_END);
+	spiUnlock();
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Waits for the end of transfer before the change of core frequency.
+ *
+ * Transfers are locked till _clockPostChange(), so none is started with the prescaler of the old frequency.
+ *
+ * \param [in] frequency is the new frequency of the core in Hz
+ */
+
+static void _clockPreChange(uint32_t frequency)
+{
+	(void) frequency;						// suppress warning
+
+	_lock();
+
+	while ((SPIx->SR & SPI_SR_BSY) != 0);	// wait for transfer end
+}
+
+/**
+ * \brief Restores requested baud rate for new core frequency and unlocks transfers locked by _clockPreChange().
+ *
+ * \param [in] frequency is the new frequency of the core in Hz, already returned by rccGetCoreFrequency()
+ */
+
+static void _clockPostChange(uint32_t frequency)
+{
+	(void) frequency;						// suppress warning
+
+	spiSetBaudRate(_baudRate);
+
+	_unlock();
 }
 
-void spiStop(void) {
-	while(SPIx_SSB_bb != SPIx_SSB_END)
-		SPIx_SSB_bb = SPIx_SSB_END;
+/**
+ * \brief Locks transfers, does nothing when the scheduler is not running.
+ */
+
+static void _lock(void)
+{
+	if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+		xSemaphoreTake(_transferLock, portMAX_DELAY);
 }
+
+/**
+ * \brief Unlocks transfers locked with _lock().
+ */
+
+static void _unlock(void)
+{
+	if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+		xSemaphoreGive(_transferLock);
+}
+
@@ -22,6 +22,8 @@
 void spiInitialize(void);
 uint32_t spiSetBaudRate(uint32_t baud_rate);
 size_t spiTransfer(const uint8_t *tx, uint8_t *rx, size_t length);
+void spiLock(void);
+void spiUnlock(void);
 void spiStart(void);
 void spiStop(void);
 
@@ -0,0 +1,358 @@
+/**
+ * \file trace.cpp
+ * \brief Recorder of kernel events
+ *
+ * Flight recorder of kernel events - context switches, tasks becoming ready, queue operations, task notifications,
+ * priority inheritance, ISRs (from runtimeIsrEnter() and runtimeIsrExit()), changes of the core clock and STOP mode.
+ * FreeRTOS trace macros (FreeRTOSConfig.h) call traceRecord(), which stores an 8-byte event with DWT cycle counter
+ * timestamp in a RAM ring buffer of TRACE_EVENTS events, the oldest ones are overwritten. Recording takes a few dozen
+ * cycles with interrupts masked, when stopped it returns at once.
+ *
+ * traceDump() stops recording, prints the buffer as text lines and starts recording again, so the dump itself is not
+ * recorded. Recording may be stopped earlier with traceStop() when a problem is detected, the buffer then keeps
+ * events which led to it. tools/trace/trace_json.awk converts the dump to Chrome trace JSON (chrome://tracing).
+ *
+ * Timestamps are cycles of the core, so the recorder also records the frequency before and after each change of the
+ * clock. DWT doesn't count in STOP mode, the time spent there (in ticks, like the correction of the tick count) is
+ * recorded at wakeup.
+ *
+ * chip: STM32L1xx; prefix: trace
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "stm32l152xb.h"
+
+#include "config.h"
+
+#include "rcc.h"
+#include "trace.h"
+
+#include "FreeRTOS.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// recorded event
+struct _Event {
+	uint32_t cycles;						///< DWT->CYCCNT when the event was recorded
+	uint8_t type;							///< type of event, enum TraceEventType
+	uint8_t object;							///< task, queue or exception number
+	uint16_t value;							///< value, depends on the type
+};
+
+/// name of a traced task, kept also after the task is deleted
+struct _Task {
+	uint8_t number;							///< unique number of the task, uxTCBNumber
+	char name[configMAX_TASK_NAME_LEN];		///< name of the task
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static void _clockPreChange(uint32_t frequency);
+static void _clockPostChange(uint32_t frequency);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+static struct _Event _events[TRACE_EVENTS];	///< ring buffer of events
+static volatile size_t _head;				///< index of the next event
+static volatile size_t _count;				///< number of valid events
+static volatile uint32_t _overwritten;		///< number of events overwritten since the start
+static volatile bool _recording;			///< events are recorded
+static int16_t _lastTask;					///< number of the task switched in last, -1 after traceStart()
+
+static struct _Task _tasks[TRACE_MAX_TASKS];	///< names of tasks, the oldest entry is reused when full
+static size_t _tasksHead;					///< index of the next entry in _tasks
+static uint8_t _queueTypes[TRACE_MAX_QUEUES];	///< types of queues, queue number n is at index n - 1
+static uint8_t _queueCount;					///< number of registered queues
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Starts DWT cycle counter (if not started yet by boottimeStart()) and recording.
+ *
+ * The counter is never written - it runs free from reset and its wrap is handled by the converter.
+ */
+
+void traceInitialize(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;	// enable DWT
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	rccRegisterClockCallbacks(_clockPreChange, _clockPostChange);
+
+	traceStart();
+}
+
+/**
+ * \brief Clears the buffer and starts recording.
+ */
+
+void traceStart(void)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	_head = 0;
+	_count = 0;
+	_overwritten = 0;
+	_lastTask = -1;
+	_recording = true;
+
+	__set_PRIMASK(primask);
+
+	traceRecord(TRACE_EVENT_CLOCK_POST_CHANGE, 0, rccGetCoreFrequency() / 1000);	// time base for the converter
+}
+
+/**
+ * \brief Stops recording, the buffer is kept till the next traceStart(). Can be used in interrupts.
+ */
+
+void traceStop(void)
+{
+	_recording = false;
+}
+
+/**
+ * \brief Records an event of the application, e.g. start and end of a processing step.
+ *
+ * \param [in] id is the identifier of the mark
+ * \param [in] value is the value of the mark
+ */
+
+void traceMark(uint8_t id, uint16_t value)
+{
+	traceRecord(TRACE_EVENT_MARK, id, value);
+}
+
+/**
+ * \brief Records an event.
+ *
+ * Records an event, overwriting the oldest one if the buffer is full. Called from FreeRTOS trace macros, can be used
+ * in tasks and interrupts of any priority.
+ *
+ * \param [in] type is the type of the event
+ * \param [in] object is the task, queue or exception number
+ * \param [in] value is the value, depends on the type
+ */
+
+void traceRecord(enum TraceEventType type, uint8_t object, uint16_t value)
+{
+	if (_recording == false)
+		return;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (_recording == true)					// not stopped after the check above?
+	{
+		struct _Event *event = &_events[_head];
+
+		event->cycles = DWT->CYCCNT;
+		event->type = type;
+		event->object = object;
+		event->value = value;
+
+		if (++_head == TRACE_EVENTS)
+			_head = 0;
+
+		if (_count < TRACE_EVENTS)
+			_count++;
+		else
+			_overwritten++;
+	}
+
+	__set_PRIMASK(primask);
+}
+
+/**
+ * \brief Records a context switch.
+ *
+ * Records a context switch, unless the same task continues (the tick of this port always requests PendSV). Called from
+ * traceTASK_SWITCHED_IN() with interrupts masked.
+ *
+ * \param [in] number is the unique number of the task
+ * \param [in] priority is the current priority of the task
+ */
+
+void traceTaskSwitchedIn(uint8_t number, uint16_t priority)
+{
+	if (_recording == false || _lastTask == number)
+		return;
+
+	_lastTask = number;
+	traceRecord(TRACE_EVENT_TASK_SWITCHED_IN, number, priority);
+}
+
+/**
+ * \brief Registers a new task.
+ *
+ * Registers a new task, its name is printed by traceDump(). Called from traceTASK_CREATE().
+ *
+ * \param [in] number is the unique number of the task
+ * \param [in] name is the name of the task
+ */
+
+void traceAddTask(uint8_t number, const char *name)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	struct _Task *task = &_tasks[_tasksHead];
+
+	task->number = number;
+	strncpy(task->name, name, sizeof(task->name) - 1);
+	task->name[sizeof(task->name) - 1] = '\0';
+
+	if (++_tasksHead == TRACE_MAX_TASKS)
+		_tasksHead = 0;
+
+	__set_PRIMASK(primask);
+}
+
+/**
+ * \brief Registers a new queue.
+ *
+ * Registers a new queue and assigns its number. Called from traceQUEUE_CREATE() and traceCREATE_MUTEX().
+ *
+ * \param [in] type is the type of the queue, ucQueueType
+ *
+ * \return number of the queue, 0 if there are already TRACE_MAX_QUEUES queues
+ */
+
+uint8_t traceAddQueue(uint8_t type)
+{
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	uint8_t number = 0;
+
+	if (_queueCount < TRACE_MAX_QUEUES)
+	{
+		_queueTypes[_queueCount++] = type;
+		number = _queueCount;
+	}
+
+	__set_PRIMASK(primask);
+
+	return number;
+}
+
+/**
+ * \brief Prints the buffer.
+ *
+ * Stops recording, prints the buffer and starts recording again. Lines (terminated with "\r\n"):
+ * - "TRACE <core frequency in Hz> <tick rate in Hz> <number of events> <number of overwritten events>",
+ * - "TASK <number> <name>" for each task created since reset (up to TRACE_MAX_TASKS last ones),
+ * - "QUEUE <number> <type>" for each queue (0 - queue, 1 - mutex, 2 - counting semaphore, 3 - binary semaphore),
+ * - "E <DWT cycles, hex> <type> <object> <value>" for each event, the oldest first,
+ * - "END".
+ *
+ * \param [in] write is the writer of lines, it may block
+ *
+ * \return true if all lines were written, false if the writer aborted the dump
+ */
+
+bool traceDump(TraceWriter write)
+{
+	char line[48];
+	bool success = false;
+
+	traceStop();
+
+	do
+	{
+		sprintf(line, "TRACE %u %u %u %u\r\n", (unsigned int)rccGetCoreFrequency(),
+				(unsigned int)configTICK_RATE_HZ, (unsigned int)_count, (unsigned int)_overwritten);
+		if (write(line) == false)
+			break;
+
+		size_t task;
+
+		for (task = 0; task < TRACE_MAX_TASKS; task++)
+			if (_tasks[task].name[0] != '\0')
+			{
+				sprintf(line, "TASK %u %s\r\n", _tasks[task].number, _tasks[task].name);
+				if (write(line) == false)
+					break;
+			}
+
+		if (task != TRACE_MAX_TASKS)
+			break;
+
+		size_t queue;
+
+		for (queue = 0; queue < _queueCount; queue++)
+		{
+			sprintf(line, "QUEUE %u %u\r\n", (unsigned int)queue + 1, _queueTypes[queue]);
+			if (write(line) == false)
+				break;
+		}
+
+		if (queue != _queueCount)
+			break;
+
+		size_t i;
+		size_t index = (_head + TRACE_EVENTS - _count) % TRACE_EVENTS;	// the oldest event
+
+		for (i = 0; i < _count; i++)
+		{
+			const struct _Event *event = &_events[index];
+
+			sprintf(line, "E %08x %u %u %u\r\n", (unsigned int)event->cycles, event->type, event->object,
+					event->value);
+			if (write(line) == false)
+				break;
+
+			if (++index == TRACE_EVENTS)
+				index = 0;
+		}
+
+		if (i != _count)
+			break;
+
+		success = write("END\r\n");
+	} while (0);
+
+	traceStart();
+
+	return success;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Records the frequency before the change of core frequency.
+ *
+ * \param [in] frequency is the new frequency of the core, in Hz
+ */
+
+static void _clockPreChange(uint32_t frequency)
+{
+	(void) frequency;						// suppress warning
+
+	traceRecord(TRACE_EVENT_CLOCK_PRE_CHANGE, 0, rccGetCoreFrequency() / 1000);
+}
+
+/**
+ * \brief Records the frequency after the change of core frequency.
+ *
+ * \param [in] frequency is the new frequency of the core, in Hz
+ */
+
+static void _clockPostChange(uint32_t frequency)
+{
+	traceRecord(TRACE_EVENT_CLOCK_POST_CHANGE, 0, frequency / 1000);
+}
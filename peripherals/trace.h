@@ -0,0 +1,82 @@
+/**
+ * \file trace.h
+ * \brief Header for trace.cpp
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// types of recorded events, numbers are used by tools/trace/trace_json.awk - append new ones at the end
+enum TraceEventType {
+	TRACE_EVENT_TASK_SWITCHED_IN,			///< object - task, value - its current priority
+	TRACE_EVENT_TASK_READY,					///< object - task, value - its current priority
+	TRACE_EVENT_TASK_DELAY,					///< object - task, value - ticks
+	TRACE_EVENT_TASK_DELAY_UNTIL,			///< object - task
+	TRACE_EVENT_TASK_SUSPEND,				///< object - task
+	TRACE_EVENT_TASK_DELETE,				///< object - task
+	TRACE_EVENT_PRIORITY_INHERIT,			///< object - task holding the mutex, value - inherited priority
+	TRACE_EVENT_PRIORITY_DISINHERIT,		///< object - task releasing the mutex, value - its base priority
+	TRACE_EVENT_QUEUE_SEND,					///< object - queue, value - items in queue before the operation
+	TRACE_EVENT_QUEUE_RECEIVE,				///< object - queue, value - items in queue before the operation
+	TRACE_EVENT_QUEUE_PEEK,					///< object - queue, value - items in queue
+	TRACE_EVENT_QUEUE_SEND_FROM_ISR,		///< object - queue, value - items in queue before the operation
+	TRACE_EVENT_QUEUE_RECEIVE_FROM_ISR,		///< object - queue, value - items in queue before the operation
+	TRACE_EVENT_QUEUE_BLOCKING_SEND,		///< object - queue, value - items in queue
+	TRACE_EVENT_QUEUE_BLOCKING_RECEIVE,		///< object - queue, value - items in queue
+	TRACE_EVENT_QUEUE_SEND_FAILED,			///< object - queue, value - items in queue
+	TRACE_EVENT_QUEUE_RECEIVE_FAILED,		///< object - queue, value - items in queue
+	TRACE_EVENT_ISR_ENTER,					///< object - exception number
+	TRACE_EVENT_ISR_EXIT,					///< object - exception number
+	TRACE_EVENT_CLOCK_PRE_CHANGE,			///< value - core frequency before the change, in kHz
+	TRACE_EVENT_CLOCK_POST_CHANGE,			///< value - core frequency after the change, in kHz
+	TRACE_EVENT_STOP,						///< value - ticks spent in STOP mode (DWT doesn't count), recorded at wakeup
+	TRACE_EVENT_MARK,						///< object and value - passed to traceMark()
+	TRACE_EVENT_NOTIFY_GIVE,				///< object - notified task, value - its notification count after the give
+	TRACE_EVENT_NOTIFY_GIVE_FROM_ISR,		///< object - notified task, value - its notification count after the give
+	TRACE_EVENT_NOTIFY_TAKE_BLOCK,			///< object - task, value - ticks to wait (0xFFFF - forever)
+	TRACE_EVENT_NOTIFY_TAKE,				///< object - task, value - its notification count before the take
+};
+
+/// writer of dump lines - sends the line and returns true, or returns false to abort the dump
+typedef bool (*TraceWriter)(const char *line);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void traceRecord(enum TraceEventType type, uint8_t object, uint16_t value);
+
+void traceAddTask(uint8_t number, const char *name);
+
+void traceTaskSwitchedIn(uint8_t number, uint16_t priority);
+
+uint8_t traceAddQueue(uint8_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+void traceInitialize(void);
+
+void traceStart(void);
+
+void traceStop(void);
+
+void traceMark(uint8_t id, uint16_t value);
+
+bool traceDump(TraceWriter write);
+
+#endif /* TRACE_H_ */
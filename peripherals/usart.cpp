@@ -4,6 +4,9 @@
  *
  * Functions for USART control
  *
+ * USART doesn't receive in STOP mode, so the console is woken up by the start bit on RX pin (EXTI). The first
+ * character is lost - it only takes the no-stop lock, which is held till no input comes for USARTx_CONSOLE_IDLE_ms.
+ *
  * chip: STM32L1xx; prefix: usart
  *
  * \author Freddie Chopin, http://www.freddiechopin.info http://www.distortec.com
@@ -26,14 +29,17 @@
 
 #include "gpio.h"
 #include "rcc.h"
+#include "power.h"
+#include "pools.h"
+#include "runtime.h"
 #include "usart.h"
+#include "command.h"
 #include "helper.h"
 #include "error.h"
 
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
-#include "semphr.h"
 
 /*---------------------------------------------------------------------------------------------------------------------+
  | local variables' types
@@ -65,6 +71,11 @@ struct _TxMessage {
 
 static void _rxTask(void *parameters);
 static void _txTask(void *parameters);
+static void _clockPreChange(uint32_t frequency);
+static void _clockPostChange(uint32_t frequency);
+static char* _allocateString(size_t length);
+static void _freeString(char *string);
+static enum Error _send(char *string, size_t length, portTickType ticks_to_wait);
 
 /*---------------------------------------------------------------------------------------------------------------------+
  | local defines
@@ -81,9 +92,24 @@ extern char __ram_start[];					// imported from linker script
 
 static xQueueHandle _rxQueue;
 static xQueueHandle _txQueue;
-static xSemaphoreHandle _dmaTxSemaphore;
+
+static xTaskHandle _txTaskHandle;			///< USART TX task, notified by DMA ISR and _clockPostChange()
+static volatile bool _dmaBusy;				///< DMA TX transfer in progress
+static volatile bool _txHeld;				///< transmission held by _clockPreChange() till _clockPostChange()
+static volatile xTaskHandle _dmaWaiter;		///< task waiting in _clockPreChange() for the end of DMA TX transfer
+
+static xStaticQueue _rxQueueBuffer;
+static xStaticQueue _txQueueBuffer;
+static uint8_t _rxQueueStorage[queueSTATIC_STORAGE_SIZE(USARTx_RX_QUEUE_LENGTH, sizeof(struct _RxMessage))];
+static uint8_t _txQueueStorage[queueSTATIC_STORAGE_SIZE(USARTx_TX_QUEUE_LENGTH, sizeof(struct _TxMessage))];
+
+static xStaticTask _rxTaskBuffer;
+static xStaticTask _txTaskBuffer;
+static portSTACK_TYPE _rxTaskStack[USART_RX_STACK_SIZE];
+static portSTACK_TYPE _txTaskStack[USART_TX_STACK_SIZE];
 
 static char _inputBuffer[_INPUT_BUFFER_SIZE];
+static volatile bool _consoleActive;		///< no-stop lock is held for the console, wake-up on RX pin is disabled
 static char _outputBuffer[_OUTPUT_BUFFER_SIZE];
 
 /*---------------------------------------------------------------------------------------------------------------------+
@@ -95,15 +121,19 @@ static char _outputBuffer[_OUTPUT_BUFFER_SIZE];
  *
  * Initializes USART
  *
- * \return ERROR_NONE if the semaphore and queues were successfully created and
- * tasks were successfully created and added to a ready list, otherwise an error
- * code defined in the file error.h
+ * \return ERROR_NONE if tasks were successfully created and added to a ready list, otherwise an error code defined in the
+ * file error.h
  */
 
 enum Error usartInitialize(void)
 {
-	gpioConfigurePin(USARTx_TX_GPIO, USARTx_TX_PIN, USARTx_TX_CONFIGURATION);
-	gpioConfigurePin(USARTx_RX_GPIO, USARTx_RX_PIN, USARTx_RX_CONFIGURATION);
+	static const struct GpioPinGroup pins[] =
+	{
+			GPIO_PIN_GROUP(USARTx_TX_GPIO, GPIO_PIN_MASK(USARTx_TX_PIN), USARTx_TX_CONFIGURATION),
+			GPIO_PIN_GROUP(USARTx_RX_GPIO, GPIO_PIN_MASK(USARTx_RX_PIN), USARTx_RX_CONFIGURATION),
+	};
+
+	gpioConfigurePinGroups(pins, sizeof(pins) / sizeof(pins[0]));
 
 	RCC_APBxENR_USARTxEN_bb = 1;			// enable USART in RCC
 
@@ -121,31 +151,31 @@ enum Error usartInitialize(void)
 	NVIC_SetPriority(USARTx_DMAx_TX_CH_IRQn, USARTx_DMAx_TX_CH_IRQ_PRIORITY);// set DMA IRQ priority
 	NVIC_EnableIRQ(USARTx_DMAx_TX_CH_IRQn);	// enable IRQ
 
-	vSemaphoreCreateBinary(_dmaTxSemaphore);
-
-	if (_dmaTxSemaphore == NULL)			// semaphore not created?
-		return ERROR_FreeRTOS_errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;// return with error
+	RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;	// route RX pin to EXTI, falling edge is the start bit
+	SYSCFG->EXTICR[USARTx_RX_EXTICR_index] = (SYSCFG->EXTICR[USARTx_RX_EXTICR_index] & ~USARTx_RX_EXTICR_mask) |
+			USARTx_RX_EXTICR;
+	EXTI->FTSR |= USARTx_RX_EXTI_LINE;
+	EXTI->PR = USARTx_RX_EXTI_LINE;			// clear pending request
+	EXTI->IMR |= USARTx_RX_EXTI_LINE;
 
-	_txQueue = xQueueCreate(USARTx_TX_QUEUE_LENGTH, sizeof(struct _TxMessage));
+	NVIC_SetPriority(USARTx_RX_EXTI_IRQn, USARTx_RX_EXTI_IRQ_PRIORITY);
+	NVIC_EnableIRQ(USARTx_RX_EXTI_IRQn);
 
-	if (_txQueue == NULL)					// queue not created?
-		return ERROR_FreeRTOS_errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;// return with error
+	rccRegisterClockCallbacks(_clockPreChange, _clockPostChange);
 
-	_rxQueue = xQueueCreate(USARTx_RX_QUEUE_LENGTH, sizeof(struct _RxMessage));
+	_txQueue = xQueueCreateStatic(USARTx_TX_QUEUE_LENGTH, sizeof(struct _TxMessage), _txQueueStorage, &_txQueueBuffer);
+	_rxQueue = xQueueCreateStatic(USARTx_RX_QUEUE_LENGTH, sizeof(struct _RxMessage), _rxQueueStorage, &_rxQueueBuffer);
 
-	if (_rxQueue == NULL)					// queue not created?
-		return ERROR_FreeRTOS_errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;// return with error
-
-	portBASE_TYPE ret = xTaskCreate(_txTask, (signed char* )"USART TX",
-			USART_TX_STACK_SIZE, NULL, USART_TX_TASK_PRIORITY, NULL);
+	portBASE_TYPE ret = xTaskCreateStatic(_txTask, (signed char* )"USART TX",
+			USART_TX_STACK_SIZE, NULL, USART_TX_TASK_PRIORITY, &_txTaskHandle, _txTaskStack, &_txTaskBuffer);
 
 	enum Error error = errorConvert_portBASE_TYPE(ret);
 
 	if (error != ERROR_NONE)
 		return error;
 
-	ret = xTaskCreate(_rxTask, (signed char* )"USART RX", USART_RX_STACK_SIZE,
-			NULL, USART_RX_TASK_PRIORITY, NULL);
+	ret = xTaskCreateStatic(_rxTask, (signed char* )"USART RX", USART_RX_STACK_SIZE,
+			NULL, USART_RX_TASK_PRIORITY, NULL, _rxTaskStack, &_rxTaskBuffer);
 
 	error = errorConvert_portBASE_TYPE(ret);
 
@@ -155,7 +185,9 @@ enum Error usartInitialize(void)
 /**
  * \brief Sends one formatted string via USART.
  *
- * Sends one formatted string via USART.
+ * Sends one formatted string via USART. The string is measured with vsnprintf() first and formatted into a buffer of
+ * that size, so it never overflows a pool block. vsnprintf() of printf-stdarg.cpp is used, which supports only integer,
+ * string and character conversions, but doesn't link the floating-point printf() of newlib.
  *
  * \param [in] ticks_to_wait is the amount of time the call should block while waiting for the operation to finish, use
  * portMAX_DELAY to suspend
@@ -166,22 +198,32 @@ enum Error usartInitialize(void)
 
 enum Error usartPrintf(portTickType ticks_to_wait, const char *format, ...)
 {
-	char *buffer = (char*) pvPortMalloc(strlen(format) * 2);
+	va_list args;
+
+	va_start(args, format);
+
+	size_t length = vsnprintf(NULL, 0, format, args);	// first pass only measures the string
+
+	va_end(args);
+
+	char *buffer = _allocateString(length);
 
 	if (buffer == NULL)
 		return ERROR_FreeRTOS_errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
 
-	va_list args;
-
 	va_start(args, format);
 
-	vsprintf(buffer, format, args);
+	vsnprintf(buffer, length + 1, format, args);
 
-	enum Error error = usartSendString(buffer, ticks_to_wait);
+	va_end(args);
 
-	vPortFree(buffer);
+	if (length == 0)
+	{
+		_freeString(buffer);
+		return ERROR_NONE;
+	}
 
-	return error;
+	return _send(buffer, length, ticks_to_wait);	// formatted buffer is sent without a copy
 }
 
 /**
@@ -211,32 +253,22 @@ void usartSendCharacter(char c) {
 
 enum Error usartSendString(const char *string, portTickType ticks_to_wait)
 {
-	struct _TxMessage message;
-
-	message.length = strlen(string);
+	size_t length = strlen(string);
 
-	if (message.length == 0)
+	if (length == 0)
 		return ERROR_NONE;
 
-	if (string >= __ram_start)				// is the string in RAM?
-			{
-		message.string = (char*) pvPortMalloc(message.length);
-		if (message.string == NULL)
-			return ERROR_FreeRTOS_errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
-
-		memcpy(message.string, string, message.length);
-	} else
-		message.string = (char*) string;// no, string in ROM - just use the address
+	if (string < __ram_start)				// string in ROM - just use the address
+		return _send((char*) string, length, ticks_to_wait);
 
-	portBASE_TYPE ret = xQueueSend(_txQueue, &message, ticks_to_wait);
+	char *copy = _allocateString(length);
 
-	enum Error error = errorConvert_portBASE_TYPE(ret);
+	if (copy == NULL)
+		return ERROR_FreeRTOS_errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
 
-	if (error != ERROR_NONE)
-		if (message.string >= __ram_start)				// is the string in RAM?
-			vPortFree(message.string);
+	memcpy(copy, string, length);
 
-	return error;
+	return _send(copy, length, ticks_to_wait);
 }
 
 /*---------------------------------------------------------------------------------------------------------------------+
@@ -246,7 +278,8 @@ enum Error usartSendString(const char *string, portTickType ticks_to_wait)
 /**
  * \brief USART RX task.
  *
- * USART RX task - handles input.
+ * USART RX task - handles input. Releases the no-stop lock of the console when no input comes for
+ * USARTx_CONSOLE_IDLE_ms.
  */
 
 static void _rxTask(void *parameters)
@@ -258,7 +291,21 @@ static void _rxTask(void *parameters)
 	while (1) {
 		struct _RxMessage message;
 
-		xQueueReceive(_rxQueue, &message, portMAX_DELAY);
+		if (xQueueReceive(_rxQueue, &message, _consoleActive == true ? USARTx_CONSOLE_IDLE_ms / portTICK_RATE_MS :
+				portMAX_DELAY) != pdTRUE)	// console idle?
+		{
+			uint32_t primask = __get_PRIMASK();
+			__disable_irq();
+
+			_consoleActive = false;
+			EXTI->PR = USARTx_RX_EXTI_LINE;	// clear pending request
+			EXTI->IMR |= USARTx_RX_EXTI_LINE;	// next start bit wakes the console up again
+
+			__set_PRIMASK(primask);
+
+			powerUnlockStop();
+			continue;
+		}
 
 		if ((_INPUT_BUFFER_SIZE - 1) < (message.length + input_length))	// does input fit into buffer?
 				{									// no - reset sequence
@@ -276,8 +323,7 @@ static void _rxTask(void *parameters)
 				{									// yes - start processing
 			_inputBuffer[input_length] = '\0';	// terminate input string
 
-			enum Error error = ERROR_NONE;
-//					commandProcessInput(_inputBuffer, _outputBuffer, _OUTPUT_BUFFER_SIZE);	// process input
+			enum Error error = commandProcessInput(_inputBuffer, _outputBuffer, _OUTPUT_BUFFER_SIZE);	// process input
 
 			if (error == ERROR_NONE)		// input processed successfully?
 				usartSendString(_outputBuffer, 0);
@@ -296,12 +342,14 @@ static void _rxTask(void *parameters)
 /**
  * \brief USART TX task.
  *
- * USART TX task - handles output.
+ * USART TX task - handles output. End of DMA transfer and release of transmission held for the change of core frequency
+ * are signaled with notifications of the task, the flags are checked again after each one.
  */
 
 static void _txTask(void *parameters)
 {
 	char *previous_string = NULL;
+	bool locked = false;					// no-stop lock held during transfers
 
 	(void) parameters;						// suppress warning
 
@@ -310,10 +358,26 @@ static void _txTask(void *parameters)
 
 		xQueueReceive(_txQueue, &message, portMAX_DELAY);	// get data to send
 
-		xSemaphoreTake(_dmaTxSemaphore, portMAX_DELAY);	// wait for DMA to be free
+		while (1)							// wait for DMA to be free and not held
+		{
+			uint32_t primask = __get_PRIMASK();
+			__disable_irq();
+
+			bool free = _dmaBusy == false && _txHeld == false;
+
+			if (free == true)
+				_dmaBusy = true;
+
+			__set_PRIMASK(primask);
+
+			if (free == true)
+				break;
+
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		}
 
 		if (previous_string >= __ram_start)	// was the previously used string in RAM?
-			vPortFree(previous_string);		// yes - free the temporary buffer
+			_freeString(previous_string);	// yes - free the temporary buffer
 
 		USARTx_DMAx_TX_CH->CCR = 0;				// disable channel
 		USARTx_DMAx_TX_CH->CMAR = (uint32_t) message.string;	// source
@@ -327,7 +391,93 @@ static void _txTask(void *parameters)
 
 		// save address for next iteration so that it could be freed after transfer (if it's in RAM);
 		previous_string = message.string;
+
+		if (locked == false)				// STOP mode would stop the transfer
+		{
+			powerLockStop();
+			locked = true;
+		}
+
+		if (uxQueueMessagesWaiting(_txQueue) == 0)	// nothing more to send? wait for the end and allow STOP mode
+		{
+			while (_dmaBusy == true)
+				ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+			while ((USARTx->SR & USART_SR_TC) == 0);	// wait for the last frame to leave the shift register
+			powerUnlockStop();
+			locked = false;
+		}
+	}
+}
+
+/**
+ * \brief Allocates a buffer for a string.
+ *
+ * Allocates a buffer for a string - a block of UsartString pool if the string fits, otherwise (or if the pool is empty)
+ * a block from the heap.
+ *
+ * \param [in] length is the length of the string, not including trailing '\0'
+ *
+ * \return pointer to the buffer, NULL if it couldn't be allocated
+ */
+
+static char* _allocateString(size_t length)
+{
+	if (length < USART_STRING_LENGTH)		// room for trailing '\0' of vsnprintf()
+	{
+		struct UsartString *block = poolAllocate<UsartString>();
+
+		if (block != NULL)
+			return block->string;
 	}
+
+	return (char*) pvPortMalloc(length + 1);
+}
+
+/**
+ * \brief Frees a buffer allocated with _allocateString().
+ *
+ * \param [in] string is the buffer
+ */
+
+static void _freeString(char *string)
+{
+	if (poolContains(&pools[POOL_ID_UsartString], string) == true)
+		poolFree(reinterpret_cast<struct UsartString*>(string));
+	else
+		vPortFree(string);
+}
+
+/**
+ * \brief Adds a string to UART TX queue.
+ *
+ * Adds a string to UART TX queue. Buffer in RAM is owned by the TX task afterwards, it is freed if it couldn't be
+ * queued.
+ *
+ * \param [in] string is the string, in ROM or in buffer allocated with _allocateString()
+ * \param [in] length is the length of the string
+ * \param [in] ticks_to_wait is the amount of time the call should block while waiting for the operation to finish, use
+ * portMAX_DELAY to suspend
+ *
+ * \return ERROR_NONE on success, otherwise an error code defined in the file error.h
+ */
+
+static enum Error _send(char *string, size_t length, portTickType ticks_to_wait)
+{
+	struct _TxMessage message;
+
+	message.length = length;
+	message.string = string;
+
+	portBASE_TYPE ret = xQueueSend(_txQueue, &message, ticks_to_wait);
+
+	enum Error error = errorConvert_portBASE_TYPE(ret);
+
+	if (error != ERROR_NONE)
+		if (string >= __ram_start)			// is the string in RAM?
+			_freeString(string);
+
+	return error;
 }
 
 /*---------------------------------------------------------------------------------------------------------------------+
@@ -343,12 +493,25 @@ static void _txTask(void *parameters)
 extern "C" void USARTx_DMAx_TX_CH_IRQHandler(void) __attribute__ ((interrupt));
 void USARTx_DMAx_TX_CH_IRQHandler(void)
 {
-	signed portBASE_TYPE higher_priority_task_woken;
+	struct RuntimeIsr isr;
+	signed portBASE_TYPE higher_priority_task_woken = pdFALSE;
 
-	xSemaphoreGiveFromISR(_dmaTxSemaphore, &higher_priority_task_woken);
+	runtimeIsrEnter(&isr);
 
 	USARTx_DMAx_TX_IFCR_CTCIFx_bb = 1;			// clear interrupt flag
 
+	_dmaBusy = false;
+
+	if (_dmaWaiter != NULL)					// _clockPreChange() waiting?
+	{
+		vTaskNotifyGiveFromISR(_dmaWaiter, &higher_priority_task_woken);
+		_dmaWaiter = NULL;
+	}
+
+	vTaskNotifyGiveFromISR(_txTaskHandle, &higher_priority_task_woken);
+
+	runtimeIsrExit(&isr, RUNTIME_ISR_GROUP_USART);
+
 	portEND_SWITCHING_ISR(higher_priority_task_woken);
 }
 
@@ -358,12 +521,15 @@ void USARTx_DMAx_TX_CH_IRQHandler(void)
  * USART interrupt handler
  */
 
-/*extern "C" void USARTx_IRQHandler(void) __attribute((interrupt));
+extern "C" void USARTx_IRQHandler(void) __attribute((interrupt));
 void USARTx_IRQHandler(void)
 {
+	struct RuntimeIsr isr;
 	portBASE_TYPE higher_priority_task_woken = pdFALSE;
 	static struct _RxMessage message;
 
+	runtimeIsrEnter(&isr);
+
 	while (USARTx_SR_RXNE_bb(USARTx))		// loop while data is available
 	{
 		char c = USARTx->DR;
@@ -389,8 +555,44 @@ void USARTx_IRQHandler(void)
 		}
 	}
 
+	runtimeIsrExit(&isr, RUNTIME_ISR_GROUP_USART);
+
 	portEND_SWITCHING_ISR(higher_priority_task_woken);
-}*/
+}
+
+/**
+ * \brief Interrupt handler of the start bit on RX pin.
+ *
+ * Takes the no-stop lock for the console, so next characters are received. Empty message makes the RX task start
+ * counting USARTx_CONSOLE_IDLE_ms.
+ */
+
+extern "C" void USARTx_RX_EXTI_IRQHandler(void) __attribute__ ((interrupt));
+void USARTx_RX_EXTI_IRQHandler(void)
+{
+	struct RuntimeIsr isr;
+	portBASE_TYPE higher_priority_task_woken = pdFALSE;
+	struct _RxMessage message;
+
+	runtimeIsrEnter(&isr);
+
+	EXTI->IMR &= ~USARTx_RX_EXTI_LINE;		// RXNE interrupt handles input from now on
+	EXTI->PR = USARTx_RX_EXTI_LINE;			// clear pending request
+
+	if (_consoleActive == false)
+	{
+		_consoleActive = true;
+		powerLockStop();
+
+		message.length = 0;
+		message.status = RX_STATUS_HAD_NONE;
+		xQueueSendFromISR(_rxQueue, &message, &higher_priority_task_woken);
+	}
+
+	runtimeIsrExit(&isr, RUNTIME_ISR_GROUP_USART);
+
+	portEND_SWITCHING_ISR(higher_priority_task_woken);
+}
 
 /**
  *  \brief Low-level String printing
@@ -410,3 +612,51 @@ void usartSendDebugMsg(const char *string)
 		usartSendCharacter( (*string+i) );
 	}
 }
+
+/**
+ * \brief Holds USART transmission before the change of core frequency.
+ *
+ * Holds the TX task, waits for the end of current DMA transfer (notified by DMA ISR) and for the last frame to leave the
+ * shift register. The TX task is released by _clockPostChange(). Before the scheduler is started there are no transfers,
+ * so the function doesn't block.
+ *
+ * \param [in] frequency is the new frequency of the core in Hz
+ */
+
+static void _clockPreChange(uint32_t frequency)
+{
+	(void) frequency;						// suppress warning
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	_txHeld = true;
+	bool busy = _dmaBusy;
+
+	if (busy == true)
+		_dmaWaiter = xTaskGetCurrentTaskHandle();
+
+	__set_PRIMASK(primask);
+
+	if (busy == true)						// DMA ISR notifies exactly once
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+	while (USARTx_SR_TC_bb(USARTx) == 0);	// wait for transmission complete
+}
+
+/**
+ * \brief Sets USART baudrate for new core frequency and resumes transmission.
+ *
+ * \param [in] frequency is the new frequency of the core in Hz
+ */
+
+static void _clockPostChange(uint32_t frequency)
+{
+	USARTx->BRR = (frequency + USARTx_BAUDRATE / 2) / USARTx_BAUDRATE;	// calculate baudrate (with rounding)
+
+	_txHeld = false;						// release transmission held by _clockPreChange()
+
+	if (_txTaskHandle != NULL)
+		xTaskNotifyGive(_txTaskHandle);
+}
+
@@ -10,8 +10,18 @@
 
 #include "FreeRTOS.h"
 
+#include "config.h"
 #include "error.h"
 
+/*---------------------------------------------------------------------------------------------------------------------+
+| global types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// block of pooled USART strings (not null-terminated)
+struct UsartString {
+	char string[USART_STRING_LENGTH];
+};
+
 /*---------------------------------------------------------------------------------------------------------------------+
 | global functions' prototypes
 +---------------------------------------------------------------------------------------------------------------------*/
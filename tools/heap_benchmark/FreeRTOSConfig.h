@@ -0,0 +1,41 @@
+/*
+ * FreeRTOSConfig.h
+ *
+ * Configuration for the host build of heap_benchmark - only what heap_tlsf.c and the headers it includes need.
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <assert.h>
+
+#include "benchmark.h"
+
+#define configUSE_PREEMPTION			1
+#define configUSE_IDLE_HOOK				0
+#define configUSE_TICK_HOOK				0
+#define configTICK_RATE_HZ				( ( portTickType ) 1000 )
+#define configMAX_PRIORITIES			( ( unsigned portBASE_TYPE ) 5 )
+#define configMINIMAL_STACK_SIZE		( ( unsigned short ) 64 )
+#define configMAX_TASK_NAME_LEN			12
+#define configUSE_16_BIT_TICKS			0
+#define configUSE_MALLOC_FAILED_HOOK	0
+#define configUSE_CO_ROUTINES 			0
+
+#define INCLUDE_vTaskPrioritySet		0
+#define INCLUDE_uxTaskPriorityGet		0
+#define INCLUDE_vTaskDelete				0
+#define INCLUDE_vTaskSuspend			0
+#define INCLUDE_vTaskDelayUntil			0
+#define INCLUDE_vTaskDelay				0
+
+#define configASSERT(x)					assert(x)
+
+/* Heap (heap_tlsf.c) - the heap is a static array of the benchmark, as big as the heap of the target. */
+#define configHEAP_START				( benchmarkHeap )
+#define configHEAP_END					( benchmarkHeap + BENCHMARK_HEAP_SIZE )
+#define configTLSF_SL_INDEX_COUNT_LOG2	3
+#define configTLSF_FL_INDEX_MAX			13
+#define configHEAP_CALL_SITE_STATS		0
+
+#endif /* FREERTOS_CONFIG_H */
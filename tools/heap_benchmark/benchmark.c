@@ -0,0 +1,494 @@
+/*
+ * benchmark.c
+ *
+ * Host benchmark of heap_tlsf.c against a simple first-fit allocator (free list sorted by address, first chunk which
+ * fits is split, neighbours are coalesced on free, memory is taken from the heap like with sbrk() when no chunk fits).
+ * The first-fit allocator is only a model - heap_3.c wraps malloc of the full newlib linked by the firmware, which is
+ * based on dlmalloc (best fit in size-binned free lists) and can't be built on the host, so its fragmentation and
+ * timing on the target will differ from the model. Both allocators manage a static heap of BENCHMARK_HEAP_SIZE bytes,
+ * so failures, fragmentation and footprint are measured the same way. Both replay the same pseudo-random sequence
+ * modelled on the firmware:
+ * - long-lived objects - stacks and TCBs of tasks, queues - allocated at start and kept,
+ * - usartPrintf() - string of the formatted length, freed by the TX task one message later,
+ * - usartSendString() - string copied to the heap and freed by the TX task one message later, with at most
+ * USART_TX_QUEUE_LENGTH messages in flight,
+ * - FatFS - 512 B LFN working buffer held during a file operation,
+ * - a short-lived task created and deleted from time to time.
+ *
+ * For each allocator mean and worst time of calls, failed allocations, worst fragmentation (1 - largest free block /
+ * free bytes) and footprint (highest number of bytes of the heap used) are reported. Timing on the host only compares
+ * the algorithms - heap_tlsf.c has no loops, so its worst case doesn't grow with the heap, the first-fit allocator
+ * walks its free list.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "benchmark.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local definitions
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define BENCHMARK_ITERATIONS				200000
+#define BENCHMARK_SEED						0x2545F491
+#define USART_TX_QUEUE_LENGTH				16
+#define FATFS_LFN_BUFFER_SIZE				512
+#define FATFS_PERIOD						64		///< a file operation every that many iterations
+#define FATFS_DURATION						8		///< iterations for which the LFN buffer is held
+#define TASK_PERIOD							1000	///< a short-lived task every that many iterations
+#define TASK_DURATION						100		///< iterations for which the short-lived task exists
+#define SAMPLE_PERIOD						100		///< fragmentation sampled every that many iterations
+#define FIRST_FIT_ALIGNMENT					8		///< alignment of chunks of the first-fit allocator
+#define FIRST_FIT_HEADER_SIZE				offsetof(struct _FirstFitChunk, next)
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// allocator under test
+struct _Allocator {
+	const char *name;
+	void *(*alloc)(size_t size);
+	void (*free)(void *pointer);
+	void (*sample)(size_t *free_bytes, size_t *largest, size_t *footprint);	///< fills fragmentation data
+};
+
+/// chunk of the first-fit allocator, the header is placed before the memory of the block
+struct _FirstFitChunk {
+	size_t size;							///< size of the chunk, header included
+	struct _FirstFitChunk *next;			///< next free chunk by address, only in free chunks
+};
+
+/// timing of calls
+struct _Timing {
+	uint64_t total_ns;
+	uint64_t max_ns;
+	uint32_t count;
+};
+
+/// results of one run
+struct _Result {
+	struct _Timing alloc;
+	struct _Timing free;
+	uint32_t failures;
+	double worstFragmentation;				///< highest 1 - largest free block / free bytes
+	size_t maxFootprint;					///< highest number of bytes taken from the system
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static void _run(const struct _Allocator *allocator, struct _Result *result);
+static void *_alloc(const struct _Allocator *allocator, struct _Result *result, size_t size);
+static void _free(const struct _Allocator *allocator, struct _Result *result, void *pointer);
+static void _sample(const struct _Allocator *allocator, struct _Result *result);
+static void _print(const char *name, const struct _Result *result);
+static uint64_t _now(void);
+static uint32_t _random(void);
+static void _tlsfSample(size_t *free_bytes, size_t *largest, size_t *footprint);
+static void *_firstFitAlloc(size_t size);
+static void _firstFitFree(void *pointer);
+static void _firstFitSample(size_t *free_bytes, size_t *largest, size_t *footprint);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+char benchmarkHeap[BENCHMARK_HEAP_SIZE] __attribute__ ((aligned (8)));
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// sizes of long-lived objects - stacks and TCBs of tasks, queues
+static const size_t _longLivedSizes[] = {
+		64 * 4, 80,							// heartbeat
+		128 * 4, 80,						// USART TX
+		256 * 4, 80,						// SD and FatFS
+		128 * 4, 80,						// timers
+		16 * 8 + 76,						// USART TX queue
+		8 * 12 + 76,						// common data queue
+		5 * 12 + 76,						// timer queue
+};
+
+static const struct _Allocator _allocators[] = {
+		{"heap_tlsf", pvPortMalloc, vPortFree, _tlsfSample},
+		{"first-fit", _firstFitAlloc, _firstFitFree, _firstFitSample},
+};
+
+static uint32_t _randomState;
+
+static char _firstFitHeap[BENCHMARK_HEAP_SIZE] __attribute__ ((aligned (FIRST_FIT_ALIGNMENT)));
+static size_t _firstFitBreak;				///< bytes of _firstFitHeap taken like with sbrk()
+static struct _FirstFitChunk *_firstFitList;	///< free chunks sorted by address
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+int main(void)
+{
+	printf("%u iterations, heap of %u bytes\n\n", BENCHMARK_ITERATIONS, BENCHMARK_HEAP_SIZE);
+	printf("%-14s %10s %10s %10s %10s %9s %15s %10s\n", "allocator", "alloc mean", "alloc max", "free mean",
+			"free max", "failures", "fragmentation", "footprint");
+
+	for(size_t i = 0; i < sizeof(_allocators) / sizeof(_allocators[0]); i++)
+	{
+		struct _Result result;
+
+		memset(&result, 0, sizeof(result));
+		_run(&_allocators[i], &result);
+		_print(_allocators[i].name, &result);
+	}
+
+	return 0;
+}
+
+/// scheduler is not running on the host
+void vTaskSuspendAll(void)
+{
+}
+
+/// scheduler is not running on the host
+signed portBASE_TYPE xTaskResumeAll(void)
+{
+	return pdFALSE;
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Replays the allocation pattern of the firmware with one allocator.
+ *
+ * \param [in] allocator is the allocator under test
+ * \param [out] result is the buffer for results
+ */
+static void _run(const struct _Allocator *allocator, struct _Result *result)
+{
+	void *long_lived[sizeof(_longLivedSizes) / sizeof(_longLivedSizes[0])];
+	void *queue[USART_TX_QUEUE_LENGTH];
+	size_t queue_head = 0, queue_count = 0;
+	void *previous_string = NULL;
+	void *lfn_buffer = NULL;
+	void *task_stack = NULL, *task_tcb = NULL;
+
+	_randomState = BENCHMARK_SEED;
+
+	for(size_t i = 0; i < sizeof(_longLivedSizes) / sizeof(_longLivedSizes[0]); i++)
+		long_lived[i] = _alloc(allocator, result, _longLivedSizes[i]);
+
+	for(uint32_t iteration = 0; iteration < BENCHMARK_ITERATIONS; iteration++)
+	{
+		uint32_t random = _random();
+		void *string = NULL;
+
+		if(random % 4 == 0)					// usartPrintf()
+		{
+			size_t format_length = 10 + (random >> 8) % 50;
+
+			string = _alloc(allocator, result, format_length + (random >> 16) % format_length + 1);
+		}
+		else if(random % 4 == 1)			// usartSendString()
+			string = _alloc(allocator, result, 5 + (random >> 8) % 75);
+
+		if(string != NULL)
+		{
+			if(queue_count < USART_TX_QUEUE_LENGTH)
+			{
+				queue[(queue_head + queue_count) % USART_TX_QUEUE_LENGTH] = string;
+				queue_count++;
+			}
+			else							// queue full - message dropped
+				_free(allocator, result, string);
+		}
+
+		if(queue_count != 0 && (queue_count == USART_TX_QUEUE_LENGTH || (random >> 24) % 3 == 0))	// TX task
+		{
+			_free(allocator, result, previous_string);
+			previous_string = queue[queue_head];
+			queue_head = (queue_head + 1) % USART_TX_QUEUE_LENGTH;
+			queue_count--;
+		}
+
+		if(iteration % FATFS_PERIOD == 0)
+			lfn_buffer = _alloc(allocator, result, FATFS_LFN_BUFFER_SIZE);
+		else if(iteration % FATFS_PERIOD == FATFS_DURATION)
+		{
+			_free(allocator, result, lfn_buffer);
+			lfn_buffer = NULL;
+		}
+
+		if(iteration % TASK_PERIOD == 0)
+		{
+			task_stack = _alloc(allocator, result, 96 * 4);
+			task_tcb = _alloc(allocator, result, 80);
+		}
+		else if(iteration % TASK_PERIOD == TASK_DURATION)
+		{
+			_free(allocator, result, task_tcb);
+			_free(allocator, result, task_stack);
+			task_stack = task_tcb = NULL;
+		}
+
+		if(iteration % SAMPLE_PERIOD == 0)
+			_sample(allocator, result);
+	}
+
+	while(queue_count != 0)
+	{
+		_free(allocator, result, queue[queue_head]);
+		queue_head = (queue_head + 1) % USART_TX_QUEUE_LENGTH;
+		queue_count--;
+	}
+
+	_free(allocator, result, previous_string);
+	_free(allocator, result, lfn_buffer);
+	_free(allocator, result, task_tcb);
+	_free(allocator, result, task_stack);
+
+	for(size_t i = 0; i < sizeof(_longLivedSizes) / sizeof(_longLivedSizes[0]); i++)
+		_free(allocator, result, long_lived[i]);
+}
+
+/**
+ * \brief	Allocates memory and measures the time of the call.
+ *
+ * \param [in] allocator is the allocator under test
+ * \param [in,out] result is the buffer for results
+ * \param [in] size is the requested size
+ *
+ * \return	pointer to allocated memory or NULL
+ */
+static void *_alloc(const struct _Allocator *allocator, struct _Result *result, size_t size)
+{
+	uint64_t start = _now();
+	void *pointer = allocator->alloc(size);
+	uint64_t time = _now() - start;
+
+	result->alloc.total_ns += time;
+	result->alloc.count++;
+	if(time > result->alloc.max_ns)
+		result->alloc.max_ns = time;
+
+	if(pointer == NULL)
+		result->failures++;
+	else
+		memset(pointer, 0x55, size);		// touch the memory as the firmware would
+
+	return pointer;
+}
+
+/**
+ * \brief	Frees memory and measures the time of the call.
+ *
+ * \param [in] allocator is the allocator under test
+ * \param [in,out] result is the buffer for results
+ * \param [in] pointer is the pointer to memory, NULL is ignored
+ */
+static void _free(const struct _Allocator *allocator, struct _Result *result, void *pointer)
+{
+	if(pointer == NULL)
+		return;
+
+	uint64_t start = _now();
+	allocator->free(pointer);
+	uint64_t time = _now() - start;
+
+	result->free.total_ns += time;
+	result->free.count++;
+	if(time > result->free.max_ns)
+		result->free.max_ns = time;
+}
+
+/**
+ * \brief	Updates worst fragmentation and footprint.
+ *
+ * \param [in] allocator is the allocator under test
+ * \param [in,out] result is the buffer for results
+ */
+static void _sample(const struct _Allocator *allocator, struct _Result *result)
+{
+	size_t free_bytes, largest, footprint;
+
+	allocator->sample(&free_bytes, &largest, &footprint);
+
+	if(free_bytes != 0 && largest != 0)
+	{
+		double fragmentation = 1.0 - (double)largest / free_bytes;
+
+		if(fragmentation > result->worstFragmentation)
+			result->worstFragmentation = fragmentation;
+	}
+
+	if(footprint > result->maxFootprint)
+		result->maxFootprint = footprint;
+}
+
+/**
+ * \brief	Prints one line of results.
+ *
+ * \param [in] name is the name of the allocator
+ * \param [in] result is the results
+ */
+static void _print(const char *name, const struct _Result *result)
+{
+	printf("%-14s %8lluns %8lluns %8lluns %8lluns %9u %14.1f%% %10zu\n", name,
+			(unsigned long long)(result->alloc.total_ns / (result->alloc.count ? result->alloc.count : 1)),
+			(unsigned long long)result->alloc.max_ns,
+			(unsigned long long)(result->free.total_ns / (result->free.count ? result->free.count : 1)),
+			(unsigned long long)result->free.max_ns,
+			result->failures, result->worstFragmentation * 100, result->maxFootprint);
+}
+
+/**
+ * \brief	Reads monotonic time.
+ *
+ * \return	time in ns
+ */
+static uint64_t _now(void)
+{
+	struct timespec time;
+
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+/**
+ * \brief	Generates a pseudo-random number (xorshift32), the sequence is the same for each allocator.
+ *
+ * \return	pseudo-random number
+ */
+static uint32_t _random(void)
+{
+	_randomState ^= _randomState << 13;
+	_randomState ^= _randomState >> 17;
+	_randomState ^= _randomState << 5;
+
+	return _randomState;
+}
+
+/**
+ * \brief	Reads fragmentation data of heap_tlsf.c.
+ */
+static void _tlsfSample(size_t *free_bytes, size_t *largest, size_t *footprint)
+{
+	xHeapStats stats;
+
+	vPortGetHeapStats(&stats);
+
+	*free_bytes = stats.xAvailableHeapSpaceInBytes;
+	*largest = stats.xSizeOfLargestFreeBlockInBytes;
+	*footprint = BENCHMARK_HEAP_SIZE - stats.xMinimumEverFreeBytesRemaining;
+}
+
+/**
+ * \brief	Allocates memory with the first-fit allocator. The first free chunk which is big enough is used, its end is
+ * 			cut off if the rest is big enough for a chunk. If no free chunk fits, the heap is extended.
+ *
+ * \param [in] size is the requested size
+ *
+ * \return	pointer to allocated memory or NULL
+ */
+static void *_firstFitAlloc(size_t size)
+{
+	size_t chunk_size = (size + FIRST_FIT_HEADER_SIZE + FIRST_FIT_ALIGNMENT - 1) & ~(size_t)(FIRST_FIT_ALIGNMENT - 1);
+	struct _FirstFitChunk **link = &_firstFitList;
+	struct _FirstFitChunk *chunk;
+
+	if(chunk_size < sizeof(struct _FirstFitChunk))
+		chunk_size = sizeof(struct _FirstFitChunk);
+
+	for(chunk = *link; chunk != NULL; link = &chunk->next, chunk = *link)
+	{
+		if(chunk->size < chunk_size)
+			continue;
+
+		if(chunk->size - chunk_size >= sizeof(struct _FirstFitChunk))	// split - the end is allocated
+		{
+			chunk->size -= chunk_size;
+			chunk = (struct _FirstFitChunk *)((char *)chunk + chunk->size);
+			chunk->size = chunk_size;
+		}
+		else
+			*link = chunk->next;
+
+		return (char *)chunk + FIRST_FIT_HEADER_SIZE;
+	}
+
+	if(BENCHMARK_HEAP_SIZE - _firstFitBreak < chunk_size)
+		return NULL;
+
+	chunk = (struct _FirstFitChunk *)&_firstFitHeap[_firstFitBreak];
+	chunk->size = chunk_size;
+	_firstFitBreak += chunk_size;
+
+	return (char *)chunk + FIRST_FIT_HEADER_SIZE;
+}
+
+/**
+ * \brief	Frees memory of the first-fit allocator. The chunk is inserted into the free list by address and coalesced
+ * 			with free neighbours.
+ *
+ * \param [in] pointer is the pointer to memory
+ */
+static void _firstFitFree(void *pointer)
+{
+	struct _FirstFitChunk *chunk = (struct _FirstFitChunk *)((char *)pointer - FIRST_FIT_HEADER_SIZE);
+	struct _FirstFitChunk *previous = NULL;
+	struct _FirstFitChunk *next = _firstFitList;
+
+	while(next != NULL && next < chunk)
+	{
+		previous = next;
+		next = next->next;
+	}
+
+	if(next != NULL && (char *)chunk + chunk->size == (char *)next)
+	{
+		chunk->size += next->size;
+		next = next->next;
+	}
+
+	chunk->next = next;
+
+	if(previous == NULL)
+		_firstFitList = chunk;
+	else if((char *)previous + previous->size == (char *)chunk)
+	{
+		previous->size += chunk->size;
+		previous->next = chunk->next;
+	}
+	else
+		previous->next = chunk;
+}
+
+/**
+ * \brief	Reads fragmentation data of the first-fit allocator. The part of the heap which was never taken counts as one
+ * 			free block, it's not merged with the last free chunk.
+ */
+static void _firstFitSample(size_t *free_bytes, size_t *largest, size_t *footprint)
+{
+	*free_bytes = BENCHMARK_HEAP_SIZE - _firstFitBreak;
+	*largest = *free_bytes;
+
+	for(const struct _FirstFitChunk *chunk = _firstFitList; chunk != NULL; chunk = chunk->next)
+	{
+		*free_bytes += chunk->size;
+		if(chunk->size > *largest)
+			*largest = chunk->size;
+	}
+
+	*footprint = _firstFitBreak;
+}
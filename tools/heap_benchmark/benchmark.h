@@ -0,0 +1,15 @@
+/*
+ * benchmark.h
+ *
+ * Declarations shared by the host build of heap_tlsf.c and the benchmark.
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+/// size of the heap - free RAM of STM32L152RB left for the heap by the firmware
+#define BENCHMARK_HEAP_SIZE					8192
+
+extern char benchmarkHeap[BENCHMARK_HEAP_SIZE];
+
+#endif /* BENCHMARK_H_ */
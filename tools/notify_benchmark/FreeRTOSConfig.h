@@ -0,0 +1,41 @@
+/*
+ * FreeRTOSConfig.h
+ *
+ * Configuration for the host build of notify_benchmark - only what tasks.c, queue.c and the headers they include need.
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <assert.h>
+
+#include "benchmark.h"
+
+#define configUSE_PREEMPTION			1
+#define configUSE_IDLE_HOOK				0
+#define configUSE_TICK_HOOK				0
+#define configTICK_RATE_HZ				( ( portTickType ) 1000 )
+#define configMAX_PRIORITIES			( ( unsigned portBASE_TYPE ) 5 )
+#define configMINIMAL_STACK_SIZE		( ( unsigned short ) 64 )
+#define configMAX_TASK_NAME_LEN			12
+#define configUSE_16_BIT_TICKS			0
+#define configUSE_MUTEXES				0
+#define configUSE_MALLOC_FAILED_HOOK	0
+#define configUSE_CO_ROUTINES 			0
+#define configUSE_TIMERS				0
+
+#define INCLUDE_vTaskPrioritySet		0
+#define INCLUDE_uxTaskPriorityGet		0
+#define INCLUDE_vTaskDelete				0
+#define INCLUDE_vTaskSuspend			1
+#define INCLUDE_vTaskDelayUntil			0
+#define INCLUDE_vTaskDelay				0
+#define INCLUDE_xTaskGetCurrentTaskHandle	1
+
+#define configASSERT(x)					assert(x)
+
+/* Kernel objects are created statically, like in the firmware, and the host build has no heap. */
+#define configSUPPORT_STATIC_ALLOCATION	1
+#define configUSE_TASK_NOTIFICATIONS	1
+
+#endif /* FREERTOS_CONFIG_H */
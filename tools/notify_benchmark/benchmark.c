@@ -0,0 +1,319 @@
+/*
+ * benchmark.c
+ *
+ * Host benchmark of task notifications (xTaskNotifyGive(), ulTaskNotifyTake()) against the binary semaphores they
+ * replaced in ISR-to-task signaling (end of DMA transfer of USART TX, interrupt of the accelerometer). tasks.c, queue.c
+ * and list.c of the firmware are built for the host without a scheduler - one task is created and "runs" main(). When
+ * it blocks, portYIELD_WITHIN_API() calls benchmarkYield(), which runs the "interrupt" giving the signal, so the whole
+ * path is measured: blocking, waking from the ISR and returning from the take. Cases:
+ * - ISR, pending - the interrupt came before the task waited, the take doesn't block,
+ * - ISR, blocked - the task waits, the interrupt wakes it up,
+ * - task, pending - give from another task, like _clockPostChange() of USART.
+ *
+ * Timing on the host only compares the paths, critical sections are empty here. RAM is printed for the host ABI - on
+ * the target a binary semaphore takes 80 bytes (xStaticQueue) and notifications add 4 bytes to each TCB (the state byte
+ * fills padding after the stack depth).
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+#include "benchmark.h"
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local definitions
++---------------------------------------------------------------------------------------------------------------------*/
+
+#define BENCHMARK_ITERATIONS				1000000
+#define BENCHMARK_RUNS						5		///< the best run of that many is reported
+#define BENCHMARK_STACK_SIZE				64
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables' types
++---------------------------------------------------------------------------------------------------------------------*/
+
+/// way of signaling under test
+struct _Signal {
+	const char *name;
+	void (*giveFromIsr)(void);
+	void (*give)(void);
+	unsigned long (*take)(portTickType ticks_to_wait);	///< returns non-zero if the signal was taken
+};
+
+/// case of signaling
+struct _Case {
+	const char *name;
+	bool isr;								///< signal given from ISR, otherwise from a task
+	bool blocked;							///< task waits before the signal is given
+};
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions' declarations
++---------------------------------------------------------------------------------------------------------------------*/
+
+static uint64_t _run(const struct _Signal *signal, const struct _Case *test);
+static uint64_t _now(void);
+static void _task(void *parameters);
+static void _semaphoreGiveFromIsr(void);
+static void _semaphoreGive(void);
+static unsigned long _semaphoreTake(portTickType ticks_to_wait);
+static void _notifyGiveFromIsr(void);
+static void _notifyGive(void);
+static unsigned long _notifyTake(portTickType ticks_to_wait);
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local variables
++---------------------------------------------------------------------------------------------------------------------*/
+
+static const struct _Signal _signals[] = {
+		{"binary semaphore", _semaphoreGiveFromIsr, _semaphoreGive, _semaphoreTake},
+		{"task notification", _notifyGiveFromIsr, _notifyGive, _notifyTake},
+};
+
+static const struct _Case _cases[] = {
+		{"ISR, pending", true, false},
+		{"ISR, blocked", true, true},
+		{"task, pending", false, false},
+};
+
+static xTaskHandle _taskHandle;
+static xStaticTask _taskBuffer;
+static portSTACK_TYPE _taskStack[BENCHMARK_STACK_SIZE];
+
+static xSemaphoreHandle _semaphore;
+static xStaticQueue _semaphoreBuffer;
+
+static void (*_interrupt)(void);			///< "interrupt" run when the task blocks, NULL if none
+static uint32_t _interrupts;				///< number of "interrupts" run
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| global functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+int main(void)
+{
+	xTaskCreateStatic(_task, (const signed char *)"BENCH", BENCHMARK_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1,
+			&_taskHandle, _taskStack, &_taskBuffer);
+
+	vSemaphoreCreateBinaryStatic(_semaphore, &_semaphoreBuffer);
+	xSemaphoreTake(_semaphore, 0);			// binary semaphore is created "given"
+
+	printf("%u iterations, best of %u runs, time of give + take\n\n", BENCHMARK_ITERATIONS, BENCHMARK_RUNS);
+	printf("%-18s", "signal");
+	for(size_t c = 0; c < sizeof(_cases) / sizeof(_cases[0]); c++)
+		printf(" %14s", _cases[c].name);
+	printf(" %16s\n", "RAM per signal");
+
+	for(size_t s = 0; s < sizeof(_signals) / sizeof(_signals[0]); s++)
+	{
+		printf("%-18s", _signals[s].name);
+
+		for(size_t c = 0; c < sizeof(_cases) / sizeof(_cases[0]); c++)
+		{
+			uint64_t best = UINT64_MAX;
+
+			for(uint32_t run = 0; run < BENCHMARK_RUNS; run++)
+			{
+				uint64_t time = _run(&_signals[s], &_cases[c]);
+
+				if(time < best)
+					best = time;
+			}
+
+			printf(" %12.1fns", (double)best / BENCHMARK_ITERATIONS);
+		}
+
+		if(_signals[s].take == _semaphoreTake)
+			printf(" %14zuB\n", sizeof(xStaticQueue));
+		else
+			printf(" %14uB\n", 0);
+	}
+
+	printf("\nhost TCB: %zu bytes, notification members: %zu bytes\n", sizeof(xStaticTask),
+			sizeof(unsigned long) + sizeof(unsigned char));
+
+	return 0;
+}
+
+/**
+ * \brief	Called by portYIELD_WITHIN_API() when the task blocks - runs the "interrupt" which wakes it up.
+ */
+void benchmarkYield(void)
+{
+	if(_interrupt != NULL)
+	{
+		_interrupt();
+		_interrupts++;
+	}
+}
+
+/// stack of the task is never used on the host
+portSTACK_TYPE *pxPortInitialiseStack(portSTACK_TYPE *pxTopOfStack, pdTASK_CODE pxCode, void *pvParameters)
+{
+	(void) pxCode;							// suppress warning
+	(void) pvParameters;					// suppress warning
+
+	return pxTopOfStack;
+}
+
+/// scheduler is not started on the host
+portBASE_TYPE xPortStartScheduler(void)
+{
+	return pdFALSE;
+}
+
+/// scheduler is not started on the host
+void vPortEndScheduler(void)
+{
+}
+
+/// all kernel objects of the benchmark are static
+void *pvPortMalloc(size_t xSize)
+{
+	(void) xSize;							// suppress warning
+
+	return NULL;
+}
+
+/// all kernel objects of the benchmark are static
+void vPortFree(void *pv)
+{
+	(void) pv;								// suppress warning
+}
+
+/*---------------------------------------------------------------------------------------------------------------------+
+| local functions
++---------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief	Measures one case of signaling.
+ *
+ * \param [in] signal is the way of signaling under test
+ * \param [in] test is the case
+ *
+ * \return	time of all iterations in ns
+ */
+static uint64_t _run(const struct _Signal *signal, const struct _Case *test)
+{
+	uint32_t taken = 0;
+
+	_interrupt = test->blocked == true ? signal->giveFromIsr : NULL;
+	_interrupts = 0;
+
+	uint64_t start = _now();
+
+	for(uint32_t iteration = 0; iteration < BENCHMARK_ITERATIONS; iteration++)
+	{
+		if(test->blocked == false)
+		{
+			if(test->isr == true)
+				signal->giveFromIsr();
+			else
+				signal->give();
+		}
+
+		if(signal->take(test->blocked == true ? portMAX_DELAY : 0) != 0)
+			taken++;
+	}
+
+	uint64_t time = _now() - start;
+
+	_interrupt = NULL;
+
+	configASSERT(taken == BENCHMARK_ITERATIONS);
+	configASSERT(test->blocked == false || _interrupts == BENCHMARK_ITERATIONS);
+
+	return time;
+}
+
+/**
+ * \brief	Reads monotonic time.
+ *
+ * \return	time in ns
+ */
+static uint64_t _now(void)
+{
+	struct timespec time;
+
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+/**
+ * \brief	Task of the benchmark - never started, its TCB is the current one.
+ */
+static void _task(void *parameters)
+{
+	(void) parameters;						// suppress warning
+}
+
+/**
+ * \brief	Gives the binary semaphore from "interrupt", like the DMA ISR of USART did.
+ */
+static void _semaphoreGiveFromIsr(void)
+{
+	signed portBASE_TYPE higher_priority_task_woken = pdFALSE;
+
+	xSemaphoreGiveFromISR(_semaphore, &higher_priority_task_woken);
+	portEND_SWITCHING_ISR(higher_priority_task_woken);
+}
+
+/**
+ * \brief	Gives the binary semaphore from the task.
+ */
+static void _semaphoreGive(void)
+{
+	xSemaphoreGive(_semaphore);
+}
+
+/**
+ * \brief	Takes the binary semaphore.
+ *
+ * \param [in] ticks_to_wait is the time to block, 0 or portMAX_DELAY
+ *
+ * \return	1 if the semaphore was taken, 0 otherwise
+ */
+static unsigned long _semaphoreTake(portTickType ticks_to_wait)
+{
+	return xSemaphoreTake(_semaphore, ticks_to_wait) == pdTRUE;
+}
+
+/**
+ * \brief	Notifies the task from "interrupt".
+ */
+static void _notifyGiveFromIsr(void)
+{
+	signed portBASE_TYPE higher_priority_task_woken = pdFALSE;
+
+	vTaskNotifyGiveFromISR(_taskHandle, &higher_priority_task_woken);
+	portEND_SWITCHING_ISR(higher_priority_task_woken);
+}
+
+/**
+ * \brief	Notifies the task from the task.
+ */
+static void _notifyGive(void)
+{
+	xTaskNotifyGive(_taskHandle);
+}
+
+/**
+ * \brief	Takes the notification of the task, the count is cleared like a binary semaphore.
+ *
+ * \param [in] ticks_to_wait is the time to block, 0 or portMAX_DELAY
+ *
+ * \return	notification count before it was cleared
+ */
+static unsigned long _notifyTake(portTickType ticks_to_wait)
+{
+	return ulTaskNotifyTake(pdTRUE, ticks_to_wait);
+}
@@ -0,0 +1,12 @@
+/*
+ * benchmark.h
+ *
+ * Declarations shared by the host build of the kernel and the benchmark.
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+void benchmarkYield(void);
+
+#endif /* BENCHMARK_H_ */
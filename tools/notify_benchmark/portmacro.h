@@ -0,0 +1,40 @@
+/*
+ * portmacro.h
+ *
+ * Host "port" for notify_benchmark - types of the ARM_CM3 port, no scheduler. A task which blocks calls
+ * benchmarkYield(), where the benchmark runs the "interrupt" which wakes it up.
+ */
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		long
+#define portSHORT		short
+#define portSTACK_TYPE	unsigned long
+#define portBASE_TYPE	long
+
+typedef unsigned long portTickType;
+#define portMAX_DELAY	( portTickType ) 0xffffffff
+
+#define portSTACK_GROWTH			( -1 )
+#define portTICK_RATE_MS			( ( portTickType ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT			8
+
+#define portYIELD()
+#define portYIELD_WITHIN_API()		benchmarkYield()
+#define portEND_SWITCHING_ISR( xSwitchRequired )	( void ) ( xSwitchRequired )
+#define portDISABLE_INTERRUPTS()
+#define portENABLE_INTERRUPTS()
+#define portENTER_CRITICAL()
+#define portEXIT_CRITICAL()
+#define portSET_INTERRUPT_MASK_FROM_ISR()		0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)	( void ) ( x )
+#define portNOP()
+
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+
+#endif /* PORTMACRO_H */
@@ -0,0 +1,186 @@
+#
+# file: ram_report.awk
+#
+# RAM usage of subsystems of the project, read from the linker map file. Sizes of input sections of .data, .bss and
+# .noinit output sections are summed per source directory of their objects and compared with budgets. Sum of budgets
+# is compared with RAM left after stacks and the minimal heap (sizes of "ram" region, __main_stack_size,
+# __process_stack_size and __heap_min_size from the map), so budgets can't promise more than the chip has. Exit status
+# is 1 if any budget is exceeded, so the build fails.
+#
+# usage: awk -f ram_report.awk <budget file> <list of sources> <map file>
+#
+
+# first file - budgets
+
+FILENAME == ARGV[1] {
+	if ($0 ~ /^[ \t]*(#|$)/)
+		next
+
+	budget[$1] = $2 + 0
+	budgets += $2
+	order[++subsystems] = $1
+	next
+}
+
+# second file - sources, one per line with path relative to the project's root folder
+
+FILENAME == ARGV[2] {
+	source = $1
+	sub(/^\.\//, "", source)
+
+	directory = source
+	if (sub(/\/[^\/]*$/, "", directory) == 0)
+		directory = "."
+
+	object = source
+	sub(/^.*\//, "", object)
+	sub(/\.[^.]*$/, ".o", object)
+
+	objects[object] = directory
+	next
+}
+
+# third file - map
+
+/^Memory Configuration/ {
+	in_memory = 1
+	next
+}
+
+in_memory && $1 == "ram" && $3 ~ /^0x/ {	# name, origin, length, attributes
+	ram = hex($3)
+	next
+}
+
+/^Linker script and memory map/ {
+	in_memory = 0
+	in_map = 1
+	next
+}
+
+!in_map {
+	next
+}
+
+NF >= 4 && $1 ~ /^0x/ && $3 == "=" && ($2 == "__main_stack_size" || $2 == "__process_stack_size" ||
+		$2 == "__heap_min_size") {		# assignment of symbol in linker script
+	reserved[$2] = hex($1)
+	next
+}
+
+/^\.[A-Za-z_]/ {							# output section
+	output = $1
+	pending = ""
+	next
+}
+
+output != ".data" && output != ".bss" && output != ".noinit" {
+	next
+}
+
+/^ [.A-Za-z_]/ && NF == 1 {					# input section with long name, address, size and object are in next line
+	pending = $1
+	next
+}
+
+{
+	if (pending != "" && NF >= 3 && $1 ~ /^0x/)
+		account($2, $3)
+	else if (NF >= 4 && $1 !~ /^\*/ && $2 ~ /^0x/ && $3 ~ /^0x/)
+		account($3, $4)
+
+	pending = ""
+}
+
+function account(size, file,	object, directory, best, i, name) {
+	size = hex(size)
+	if (size == 0)
+		return
+
+	if (file ~ /\.a\(/)
+		best = "libraries"
+	else
+	{
+		object = file
+		sub(/^.*\//, "", object)
+		directory = (object in objects) ? objects[object] : ""
+		best = "other"
+
+		for (i = 1; i <= subsystems; i++)
+		{
+			name = order[i]
+			if (name == "libraries" || name == "other")
+				continue
+			if (directory == name || index(directory, name "/") == 1)
+				if (best == "other" || length(name) > length(best))
+					best = name
+		}
+	}
+
+	if (output == ".data")
+		data[best] += size
+	else
+		bss[best] += size
+}
+
+function hex(string,	value, i) {			# strtonum() is gawk-only
+	value = 0
+	string = tolower(string)
+	sub(/^0x/, "", string)
+
+	for (i = 1; i <= length(string); i++)
+		value = value * 16 + index("0123456789abcdef", substr(string, i, 1)) - 1
+
+	return value
+}
+
+END {
+	if (!in_map)
+	{
+		print "ram_report.awk: no memory map in " ARGV[3] > "/dev/stderr"
+		exit 1
+	}
+
+	printf("%-24s %8s %8s %8s %8s\n", "subsystem", "data", "bss", "total", "budget")
+
+	for (i = 1; i <= subsystems; i++)
+	{
+		name = order[i]
+		total = data[name] + bss[name]
+		sum_data += data[name]
+		sum_bss += bss[name]
+
+		printf("%-24s %8d %8d %8d %8d", name, data[name], bss[name], total, budget[name])
+
+		if (total > budget[name])
+		{
+			printf("  <- exceeded by %d", total - budget[name])
+			exceeded = 1
+		}
+
+		printf("\n")
+	}
+
+	printf("%-24s %8d %8d %8d %8d\n", "all", sum_data, sum_bss, sum_data + sum_bss, budgets)
+
+	if (ram == 0 || !("__main_stack_size" in reserved) || !("__process_stack_size" in reserved) ||
+			!("__heap_min_size" in reserved))
+	{
+		print "ram_report.awk: no size of RAM, stacks or heap in " ARGV[3] > "/dev/stderr"
+		exit 1
+	}
+
+	available = ram - reserved["__main_stack_size"] - reserved["__process_stack_size"] - reserved["__heap_min_size"]
+
+	if (budgets > available)
+	{
+		printf("budgets exceed RAM left after stacks and heap (%d bytes) by %d\n", available, budgets - available)
+		exceeded = 1
+	}
+
+	if (exceeded)
+	{
+		print "RAM budget exceeded!" > "/dev/stderr"
+		exit 1
+	}
+}
@@ -0,0 +1,283 @@
+#
+# file: stack_report.awk
+#
+# Static estimate of stack usage of tasks and suggested sizes of their stacks. Frames of functions are read from .su
+# files (-fstack-usage), the call graph from the extended listing (objdump -S) and sizes of stacks from the symbol
+# table (objdump -x --syms). The deepest call chain from the entry function of each task is found, the context saved
+# on the task's stack by the port and the pattern checked by configCHECK_FOR_STACK_OVERFLOW 2 are added.
+#
+# The estimate is exact only for chains without calls through pointers, recursion, dynamic frames (alloca, VLA) and
+# functions without .su (libraries) - such chains are marked. Calls through pointers can be listed in the tasks file.
+# The report never fails the build, run-time high water marks ("stack" command) confirm the estimate.
+#
+# usage: awk [-v margin=<percent>] -f stack_report.awk <tasks file> <.su files> <symbol table> <extended listing>
+#
+
+BEGIN {
+	if (margin == "")
+		margin = 25							# suggested size is the estimate + margin %, rounded up to 8 words
+
+	context = 64							# r4-r11 saved by PendSV + exception frame, in bytes
+	guard = 20								# pattern checked by configCHECK_FOR_STACK_OVERFLOW 2, in bytes
+	exception = 32							# exception frame pushed on the main stack by each nested ISR, in bytes
+}
+
+# first file - tasks and additional calls
+
+FILENAME == ARGV[1] {
+	if ($0 ~ /^[ \t]*(#|$)/)
+		next
+
+	if ($1 == "task")
+	{
+		entry[++tasks] = $2
+		stack_symbol[$2] = $3
+		wanted[$3] = 1
+	}
+	else if ($1 == "call")
+		add_call($2, $3)
+
+	next
+}
+
+# .su files - "<file>:<line>:<column>:<declaration>\t<bytes>\t<qualifiers>"
+
+FILENAME ~ /\.su$/ {
+	split($0, field, "\t")
+	name = field[1]
+	sub(/^[^:]*:[0-9]+:[0-9]+:/, "", name)
+	name = normalize(name)
+
+	if (!(name in frame) || field[2] + 0 > frame[name])
+		frame[name] = field[2] + 0
+	if (field[3] !~ /^static/)
+		dynamic[name] = 1
+
+	next
+}
+
+# symbol table - "<address> <flags> <section>\t<size> <name>"
+
+FILENAME == ARGV[ARGC - 2] {
+	if ($NF in wanted)
+		stack_size[$NF] = hex($(NF - 1))
+	else if ($NF == "__main_stack_start" || $NF == "__main_stack_end")
+		address[$NF] = hex($1)
+
+	next
+}
+
+# extended listing - function headers "<address> <name>:" and instructions "<address>:\t<code>\t<mnemonic>\t<operands>"
+
+/^[0-9a-f]+ <.*>:$/ {
+	function_name = $0
+	sub(/^[0-9a-f]+ </, "", function_name)
+	sub(/>:$/, "", function_name)
+	function_name = normalize(function_name)
+	if (!(function_name in functions))
+		function_count++
+	functions[function_name] = 1
+	next
+}
+
+/^ *[0-9a-f]+:\t/ && function_name != "" {
+	count = split($0, field, "\t")
+	if (count < 4)
+		next
+
+	mnemonic = field[3]
+	sub(/[ \t]+$/, "", mnemonic)
+	sub(/\.[nw]$/, "", mnemonic)
+	operands = field[4]
+
+	if (mnemonic == "bl" || mnemonic == "b" || mnemonic ~ /^b(eq|ne|cs|cc|mi|pl|vs|vc|hi|ls|ge|lt|gt|le)$/)
+	{
+		if (operands !~ /</)
+			next
+
+		target = operands
+		sub(/^[^<]*</, "", target)
+		sub(/>.*$/, "", target)
+
+		if (target ~ /\+0x[0-9a-f]+$/)		# branch inside a function
+			next
+
+		target = normalize(target)
+		if (target != function_name)		# bl to other function or tail call
+			add_call(function_name, target)
+	}
+	else if (mnemonic == "blx" || (mnemonic == "bx" && operands !~ /^lr/))
+		indirect[function_name] = 1			# call or tail call through pointer
+
+	next
+}
+
+function normalize(name) {					# "void foo(int)" and "foo(int)" -> "foo"
+	sub(/\(.*$/, "", name)
+	sub(/^.* /, "", name)
+	return name
+}
+
+function add_call(caller, callee) {
+	if ((caller, callee) in edge)
+		return
+
+	edge[caller, callee] = 1
+	callees[caller] = callees[caller] " " callee
+}
+
+function hex(string,	value, i) {			# strtonum() is gawk-only
+	value = 0
+	string = tolower(string)
+	sub(/^0x/, "", string)
+
+	for (i = 1; i <= length(string); i++)
+		value = value * 16 + index("0123456789abcdef", substr(string, i, 1)) - 1
+
+	return value
+}
+
+function depth(name,	list, count, i, callee, d, best) {	# deepest chain from the function, in bytes
+	if (name in memo)
+		return memo[name]
+
+	if (name in visiting)
+	{
+		notes["recursion"] = 1
+		return 0
+	}
+
+	visiting[name] = 1
+
+	if (!(name in frame))
+	{
+		if (!(name in unknown_seen))
+		{
+			unknown_seen[name] = 1
+			unknown = unknown " " name
+		}
+	}
+	else if (name in dynamic)
+		notes["dynamic frames"] = 1
+
+	if (name in indirect)
+		notes["calls through pointers"] = 1
+
+	best = 0
+	deepest[name] = ""
+	count = split(callees[name], list, " ")
+
+	for (i = 1; i <= count; i++)
+	{
+		callee = list[i]
+		d = depth(callee)
+		if (d > best || deepest[name] == "")
+		{
+			best = d
+			deepest[name] = callee
+		}
+	}
+
+	delete visiting[name]
+	memo[name] = frame[name] + best
+	return memo[name]
+}
+
+function reset() {
+	split("", memo)
+	split("", visiting)
+	split("", notes)
+	split("", unknown_seen)
+	unknown = ""
+}
+
+function chain(name,	string, steps) {
+	string = name
+	steps = 0
+
+	while (deepest[name] != "" && steps++ < 16)
+	{
+		name = deepest[name]
+		string = string " > " name
+	}
+
+	return string
+}
+
+function describe(	string, note, count, list) {
+	string = ""
+
+	for (note in notes)
+		string = string ", " note
+
+	count = split(unknown, list, " ")
+	if (count > 0)
+		string = string ", no .su: " list[1] (count > 1 ? " +" (count - 1) : "")
+
+	return substr(string, 3)
+}
+
+function words(bytes) {
+	return int((bytes + 3) / 4)
+}
+
+END {
+	if (function_count == 0)
+	{
+		print "stack_report.awk: no functions in " ARGV[ARGC - 1] > "/dev/stderr"
+		exit 0
+	}
+
+	printf("%-24s %8s %8s %9s  %s\n", "task", "stack", "estimate", "suggested", "notes (sizes in words)")
+
+	for (t = 1; t <= tasks; t++)
+	{
+		name = entry[t]
+		reset()
+
+		if (!(name in functions))
+		{
+			printf("%-24s %8s %8s %9s  %s\n", name, "-", "-", "-", "not linked")
+			continue
+		}
+
+		estimate = words(depth(name) + context + guard)
+		suggested = int((estimate * (100 + margin) / 100 + 7) / 8) * 8
+		symbol = stack_symbol[name]
+		size = (symbol in stack_size) ? stack_size[symbol] / 4 : "?"
+		note = describe()
+
+		if (size != "?" && estimate > size)
+			note = "EXCEEDS STACK" (note != "" ? ", " note : "")
+
+		printf("%-24s %8s %8d %9d  %s\n", name, size, estimate, suggested, note)
+		printf("    %s\n", chain(name))
+	}
+
+	# ISRs - the deepest handler, every nesting level adds its own chain and exception frame
+
+	reset()
+	isr_best = 0
+	isr_name = ""
+
+	for (name in functions)
+		if (name ~ /_(IRQ)?Handler$/)
+		{
+			d = depth(name)
+			if (d > isr_best || isr_name == "")
+			{
+				isr_best = d
+				isr_name = name
+			}
+		}
+
+	if (isr_name != "")
+	{
+		size = ("__main_stack_end" in address) ? (address["__main_stack_end"] - address["__main_stack_start"]) / 4 : "?"
+		printf("%-24s %8s %8d %9s  %s\n", "(ISRs)", size, words(isr_best + exception), "-",
+				"one nesting level" (describe() != "" ? ", " describe() : ""))
+		printf("    %s\n", chain(isr_name))
+	}
+
+	exit 0
+}
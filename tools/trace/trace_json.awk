@@ -0,0 +1,275 @@
+#
+# file: trace_json.awk
+#
+# Converts the dump of the trace recorder (peripherals/trace.cpp, "trace" command) to Chrome trace JSON, which can be
+# opened with chrome://tracing or https://ui.perfetto.dev. Input is the log of the console, other lines are ignored,
+# the last complete dump is converted.
+#
+# Each task and each ISR is a thread - slices show when the task was running and when the ISR was executing, instant
+# events show queue operations, task notifications, tasks becoming ready, delays and priority inheritance. STOP mode
+# is a separate thread, the core clock is a counter. Time starts at the oldest event in the buffer.
+#
+# usage: awk -f trace_json.awk <console log> > trace.json
+#
+
+BEGIN {
+	# types of events, enum TraceEventType in trace.h
+	split("TASK_SWITCHED_IN TASK_READY TASK_DELAY TASK_DELAY_UNTIL TASK_SUSPEND TASK_DELETE PRIORITY_INHERIT " \
+			"PRIORITY_DISINHERIT QUEUE_SEND QUEUE_RECEIVE QUEUE_PEEK QUEUE_SEND_FROM_ISR QUEUE_RECEIVE_FROM_ISR " \
+			"QUEUE_BLOCKING_SEND QUEUE_BLOCKING_RECEIVE QUEUE_SEND_FAILED QUEUE_RECEIVE_FAILED ISR_ENTER ISR_EXIT " \
+			"CLOCK_PRE_CHANGE CLOCK_POST_CHANGE STOP MARK NOTIFY_GIVE NOTIFY_GIVE_FROM_ISR NOTIFY_TAKE_BLOCK " \
+			"NOTIFY_TAKE", names, " ")
+	for (i = 1; i in names; i++)
+		event_type[names[i]] = i - 1
+
+	# names of queue operations
+	split("send receive peek send_from_isr receive_from_isr blocking_send blocking_receive send_failed " \
+			"receive_failed", names, " ")
+	for (i = 1; i in names; i++)
+		queue_operation[event_type["QUEUE_SEND"] + i - 1] = names[i]
+
+	# types of queues, ucQueueType in queue.c
+	split("queue,mutex,counting semaphore,binary semaphore,recursive mutex", names, ",")
+	for (i = 1; i in names; i++)
+		queue_type_name[i - 1] = names[i]
+
+	# exceptions of Cortex-M3 and STM32L152xB, exception number = IRQn + 16
+	split("NMI HardFault MemManage BusFault UsageFault - - - - SVC DebugMon - PendSV SysTick WWDG PVD TAMPER_STAMP " \
+			"RTC_WKUP FLASH RCC EXTI0 EXTI1 EXTI2 EXTI3 EXTI4 DMA1_Channel1 DMA1_Channel2 DMA1_Channel3 " \
+			"DMA1_Channel4 DMA1_Channel5 DMA1_Channel6 DMA1_Channel7 ADC1 USB_HP USB_LP DAC COMP EXTI9_5 LCD TIM9 " \
+			"TIM10 TIM11 TIM2 TIM3 TIM4 I2C1_EV I2C1_ER I2C2_EV I2C2_ER SPI1 SPI2 USART1 USART2 USART3 EXTI15_10 " \
+			"RTC_Alarm USB_FS_WKUP TIM6 TIM7", names, " ")
+	for (i = 1; i in names; i++)
+		exception_name[i + 1] = names[i]
+
+	TASK_TID = 100							# tid of task n is TASK_TID + n, tid of ISR is its exception number
+	UNKNOWN_TID = 99						# context before the first context switch
+	STOP_TID = 98
+}
+
+{
+	sub(/\r$/, "")
+}
+
+$1 == "TRACE" && NF == 5 {
+	dumping = 1
+	complete = 0
+	events = 0
+	split("", task_name)
+	split("", queue_type)
+
+	header_frequency = $2 + 0
+	tick_rate = $3 + 0
+	overwritten = $5 + 0
+	next
+}
+
+dumping && $1 == "TASK" {
+	name = $0
+	sub(/^TASK [0-9]+ /, "", name)
+	task_name[$2 + 0] = name
+	next
+}
+
+dumping && $1 == "QUEUE" {
+	queue_type[$2 + 0] = $3 + 0
+	next
+}
+
+dumping && $1 == "E" && NF == 5 {
+	cycles[events] = hex($2)
+	type[events] = $3 + 0
+	object[events] = $4 + 0
+	value[events] = $5 + 0
+	events++
+	next
+}
+
+dumping && $1 == "END" {
+	dumping = 0
+	complete = 1
+	next
+}
+
+function hex(string,	result, i) {			# strtonum() is gawk-only
+	result = 0
+	string = tolower(string)
+
+	for (i = 1; i <= length(string); i++)
+		result = result * 16 + index("0123456789abcdef", substr(string, i, 1)) - 1
+
+	return result
+}
+
+function quote(string) {
+	gsub(/\\/, "\\\\", string)
+	gsub(/"/, "\\\"", string)
+	return "\"" string "\""
+}
+
+function emit(json) {
+	printf("%s\n\t\t%s", (emitted++ ? "," : ""), json)
+}
+
+function slice(name, tid, start, duration, args) {
+	emit(sprintf("{\"name\": %s, \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f, \"args\": {%s}}",
+			quote(name), tid, start, duration, args))
+}
+
+function instant(name, tid, time, args) {
+	emit(sprintf("{\"name\": %s, \"ph\": \"i\", \"s\": \"t\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"args\": {%s}}",
+			quote(name), tid, time, args))
+}
+
+function thread(tid, name, order) {
+	emit(sprintf("{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": %s}}", tid,
+			quote(name)))
+	emit(sprintf("{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": " \
+			"{\"sort_index\": %d}}", tid, order))
+}
+
+function task_label(number) {
+	return (number in task_name) ? task_name[number] : "task " number
+}
+
+function queue_label(number) {
+	if (number == 0)
+		return "unnumbered queue"
+
+	return "Q" number ((number in queue_type) ? " (" queue_type_name[queue_type[number]] ")" : "")
+}
+
+function context() {						# thread of the code which recorded the event
+	return isr_depth > 0 ? isr_stack[isr_depth] : running_tid
+}
+
+END {
+	if (complete == 0)
+	{
+		print "trace_json.awk: no complete dump (\"TRACE\" ... \"END\") in input" > "/dev/stderr"
+		exit 1
+	}
+
+	printf("{\n\t\"displayTimeUnit\": \"ns\",\n\t\"otherData\": {\"overwritten events\": %d},\n\t\"traceEvents\": [",
+			overwritten)
+
+	emit("{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"STM32L152\"}}")
+
+	frequency = header_frequency			# frequency before the first recorded change, see below
+	for (i = 0; i < events; i++)
+		if (type[i] == event_type["CLOCK_PRE_CHANGE"] || type[i] == event_type["CLOCK_POST_CHANGE"])
+		{
+			frequency = value[i] * 1000
+			break
+		}
+
+	time = 0
+	running_tid = UNKNOWN_TID
+	running_start = 0
+	isr_depth = 0
+
+	for (i = 0; i < events; i++)
+	{
+		if (i > 0)
+		{
+			delta = cycles[i] - cycles[i - 1]
+			if (delta < 0)					# DWT->CYCCNT wrapped
+				delta += 4294967296
+			time += delta * 1000000 / frequency
+		}
+
+		t = type[i]
+		o = object[i]
+		v = value[i]
+
+		if (t == event_type["TASK_SWITCHED_IN"])
+		{
+			if (running_tid == UNKNOWN_TID)
+				used_tid[UNKNOWN_TID] = "?"
+			if (time > running_start)
+				slice(running_tid == UNKNOWN_TID ? "?" : task_label(running_tid - TASK_TID), running_tid,
+						running_start, time - running_start, running_args)
+			running_tid = TASK_TID + o
+			running_start = time
+			running_args = "\"priority\": " v
+			used_tid[running_tid] = task_label(o)
+		}
+		else if (t == event_type["TASK_READY"])
+		{
+			instant("ready", TASK_TID + o, time, "\"priority\": " v ", \"by\": " quote(thread_name(context())))
+			used_tid[TASK_TID + o] = task_label(o)
+		}
+		else if (t == event_type["TASK_DELAY"])
+			instant("delay", TASK_TID + o, time, "\"ticks\": " v)
+		else if (t == event_type["TASK_DELAY_UNTIL"])
+			instant("delay until", TASK_TID + o, time, "")
+		else if (t == event_type["TASK_SUSPEND"])
+			instant("suspend", TASK_TID + o, time, "")
+		else if (t == event_type["TASK_DELETE"])
+			instant("delete", TASK_TID + o, time, "")
+		else if (t == event_type["PRIORITY_INHERIT"] || t == event_type["PRIORITY_DISINHERIT"])
+		{
+			instant(t == event_type["PRIORITY_INHERIT"] ? "inherit priority" : "disinherit priority", TASK_TID + o,
+					time, "\"priority\": " v ", \"by\": " quote(thread_name(context())))
+			used_tid[TASK_TID + o] = task_label(o)
+		}
+		else if (t in queue_operation)
+			instant(queue_operation[t] " " queue_label(o), context(), time, "\"items\": " v)
+		else if (t == event_type["ISR_ENTER"])
+		{
+			isr_stack[++isr_depth] = o
+			isr_start[isr_depth] = time
+			used_tid[o] = thread_name(o)
+		}
+		else if (t == event_type["ISR_EXIT"])
+		{
+			if (isr_depth > 0 && isr_stack[isr_depth] == o)	# entry not overwritten?
+			{
+				slice(thread_name(o), o, isr_start[isr_depth], time - isr_start[isr_depth], "")
+				isr_depth--
+			}
+		}
+		else if (t == event_type["CLOCK_PRE_CHANGE"] || t == event_type["CLOCK_POST_CHANGE"])
+		{
+			frequency = v * 1000
+			emit(sprintf("{\"name\": \"core clock\", \"ph\": \"C\", \"pid\": 1, \"ts\": %.3f, \"args\": {\"MHz\": %.3f}}",
+					time, frequency / 1000000))
+		}
+		else if (t == event_type["STOP"])
+		{
+			duration = v * 1000000 / tick_rate
+			slice("STOP", STOP_TID, time, duration, "\"ticks\": " v)
+			time += duration
+			used_tid[STOP_TID] = "STOP mode"
+		}
+		else if (t == event_type["MARK"])
+			instant("mark " o, context(), time, "\"value\": " v)
+		else if (t == event_type["NOTIFY_GIVE"] || t == event_type["NOTIFY_GIVE_FROM_ISR"])
+		{
+			instant("notify " task_label(o), context(), time, "\"count\": " v)
+			used_tid[TASK_TID + o] = task_label(o)
+		}
+		else if (t == event_type["NOTIFY_TAKE_BLOCK"])
+			instant("wait for notification", TASK_TID + o, time, "\"ticks\": " (v == 65535 ? "\"forever\"" : v))
+		else if (t == event_type["NOTIFY_TAKE"])
+			instant("take notification", TASK_TID + o, time, "\"count\": " v)
+	}
+
+	if (time > running_start)
+		slice(running_tid == UNKNOWN_TID ? "?" : task_label(running_tid - TASK_TID), running_tid, running_start,
+				time - running_start, running_args)
+
+	for (tid in used_tid)
+		thread(tid, used_tid[tid], tid < TASK_TID ? tid : 1000 + tid)
+
+	printf("\n\t]\n}\n")
+}
+
+function thread_name(tid) {
+	if (tid == UNKNOWN_TID)
+		return "?"
+	if (tid >= TASK_TID)
+		return task_label(tid - TASK_TID)
+
+	return (tid in exception_name) ? exception_name[tid] : "exception " tid
+}